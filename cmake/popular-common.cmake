@@ -12,6 +12,7 @@ prepend(POPULAR_COMMON_SOURCES ${COMMON_DIR}/
         kprintf.cpp
         precise-time.cpp
         cpuid.cpp
+        simd-string.cpp
         crc32.cpp
         crc32c.cpp
         options.cpp
@@ -9,6 +9,7 @@ prepend(COMMON_TESTS_SOURCES ${COMMON_DIR}/
         allocators/lockfree-slab-test.cpp
         crc32c-test.cpp
         crypto/aes256-test.cpp
+        simd-string-test.cpp
         parallel/counter-test.cpp
         parallel/limit-counter-test.cpp
         parallel/maximum-test.cpp
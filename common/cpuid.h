@@ -13,6 +13,8 @@ typedef struct {
   union {
     struct {
       int ebx, ecx, edx;
+      // ebx of the 7th leaf (structured extended features), 0 if the leaf isn't supported
+      int extended_ebx;
     } x86_64;
   };
 } kdb_cpuid_t;
@@ -242,6 +242,46 @@ int get_mem_stats (pid_t pid, mem_info_t *info) {
 #undef TMEM_SIZE
 }
 
+/** The memory not shared with other processes: the pages inherited on fork are counted after they are copied on write **/
+int get_private_mem_stats (pid_t pid, mem_info_t *info) {
+#define TMEM_SIZE 10000
+  static char mem[TMEM_SIZE];
+  snprintf (mem, TMEM_SIZE, "/proc/%lu/smaps_rollup", (unsigned long)pid);
+  info->rss_private = 0;
+  int fd = open (mem, O_RDONLY);
+
+  if (fd == -1) {
+    return 0;
+  }
+
+  int size = (int)read (fd, mem, TMEM_SIZE - 1);
+  close (fd);
+  if (size <= 0) {
+    return 0;
+  }
+  mem[size] = 0;
+
+  char *s = mem;
+  while (*s) {
+    char *st = s;
+    while (*s != 0 && *s != '\n') {
+      s++;
+    }
+    if (strncmp (st, "Private_Clean:", 14) == 0 || strncmp (st, "Private_Dirty:", 14) == 0) {
+      unsigned long long x = 0;
+      if (sscanf (st + 14, "%llu", &x) == 1) {
+        info->rss_private += x;
+      }
+    }
+    if (*s == 0) {
+      break;
+    }
+    s++;
+  }
+  return 1;
+#undef TMEM_SIZE
+}
+
 int get_pid_info (pid_t pid, pid_info_t *info) {
 #define TMEM_SIZE 10000
   static char mem[TMEM_SIZE];
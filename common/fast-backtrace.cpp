@@ -57,6 +57,10 @@ int fast_backtrace (void **buffer, int size) {
 int fast_backtrace_without_recursions(void **, int) noexcept {
   return 0;
 }
+
+int fast_backtrace_in_stack(void *, void **, int, const char *, const char *) noexcept {
+  return 0;
+}
 #else
 int fast_backtrace_without_recursions(void **buffer, int size) noexcept {
   if (!stack_end) {
@@ -82,4 +86,21 @@ int fast_backtrace_without_recursions(void **buffer, int size) noexcept {
   }
   return i;
 }
+
+int fast_backtrace_in_stack(void *bp, void **buffer, int size, const char *stack_begin, const char *stack_end) noexcept {
+  auto *frame = static_cast<stack_frame *>(bp);
+  int i = 0;
+  while (i < size &&
+         reinterpret_cast<const char *>(frame) >= stack_begin &&
+         reinterpret_cast<const char *>(frame + 1) <= stack_end &&
+         !(reinterpret_cast<long>(frame) & (sizeof(long) - 1))) {
+    buffer[i++] = frame->ip;
+    stack_frame *p = frame->bp;
+    if (p <= frame) {
+      break;
+    }
+    frame = p;
+  }
+  return i;
+}
 #endif
@@ -15,5 +15,8 @@ extern char *stack_end;
 
 int fast_backtrace (void **buffer, int size) __attribute__ ((noinline));
 int fast_backtrace_without_recursions(void **buffer, int size) noexcept;
+// the same as fast_backtrace, but starts from the given frame and stops as soon as a frame goes out of the given stack bounds,
+// it is safe to be called from signal handlers
+int fast_backtrace_in_stack(void *bp, void **buffer, int size, const char *stack_begin, const char *stack_end) noexcept;
 
 #endif
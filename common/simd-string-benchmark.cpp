@@ -0,0 +1,65 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include <benchmark/benchmark.h>
+
+#include <cctype>
+#include <random>
+#include <string>
+
+#include "common/simd-string.h"
+
+static std::string make_text(std::size_t size) {
+  std::mt19937 gen;
+  std::string text(size, ' ');
+  for (auto &c : text) {
+    c = static_cast<char>('a' + gen() % 26);
+  }
+  return text;
+}
+
+template<simd_memmem_func_t *memmem_func>
+static void BM_memmem(benchmark::State &state) {
+  const std::string haystack = make_text(state.range(0));
+  const std::string needle = "needle";
+  for (auto _ : state) {
+    benchmark::DoNotOptimize((*memmem_func)(haystack.data(), haystack.size(), needle.data(), needle.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * haystack.size());
+}
+
+static simd_memmem_func_t memmem_generic = simd_memmem_generic;
+BENCHMARK_TEMPLATE(BM_memmem, &memmem_generic)->RangeMultiplier(8)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_memmem, &simd_memmem)->RangeMultiplier(8)->Range(16, 1 << 20);
+
+template<simd_find_first_of_func_t *find_first_of_func>
+static void BM_find_first_of(benchmark::State &state) {
+  const std::string text = make_text(state.range(0));
+  const char special_chars[] = {'&', '<', '>', '"', '\''};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize((*find_first_of_func)(text.data(), text.size(), special_chars, sizeof(special_chars)));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static simd_find_first_of_func_t find_first_of_generic = simd_find_first_of_generic;
+BENCHMARK_TEMPLATE(BM_find_first_of, &find_first_of_generic)->RangeMultiplier(8)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_find_first_of, &simd_find_first_of)->RangeMultiplier(8)->Range(16, 1 << 20);
+
+template<simd_convert_case_func_t *convert_case_func>
+static void BM_convert_case(benchmark::State &state) {
+  const std::string text = make_text(state.range(0));
+  std::string result(text.size(), ' ');
+  for (auto _ : state) {
+    (*convert_case_func)(&result[0], text.data(), text.size(), toupper, 'a', 'z');
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+static simd_convert_case_func_t convert_case_generic = simd_convert_case_generic;
+BENCHMARK_TEMPLATE(BM_convert_case, &convert_case_generic)->RangeMultiplier(8)->Range(16, 1 << 20);
+BENCHMARK_TEMPLATE(BM_convert_case, &simd_convert_case)->RangeMultiplier(8)->Range(16, 1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,85 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/simd-string.h"
+
+#include <cctype>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::string random_string(std::mt19937 &gen, size_t len, const std::string &alphabet) {
+  std::string res(len, ' ');
+  for (auto &c : res) {
+    c = alphabet[gen() % alphabet.size()];
+  }
+  return res;
+}
+
+} // namespace
+
+TEST(simd_string, memmem) {
+  std::mt19937 gen{1};
+  for (size_t haystack_len : {0, 1, 15, 16, 17, 31, 32, 33, 100, 1000}) {
+    for (size_t needle_len : {1, 2, 3, 16, 40, 64, 65, 100}) {
+      for (int i = 0; i < 50; ++i) {
+        const std::string haystack = random_string(gen, haystack_len, "abc");
+        const std::string needle = random_string(gen, needle_len, "abc");
+        ASSERT_EQ(simd_memmem(haystack.data(), haystack.size(), needle.data(), needle.size()),
+                  simd_memmem_generic(haystack.data(), haystack.size(), needle.data(), needle.size()))
+          << simd_string_kernels_name << ": '" << haystack << "' '" << needle << "'";
+      }
+    }
+  }
+}
+
+TEST(simd_string, find_first_of) {
+  std::mt19937 gen{2};
+  const std::string chars{"&<>\"'", 5};
+  const std::string with_zero{"\0\\'\"", 4};
+  for (size_t len : {0, 1, 15, 16, 17, 31, 32, 33, 100, 1000}) {
+    for (int i = 0; i < 50; ++i) {
+      std::string s = random_string(gen, len, "abcdefgh");
+      if (len && i % 2) {
+        s[gen() % len] = chars[gen() % chars.size()];
+        s[gen() % len] = with_zero[gen() % with_zero.size()];
+      }
+      for (size_t chars_count = 1; chars_count <= chars.size(); ++chars_count) {
+        ASSERT_EQ(simd_find_first_of(s.data(), s.size(), chars.data(), chars_count),
+                  simd_find_first_of_generic(s.data(), s.size(), chars.data(), chars_count)) << simd_string_kernels_name;
+      }
+      ASSERT_EQ(simd_find_first_of(s.data(), s.size(), with_zero.data(), with_zero.size()),
+                simd_find_first_of_generic(s.data(), s.size(), with_zero.data(), with_zero.size())) << simd_string_kernels_name;
+    }
+  }
+}
+
+TEST(simd_string, convert_case) {
+  std::mt19937 gen{3};
+  std::string alphabet;
+  for (int c = 1; c < 256; ++c) {
+    alphabet.push_back(static_cast<char>(c));
+  }
+  for (size_t len : {0, 1, 15, 16, 17, 31, 32, 33, 100, 1000}) {
+    for (int i = 0; i < 50; ++i) {
+      // the long ascii runs are checked as well as the mixed ones
+      const std::string s = i % 2 ? random_string(gen, len, alphabet) : random_string(gen, len, "aZ@[`{09 xY");
+      std::string expected(len, ' '), actual(len, ' ');
+      simd_convert_case_generic(&expected[0], s.data(), len, tolower, 'A', 'Z');
+      simd_convert_case(&actual[0], s.data(), len, tolower, 'A', 'Z');
+      ASSERT_EQ(actual, expected) << simd_string_kernels_name;
+      simd_convert_case_generic(&expected[0], s.data(), len, toupper, 'a', 'z');
+      simd_convert_case(&actual[0], s.data(), len, toupper, 'a', 'z');
+      ASSERT_EQ(actual, expected) << simd_string_kernels_name;
+    }
+  }
+  std::string s{"Hello, World! 0123456789 [ABC] {xyz} @`"};
+  simd_convert_case(&s[0], s.data(), s.size(), tolower, 'A', 'Z');
+  ASSERT_EQ(s, "hello, world! 0123456789 [abc] {xyz} @`");
+  simd_convert_case(&s[0], s.data(), s.size(), toupper, 'a', 'z');
+  ASSERT_EQ(s, "HELLO, WORLD! 0123456789 [ABC] {XYZ} @`");
+}
@@ -0,0 +1,221 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/simd-string.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "common/cpuid.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// the longer needles are searched by the libc memmem, which is linear in the worst case
+constexpr size_t SIMD_MEMMEM_MAX_NEEDLE_LEN = 64;
+
+bool is_ascii_case_convertible(unsigned char c, char case_from, char case_to) {
+  return c >= static_cast<unsigned char>(case_from) && c <= static_cast<unsigned char>(case_to);
+}
+
+void convert_case_tail(char *dst, const char *src, size_t len, int (*convert)(int), char case_from, char case_to) {
+  for (size_t i = 0; i < len; ++i) {
+    const auto c = static_cast<unsigned char>(src[i]);
+    if (c >= 0x80) {
+      dst[i] = static_cast<char>(convert(c));
+    } else {
+      dst[i] = static_cast<char>(is_ascii_case_convertible(c, case_from, case_to) ? c ^ 0x20 : c);
+    }
+  }
+}
+
+#if defined(__x86_64__)
+
+// The memmem kernels compare the first and the last needle bytes with the vector of haystack positions at once,
+// the rest of the needle is compared only for the positions, where both are matched.
+const char *memmem_sse2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+  if (needle_len < 2 || needle_len > SIMD_MEMMEM_MAX_NEEDLE_LEN || haystack_len < needle_len) {
+    return simd_memmem_generic(haystack, haystack_len, needle, needle_len);
+  }
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+  size_t i = 0;
+  for (; i + needle_len - 1 + 16 <= haystack_len; i += 16) {
+    const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i));
+    const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + needle_len - 1));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+    while (mask) {
+      const size_t pos = i + __builtin_ctz(mask);
+      if (!memcmp(haystack + pos + 1, needle + 1, needle_len - 2)) {
+        return haystack + pos;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return simd_memmem_generic(haystack + i, haystack_len - i, needle, needle_len);
+}
+
+__attribute__((target("avx2")))
+const char *memmem_avx2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+  if (needle_len < 2 || needle_len > SIMD_MEMMEM_MAX_NEEDLE_LEN || haystack_len < needle_len) {
+    return simd_memmem_generic(haystack, haystack_len, needle, needle_len);
+  }
+  const __m256i first = _mm256_set1_epi8(needle[0]);
+  const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+  size_t i = 0;
+  for (; i + needle_len - 1 + 32 <= haystack_len; i += 32) {
+    const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i));
+    const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i + needle_len - 1));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))));
+    while (mask) {
+      const size_t pos = i + __builtin_ctz(mask);
+      if (!memcmp(haystack + pos + 1, needle + 1, needle_len - 2)) {
+        return haystack + pos;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return memmem_sse2(haystack + i, haystack_len - i, needle, needle_len);
+}
+
+const char *find_first_of_sse2(const char *s, size_t len, const char *chars, size_t chars_count) {
+  assert(chars_count > 0 && chars_count <= SIMD_FIND_FIRST_OF_MAX_CHARS);
+  __m128i patterns[SIMD_FIND_FIRST_OF_MAX_CHARS];
+  for (size_t j = 0; j < chars_count; ++j) {
+    patterns[j] = _mm_set1_epi8(chars[j]);
+  }
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    __m128i matched = _mm_cmpeq_epi8(block, patterns[0]);
+    for (size_t j = 1; j < chars_count; ++j) {
+      matched = _mm_or_si128(matched, _mm_cmpeq_epi8(block, patterns[j]));
+    }
+    if (const int mask = _mm_movemask_epi8(matched)) {
+      return s + i + __builtin_ctz(mask);
+    }
+  }
+  return simd_find_first_of_generic(s + i, len - i, chars, chars_count);
+}
+
+__attribute__((target("avx2")))
+const char *find_first_of_avx2(const char *s, size_t len, const char *chars, size_t chars_count) {
+  assert(chars_count > 0 && chars_count <= SIMD_FIND_FIRST_OF_MAX_CHARS);
+  __m256i patterns[SIMD_FIND_FIRST_OF_MAX_CHARS];
+  for (size_t j = 0; j < chars_count; ++j) {
+    patterns[j] = _mm256_set1_epi8(chars[j]);
+  }
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+    __m256i matched = _mm256_cmpeq_epi8(block, patterns[0]);
+    for (size_t j = 1; j < chars_count; ++j) {
+      matched = _mm256_or_si256(matched, _mm256_cmpeq_epi8(block, patterns[j]));
+    }
+    if (const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matched))) {
+      return s + i + __builtin_ctz(mask);
+    }
+  }
+  return find_first_of_sse2(s + i, len - i, chars, chars_count);
+}
+
+// the blocks with non ascii bytes are converted bytewise, as the convert function is locale dependent
+void convert_case_sse2(char *dst, const char *src, size_t len, int (*convert)(int), char case_from, char case_to) {
+  const __m128i from = _mm_set1_epi8(static_cast<char>(case_from - 1));
+  const __m128i to = _mm_set1_epi8(static_cast<char>(case_to + 1));
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    if (_mm_movemask_epi8(block)) {
+      convert_case_tail(dst + i, src + i, 16, convert, case_from, case_to);
+      continue;
+    }
+    const __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(block, from), _mm_cmplt_epi8(block, to));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(block, _mm_and_si128(in_range, case_bit)));
+  }
+  convert_case_tail(dst + i, src + i, len - i, convert, case_from, case_to);
+}
+
+__attribute__((target("avx2")))
+void convert_case_avx2(char *dst, const char *src, size_t len, int (*convert)(int), char case_from, char case_to) {
+  const __m256i from = _mm256_set1_epi8(static_cast<char>(case_from - 1));
+  const __m256i to = _mm256_set1_epi8(static_cast<char>(case_to + 1));
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    if (_mm256_movemask_epi8(block)) {
+      convert_case_sse2(dst + i, src + i, 32, convert, case_from, case_to);
+      continue;
+    }
+    const __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(block, from), _mm256_cmpgt_epi8(to, block));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(block, _mm256_and_si256(in_range, case_bit)));
+  }
+  convert_case_sse2(dst + i, src + i, len - i, convert, case_from, case_to);
+}
+
+bool is_avx2_supported(const kdb_cpuid_t *p) {
+  constexpr int osxsave_bit = 1 << 27;
+  constexpr int avx_bit = 1 << 28;
+  constexpr int avx2_bit = 1 << 5;
+  if ((p->x86_64.ecx & (osxsave_bit | avx_bit)) != (osxsave_bit | avx_bit) || !(p->x86_64.extended_ebx & avx2_bit)) {
+    return false;
+  }
+  // the OS must save the ymm registers on the context switches
+  uint32_t xcr0 = 0;
+  uint32_t xcr0_high = 0;
+  asm volatile("xgetbv" : "=a"(xcr0), "=d"(xcr0_high) : "c"(0));
+  return (xcr0 & 6) == 6;
+}
+
+#endif
+
+} // namespace
+
+const char *simd_memmem_generic(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len) {
+  return static_cast<const char *>(memmem(haystack, haystack_len, needle, needle_len));
+}
+
+const char *simd_find_first_of_generic(const char *s, size_t len, const char *chars, size_t chars_count) {
+  for (size_t i = 0; i < len; ++i) {
+    if (memchr(chars, s[i], chars_count)) {
+      return s + i;
+    }
+  }
+  return nullptr;
+}
+
+void simd_convert_case_generic(char *dst, const char *src, size_t len, int (*convert)(int), char case_from, char case_to) {
+  convert_case_tail(dst, src, len, convert, case_from, case_to);
+}
+
+simd_memmem_func_t simd_memmem = simd_memmem_generic;
+simd_find_first_of_func_t simd_find_first_of = simd_find_first_of_generic;
+simd_convert_case_func_t simd_convert_case = simd_convert_case_generic;
+const char *simd_string_kernels_name = "generic";
+
+void simd_string_init() __attribute__ ((constructor(101)));
+void simd_string_init() {
+#if defined(__x86_64__)
+  const kdb_cpuid_t *p = kdb_cpuid();
+  assert(p->type == KDB_CPUID_X86_64);
+
+  if (is_avx2_supported(p)) {
+    simd_memmem = memmem_avx2;
+    simd_find_first_of = find_first_of_avx2;
+    simd_convert_case = convert_case_avx2;
+    simd_string_kernels_name = "avx2";
+  } else {
+    simd_memmem = memmem_sse2;
+    simd_find_first_of = find_first_of_sse2;
+    simd_convert_case = convert_case_sse2;
+    simd_string_kernels_name = "sse2";
+  }
+#endif
+}
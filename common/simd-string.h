@@ -0,0 +1,33 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+
+// The search and conversion kernels for the string functions.
+// The implementations are chosen on startup by the cpu features: AVX2 or SSE2 on x86_64, the generic ones otherwise.
+
+// the same as memmem
+using simd_memmem_func_t = const char *(*)(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len);
+
+// returns a pointer to the first byte of s, which is equal to one of chars[0..chars_count), or nullptr;
+// chars_count must be in [1, SIMD_FIND_FIRST_OF_MAX_CHARS]
+using simd_find_first_of_func_t = const char *(*)(const char *s, size_t len, const char *chars, size_t chars_count);
+constexpr size_t SIMD_FIND_FIRST_OF_MAX_CHARS = 8;
+
+// dst[i] = convert(src[i]), the ascii bytes in the [case_from, case_to] range of latin letters are converted by flipping their case bit,
+// the other ascii bytes are copied as is, so convert is called only for the non ascii bytes; dst and src may be the same
+using simd_convert_case_func_t = void (*)(char *dst, const char *src, size_t len, int (*convert)(int), char case_from, char case_to);
+
+extern simd_memmem_func_t simd_memmem;
+extern simd_find_first_of_func_t simd_find_first_of;
+extern simd_convert_case_func_t simd_convert_case;
+
+// the name of the chosen kernels set: "avx2", "sse2" or "generic"
+extern const char *simd_string_kernels_name;
+
+const char *simd_memmem_generic(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len);
+const char *simd_find_first_of_generic(const char *s, size_t len, const char *chars, size_t chars_count);
+void simd_convert_case_generic(char *dst, const char *src, size_t len, int (*convert)(int), char case_from, char case_to);
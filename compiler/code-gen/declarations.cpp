@@ -566,6 +566,8 @@ void ClassDeclaration::compile_accept_visitor_methods(CodeGenerator &W, ClassPtr
     W << NL;
     compile_accept_visitor(W, klass, "InstanceDeepCopyVisitor");
     compile_accept_visitor(W, klass, "InstanceDeepDestroyVisitor");
+    compile_accept_visitor(W, klass, "InstanceCacheDumpVisitor");
+    compile_accept_visitor(W, klass, "InstanceCacheRestoreVisitor");
   }
 }
 
@@ -595,8 +597,10 @@ void ClassDeclaration::compile_serialize(CodeGenerator &W, ClassPtr klass) {
     }
   });
 
+  // the packer is a template, as msgpack_serialize() packs the value twice through different streams
+  W << "template<typename Packer>" << NL;
   FunctionSignatureGenerator(W).set_const_this()
-    << "void msgpack_pack(msgpack::packer<string_buffer> &packer)" << BEGIN
+    << "void msgpack_pack(Packer &packer)" << BEGIN
     << "packer.pack_array(" << cnt_fields << ");" << NL
     << body << NL
     << END << NL;
@@ -39,6 +39,12 @@ void FunctionH::compile(CodeGenerator &W) const {
   if (function->is_flatten) {
     W << " __attribute__((flatten))";
   }
+  // hot and cold functions are placed into the .text.hot and .text.unlikely sections
+  if (function->is_hot) {
+    W << " __attribute__((hot))";
+  } else if (function->is_cold) {
+    W << " __attribute__((cold))";
+  }
   W << ";" << NL;
   if (function->is_resumable) {
     W << FunctionForkDeclaration(function, true) << ";" << NL;
@@ -74,17 +74,16 @@ void TypeTagger::compile(CodeGenerator &W) const {
   W << "php_assert(0);" << NL;
   W << END << NL;
 
-  std::set<std::string> waitable_types_str;
+  // the runtime drops the results awaited by the abandoned forks with the void loader
+  std::set<std::string> waitable_types_str = {"void"};
   for (auto type : waitable_types) {
     waitable_types_str.insert(type_out(type, gen_out_style::tagger));
   }
-  if (!waitable_types_str.empty()) {
-    W << "auto unused_loaders_list __attribute__((unused)) = " << BEGIN;
-    for (const auto &type : waitable_types_str) {
-      W << "(void*)(Storage::loader<" << type << ">::get_function)," << NL;
-    }
-    W << END << ";" << NL;
+  W << "auto unused_loaders_list __attribute__((unused)) = " << BEGIN;
+  for (const auto &type : waitable_types_str) {
+    W << "(void*)(Storage::loader<" << type << ">::get_function)," << NL;
   }
+  W << END << ";" << NL;
 
   W << CloseFile();
 }
@@ -57,7 +57,7 @@ static void add_dependent_declarations(VertexPtr vertex, std::set<VarPtr> &depen
 void compile_raw_array(CodeGenerator &W, const VarPtr &var, int shift) {
   if (shift == -1) {
     W << InitVar(var);
-    W << VarName(var) << ".set_reference_counter_to(ExtraRefCnt::for_global_const);" << NL << NL;
+    W << "pin_global_const(" << VarName(var) << ");" << NL << NL;
     return;
   }
 
@@ -165,11 +165,11 @@ static std::vector<bool> compile_vars_part(CodeGenerator &W, const std::vector<V
         auto type_data = var->tinf_node.get_type();
         PrimitiveType ptype = type_data->ptype();
         if (vk::any_of_equal(ptype, tp_array, tp_mixed, tp_string)) {
-          W << VarName(var);
+          W << "pin_global_const(" << VarName(var);
           if (type_data->use_optional()) {
             W << ".val()";
           }
-          W << ".set_reference_counter_to(ExtraRefCnt::for_global_const);" << NL;
+          W << ");" << NL;
         }
       }
     }
@@ -14,6 +14,8 @@ WriterData::WriterData(bool compile_with_debug_info_flag, bool compile_with_crc)
   lines(),
   text(),
   crc(-1),
+  code_with_comments(),
+  crc_with_comments(-1),
   compile_with_debug_info_flag(compile_with_debug_info_flag),
   compile_with_crc_flag(compile_with_crc),
   file_name(),
@@ -191,6 +193,23 @@ void WriterData::dump(std::string &dest_str) {
   }
 }
 
+void WriterData::prepare_code_with_comments() {
+  calc_crc();
+  dump(code_with_comments);
+  crc_with_comments = compute_crc64(code_with_comments.c_str(), code_with_comments.length());
+
+  std::vector<Line>{}.swap(lines);
+  std::string{}.swap(text);
+}
+
+const std::string &WriterData::get_code_with_comments() const {
+  return code_with_comments;
+}
+
+unsigned long long WriterData::get_crc_with_comments() const {
+  return crc_with_comments;
+}
+
 bool WriterData::compile_with_debug_info() const {
   return compile_with_debug_info_flag;
 }
@@ -25,6 +25,9 @@ private:
   std::vector<Line> lines;
   std::string text;
   unsigned long long crc;
+  // the code with the php source comments, which is written to the file
+  std::string code_with_comments;
+  unsigned long long crc_with_comments;
 
   std::vector<std::string> includes;
   std::vector<std::string> lib_includes;
@@ -65,6 +68,10 @@ public:
 
   unsigned long long calc_crc();
   void dump(std::string &dest_str);
+  // dumps the code with comments and computes its crc, the raw text and lines are released after that
+  void prepare_code_with_comments();
+  const std::string &get_code_with_comments() const;
+  unsigned long long get_crc_with_comments() const;
 
   bool compile_with_debug_info() const;
   bool compile_with_crc() const;
@@ -62,7 +62,8 @@ void Writer::end_write() {
   end_line();
 
   if (!stage::has_error()) {
-    data.calc_crc();
+    // the files are written by one thread, so the heavy part is done here, in the code generation threads
+    data.prepare_code_with_comments();
     os << std::move(data);
   }
 
@@ -517,6 +517,12 @@ void CompilerCore::try_load_tl_classes() {
   }
 }
 
+void CompilerCore::try_load_profile_guided_hints() {
+  if (!settings().profiler_dumps.get().empty()) {
+    profile_guided_hints.load_from(settings().profiler_dumps.get());
+  }
+}
+
 void CompilerCore::init_composer_class_loader() {
   if (!settings().is_composer_enabled()) {
     return;
@@ -14,6 +14,7 @@
 #include "compiler/compiler-settings.h"
 #include "compiler/common.h"
 #include "compiler/index.h"
+#include "compiler/profile-guided-hints.h"
 #include "compiler/stats.h"
 #include "compiler/threading/data-stream.h"
 #include "compiler/threading/hash-table.h"
@@ -34,6 +35,7 @@ private:
   TSHashTable<ClassPtr> classes_ht;
   ClassPtr memcache_class;
   TlClasses tl_classes;
+  ProfileGuidedHints profile_guided_hints;
   std::vector<std::string> kphp_runtime_opts;
   bool is_untyped_rpc_tl_used{false};
 
@@ -104,6 +106,9 @@ public:
   void init_composer_class_loader();
   const TlClasses &get_tl_classes() const { return tl_classes; }
 
+  void try_load_profile_guided_hints();
+  const ProfileGuidedHints &get_profile_guided_hints() const { return profile_guided_hints; }
+
   void add_kphp_runtime_opt(std::string opt) { kphp_runtime_opts.emplace_back(std::move(opt)); }
   const std::vector<std::string> &get_kphp_runtime_opts() const { return kphp_runtime_opts; }
 
@@ -248,10 +248,6 @@ void CompilerSettings::init() {
     throw std::runtime_error{"Option " + threads_count.get_env_var() + " is expected to be <= " + std::to_string(MAX_THREADS_COUNT)};
   }
 
-  if (globals_split_count.get() == 0) {
-    throw std::runtime_error{"globals-split-count may not be equal to zero"};
-  }
-
   for (std::string &include : includes.value_) {
     include = as_dir(include);
   }
@@ -334,6 +330,7 @@ void CompilerSettings::init() {
   option_as_dir(dest_dir);
   dest_cpp_dir.value_ = dest_dir.get() + "kphp/";
   dest_objs_dir.value_ = dest_dir.get() + "objs/";
+  compile_times_file.value_ = dest_dir.get() + "compile_times";
   binary_path.value_ = dest_dir.get() + mode.get();
   performance_analyze_report_path.value_ = dest_dir.get() + "performance_issues.json";
   generated_runtime_path.value_ = kphp_src_path.get() + "objs/generated/auto/runtime/";
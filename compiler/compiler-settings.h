@@ -148,13 +148,16 @@ public:
   KphpOption<std::string> php_code_version;
 
   KphpOption<std::string> cxx;
+  KphpOption<std::string> cxx_launcher;
   KphpOption<std::string> extra_cxx_flags;
   KphpOption<std::string> extra_ld_flags;
   KphpOption<std::string> extra_cxx_debug_level;
   KphpOption<std::string> archive_creator;
   KphpOption<bool> dynamic_incremental_linkage;
+  KphpOption<uint64_t> unity_build_size;
 
   KphpOption<uint64_t> profiler_level;
+  KphpOption<std::vector<std::string>> profiler_dumps;
   KphpOption<bool> enable_global_vars_memory_stats;
   KphpOption<bool> enable_full_performance_analyze;
   KphpOption<bool> print_resumable_graph;
@@ -172,6 +175,7 @@ public:
   KphpImplicitOption base_dir;
   KphpImplicitOption dest_cpp_dir;
   KphpImplicitOption dest_objs_dir;
+  KphpImplicitOption compile_times_file;
   KphpImplicitOption binary_path;
   KphpImplicitOption static_lib_name;
   KphpImplicitOption generated_runtime_path;
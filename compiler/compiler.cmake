@@ -27,7 +27,9 @@ prepend(KPHP_COMPILER_SCHEDULER_SOURCES scheduler/
 
 prepend(KPHP_COMPILER_MAKE_SOURCES make/
         hardlink-or-copy.cpp
+        job-launcher.cpp
         make-runner.cpp
+        make-stats.cpp
         make.cpp
         target.cpp)
 
@@ -173,6 +175,7 @@ prepend(KPHP_COMPILER_SOURCES ${KPHP_COMPILER_DIR}/
         name-gen.cpp
         operation.cpp
         phpdoc.cpp
+        profile-guided-hints.cpp
         stage.cpp
         stats.cpp
         type-hint.cpp
@@ -223,6 +223,7 @@ bool compiler_execute(CompilerSettings *settings) {
   }
 
   G->try_load_tl_classes();
+  G->try_load_profile_guided_hints();
   G->init_composer_class_loader();
 
   PipeC<LoadFileF>::get()->set_input_stream(&src_file_stream);
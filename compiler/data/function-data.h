@@ -105,6 +105,9 @@ public:
   bool warn_unused_result = false;
   bool is_flatten = false;
   bool is_pure = false;
+  // set from the profiler dumps (see ProfileGuidedHints)
+  bool is_hot = false;
+  bool is_cold = false;
 
   enum class profiler_status : uint8_t {
     disable,
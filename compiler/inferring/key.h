@@ -39,6 +39,7 @@ public:
   friend inline bool operator<(const Key &a, const Key &b);
   friend inline bool operator!=(const Key &a, const Key &b);
   friend inline bool operator==(const Key &a, const Key &b);
+  friend struct std::hash<Key>;
 };
 
 inline bool operator<(const Key &a, const Key &b) {
@@ -52,3 +53,12 @@ inline bool operator!=(const Key &a, const Key &b) {
 inline bool operator==(const Key &a, const Key &b) {
   return a.id == b.id;
 }
+
+namespace std {
+template<>
+struct hash<Key> {
+  size_t operator()(const Key &key) const {
+    return std::hash<int>{}(key.id);
+  }
+};
+} // namespace std
@@ -156,7 +156,8 @@ NodeRecalc::NodeRecalc(tinf::Node *node, tinf::TypeInferer *inferer) :
 void NodeRecalc::on_changed() {
   //fmt_fprintf(stderr, "{} : {} -> {}\n", node_->get_description(), type_out(node_->get_type()), type_out(new_type()));
   new_type_->mark_classes_used();
-  node_->set_type(new_type_);
+  // the previous node type can't be freed (other threads may be reading it now), so share the identical types at least
+  node_->set_type(TypeData::intern(new_type_));
   new_type_ = nullptr;
 
   // here we need a lock: in case another thread updates edges_to_this_ just now via auto edge
@@ -4,6 +4,9 @@
 
 #include "compiler/inferring/type-data.h"
 
+#include <algorithm>
+#include <atomic>
+#include <forward_list>
 #include <string>
 #include <vector>
 
@@ -11,8 +14,10 @@
 #include "common/algorithms/contains.h"
 #include "common/termformat/termformat.h"
 
+#include "common/algorithms/hashes.h"
 #include "common/php-functions.h"
 #include "compiler/code-gen/common.h"
+#include "compiler/compiler-core.h"
 #include "compiler/data/class-data.h"
 #include "compiler/pipes/collect-main-edges.h"
 #include "compiler/stage.h"
@@ -23,15 +28,22 @@
 static std::vector<const TypeData *> primitive_types;
 static std::vector<const TypeData *> array_types;
 
+// structural hash -> interned types with this hash
+static TSHashTable<std::forward_list<const TypeData *>> *interned_types;
+static std::atomic<int> interned_types_count{0};
+// TSHashTable has a fixed size, so after this limit new types are just not interned
+static constexpr int max_interned_types_count = 400000;
+
 void TypeData::init_static() {
   if (!primitive_types.empty()) {
     return;
   }
+  interned_types = new TSHashTable<std::forward_list<const TypeData *>>();
   primitive_types.resize(ptype_size);
   array_types.resize(ptype_size);
 
   for (int tp = 0; tp < ptype_size; tp++) {
-    primitive_types[tp] = new TypeData((PrimitiveType)tp);
+    primitive_types[tp] = intern(new TypeData((PrimitiveType)tp));
   }
 
   for (int tp = 0; tp < ptype_size; tp++) {
@@ -74,7 +86,9 @@ TypeData::TypeData(const TypeData &from) :
 
 TypeData::~TypeData() {
   for (auto &subkey : subkeys) {
-    delete subkey.second;
+    if (!subkey.second->interned_) {
+      delete subkey.second;
+    }
   }
 }
 
@@ -712,6 +726,9 @@ bool can_be_same_type(const TypeData *type1, const TypeData *type2) {
 // check if types fully equal (if type2 is any, it's equal to anything)
 // note that false != bool here
 bool are_equal_types(const TypeData *type1, const TypeData *type2) {
+  if (type1 == type2) {
+    return true;
+  }
   if (type1 == nullptr) {
     return type2 == nullptr;
   }
@@ -836,6 +853,9 @@ size_t TypeData::get_tuple_max_index() const {
 }
 
 bool TypeData::did_type_data_change_after_tinf_step(const TypeData *before) const {
+  if (this == before) {
+    return false;
+  }
   if (ptype_ != before->ptype_ || flags_ != before->flags_) {
     return true;
   }
@@ -863,12 +883,77 @@ bool TypeData::did_type_data_change_after_tinf_step(const TypeData *before) cons
 const TypeData *TypeData::create_for_class(ClassPtr klass) {
   auto *res = new TypeData(tp_Class);
   res->class_type_ = {klass};
-  return res;
+  return intern(res);
 }
 
 const TypeData *TypeData::create_array_of(const TypeData *element_type) {
   auto *res = new TypeData(tp_array);
   res->set_lca_at(MultiKey::any_key(1), element_type);
-  return res;
+  return intern(res);
+}
+
+size_t TypeData::structural_hash() const {
+  size_t hash = (static_cast<size_t>(ptype_) << 8) | flags_;
+  for (ClassPtr klass : class_type_) {
+    vk::hash_combine(hash, std::hash<ClassPtr>{}(klass));
+  }
+  // the order of tuple/shape subkeys depends on the order they were inserted in, so they are combined commutatively
+  size_t subkeys_hash = 0;
+  for (const SubkeyItem &subkey : subkeys) {
+    size_t subkey_hash = std::hash<Key>{}(subkey.first);
+    vk::hash_combine(subkey_hash, subkey.second->structural_hash());
+    subkeys_hash += subkey_hash;
+  }
+  vk::hash_combine(hash, subkeys_hash);
+  return hash;
+}
+
+bool TypeData::is_identical_to(const TypeData *other) const {
+  if (this == other) {
+    return true;
+  }
+  if (ptype_ != other->ptype_ || flags_ != other->flags_ || class_type_ != other->class_type_) {
+    return false;
+  }
+  // keys are unique within a type, so equal sizes and every key found with an identical type mean identical subkeys
+  size_t subkeys_count = 0;
+  for (const SubkeyItem &subkey : subkeys) {
+    const auto other_subkey = std::find_if(other->subkeys.begin(), other->subkeys.end(),
+                                           [&subkey](const SubkeyItem &item) { return item.first == subkey.first; });
+    if (other_subkey == other->subkeys.end() || !subkey.second->is_identical_to(other_subkey->second)) {
+      return false;
+    }
+    ++subkeys_count;
+  }
+  return subkeys_count == static_cast<size_t>(std::distance(other->subkeys.begin(), other->subkeys.end()));
+}
+
+const TypeData *TypeData::intern(TypeData *type) {
+  if (type->interned_ || interned_types_count >= max_interned_types_count) {
+    return type;
+  }
+  // inner types are interned before the outer one: interned subkeys are compared by a pointer
+  // and are not deleted along with a duplicate
+  for (SubkeyItem &subkey : type->subkeys) {
+    if (!subkey.second->interned_) {
+      subkey.second = const_cast<TypeData *>(intern(subkey.second));
+    }
+  }
+  // 0 is an empty cell in TSHashTable
+  const unsigned long long hash = type->structural_hash() ?: 1;
+  auto *cell = interned_types->at(hash);
+  AutoLocker<Lockable *> locker(cell);
+  for (const TypeData *interned : cell->data) {
+    if (interned->is_identical_to(type)) {
+      delete type;
+      G->stats.cnt_interned_types_reused++;
+      return interned;
+    }
+  }
+  type->interned_ = true;
+  cell->data.push_front(type);
+  interned_types_count++;
+  G->stats.cnt_interned_types++;
+  return type;
 }
 
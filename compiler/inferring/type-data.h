@@ -37,6 +37,7 @@ private:
 
   PrimitiveType ptype_ : 8;     // current type (int/array/etc); tp_any for uninited, tp_Error if error
   uint8_t flags_{0};            // a binary mask of flag_id_t
+  bool interned_{false};        // interned types are shared (also as subkeys of other interned types) and never deleted
 
   // current class for tp_Class (but during inferring it could contain many classes due to multiple implements)
   std::forward_list<ClassPtr> class_type_;
@@ -62,6 +63,9 @@ private:
   template<typename F>
   bool for_each_deep(const F &visitor) const;
 
+  size_t structural_hash() const;
+  bool is_identical_to(const TypeData *other) const;
+
 public:
   TypeData &operator=(const TypeData &) = delete;
   TypeData(const TypeData &from);
@@ -136,6 +140,11 @@ public:
   static const TypeData *get_type(PrimitiveType array, PrimitiveType type);
   static const TypeData *create_for_class(ClassPtr klass);
   static const TypeData *create_array_of(const TypeData *element_type);
+
+  // hash-consing: returns an immutable type shared by all the structurally identical interned types,
+  // takes the ownership of the passed type — it's either interned or deleted if an identical type was interned before;
+  // subkeys are interned recursively, so identical inner types are shared as well
+  static const TypeData *intern(TypeData *type);
 };
 
 std::string type_out(const TypeData *type, gen_out_style style = gen_out_style::cpp);
@@ -4,6 +4,8 @@
 
 #include "compiler/inferring/type-inferer.h"
 
+#include "common/dl-utils-lite.h"
+
 #include "compiler/compiler-core.h"
 #include "compiler/data/function-data.h"
 #include "compiler/data/src-file.h"
@@ -83,6 +85,7 @@ public:
 CachedProfiler TypeInfererTask::type_inferer_profiler{"Type Inferring"};
 
 std::vector<Task *> TypeInferer::get_tasks() {
+  start_time = dl_time();
   std::vector<Task *> res;
   for (int i = 0; i < Q.size(); i++) {
     NodeQueue q = std::move(Q.get(i));
@@ -127,6 +130,7 @@ void TypeInferer::run_node(Node *node) {
 void TypeInferer::finish() {
   finish_flag = true;
   kphp_assert(Q->empty());
+  G->stats.on_type_inference_finished(dl_time() - start_time);
 }
 
 
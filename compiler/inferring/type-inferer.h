@@ -19,6 +19,7 @@ class TypeInferer {
 private:
   TLS<std::vector<RestrictionBase *>> restrictions;
   bool finish_flag;
+  double start_time{0};
 
 public:
   TLS<NodeQueue> Q;
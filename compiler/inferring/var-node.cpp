@@ -50,6 +50,7 @@ void VarNodeRecalc::do_recalc() {
     // on type mismatch — rollback new_type_ to the start position and calculate it once again, checking every edge
     // when we find a mismatching edge, create a postponed check (which will trigger an error of course) and just skip it
     // so, passed string/tuple won't affect @param array, but will show a mismatch error after tinf finishes
+    delete new_type_;
     new_type_ = node->get_type()->clone();
 
     for (const tinf::Edge *e : node->get_edges_from_this()) {
@@ -60,7 +61,7 @@ void VarNodeRecalc::do_recalc() {
       if (!satisfied) {
 //          fmt_print("rollback {} from {} to {} due to restriction {}\n", node->get_description(), colored_type_out(new_type_), colored_type_out(before_type), colored_type_out(node->type_restriction));
         on_restricted_type_mismatch(e, node->type_restriction);
-        new_type_ = before_type->clone();
+        std::swap(new_type_, before_type);
       }
 
       delete before_type;
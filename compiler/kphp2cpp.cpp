@@ -235,7 +235,8 @@ int main(int argc, char *argv[]) {
              'j', "jobs-num", "KPHP_JOBS_COUNT", std::to_string(get_default_threads_count()));
   parser.add("Threads number for the transpilation", settings->threads_count,
              't', "threads-count", "KPHP_THREADS_COUNT", std::to_string(get_default_threads_count()));
-  parser.add("Count of global variables per dedicated .cpp file. Lowering it could decrease compilation time", settings->globals_split_count,
+  parser.add("Count of global variables per dedicated .cpp file. Lowering it could decrease compilation time. "
+             "0 means to choose it by the compilation times of the previous builds", settings->globals_split_count,
              "globals-split-count", "KPHP_GLOBALS_SPLIT_COUNT", "1024");
   parser.add("Builtin tl schema. Incompatible with lib mode", settings->tl_schema_file,
              'T', "tl-schema", "KPHP_TL_SCHEMA");
@@ -261,6 +262,8 @@ int main(int argc, char *argv[]) {
              "php-code-version", "KPHP_PHP_CODE_VERSION", "unknown");
   parser.add("C++ compiler for building the output binary", settings->cxx,
              "cxx", "KPHP_CXX", get_default_cxx());
+  parser.add("C++ compiler launcher for building the output binary, e.g. ccache, distcc or sccache", settings->cxx_launcher,
+             "cxx-launcher", "KPHP_CXX_LAUNCHER");
   parser.add("Extra C++ compiler flags for building the output binary", settings->extra_cxx_flags,
              "extra-cxx-flags", "KPHP_EXTRA_CXXFLAGS", get_default_extra_cxxflags());
   parser.add("Extra linker flags for building the output binary", settings->extra_ld_flags,
@@ -271,8 +274,12 @@ int main(int argc, char *argv[]) {
              "archive-creator", "KPHP_ARCHIVE_CREATOR", "ar");
   parser.add("Use dynamic incremental linkage for building the output binary", settings->dynamic_incremental_linkage,
              "dynamic-incremental-linkage", "KPHP_DYNAMIC_INCREMENTAL_LINKAGE");
+  parser.add("Compile the small generated function sources together in the unity build sources of this size in bytes, 0 - disabled",
+             settings->unity_build_size, "unity-build-size", "KPHP_UNITY_BUILD_SIZE", "0");
   parser.add("Profile functions: 0 - disabled, 1 - enabled for marked functions, 2 - enabled for all", settings->profiler_level,
              'g', "profiler", "KPHP_PROFILER", "0", {"0", "1", "2"});
+  parser.add("Profiler dumps for marking generated functions as hot or cold", settings->profiler_dumps,
+             "profiler-dump", "KPHP_PROFILER_DUMPS");
   parser.add("Enable an ability to get global vars memory stats", settings->enable_global_vars_memory_stats,
              "enable-global-vars-memory-stats", "KPHP_ENABLE_GLOBAL_VARS_MEMORY_STATS");
   parser.add("Enable all performance analyze inspections for all reachable functions", settings->enable_full_performance_analyze,
@@ -300,6 +307,7 @@ int main(int argc, char *argv[]) {
   parser.add_implicit_option("Base directory", settings->base_dir);
   parser.add_implicit_option("CPP destination directory", settings->dest_cpp_dir);
   parser.add_implicit_option("Objs destination directory", settings->dest_objs_dir);
+  parser.add_implicit_option("Compile times file", settings->compile_times_file);
   parser.add_implicit_option("Binary path", settings->binary_path);
   parser.add_implicit_option("Static lib name", settings->static_lib_name);
   parser.add_implicit_option("Runtime SHA256", settings->runtime_sha256);
@@ -28,6 +28,10 @@ public:
     return ss.str();
   }
 
+  bool is_compilation() const final {
+    return true;
+  }
+
   void compute_priority() final {
     priority = 0;
     for (auto dep : deps) {
@@ -0,0 +1,51 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/make/job-launcher.h"
+
+#include <cstdio>
+#include <unistd.h>
+#include <vector>
+
+#include "compiler/utils/string-utils.h"
+
+pid_t LocalJobLauncher::launch(const std::string &cmd) {
+  // fmt_print("{}\n", cmd);
+  std::vector<std::string> args = split(cmd);
+  std::vector<char *> argv(args.size() + 1);
+  for (int i = 0; i < (int)args.size(); i++) {
+    argv[i] = (char *)args[i].c_str();
+  }
+  argv.back() = nullptr;
+
+  pid_t pid = vfork();
+  if (pid < 0) {
+    perror("vfork failed: ");
+    return pid;
+  }
+
+  if (pid == 0) {
+    //prctl (PR_SET_PDEATHSIG, SIGKILL);
+    execvp(argv[0], &argv[0]);
+    perror("execvp failed: ");
+    _exit(1);
+  } else {
+    return pid;
+  }
+}
+
+WrappedJobLauncher::WrappedJobLauncher(std::string wrapper) noexcept:
+  wrapper_(std::move(wrapper)) {
+}
+
+pid_t WrappedJobLauncher::launch(const std::string &cmd) {
+  return local_launcher_.launch(wrapper_ + " " + cmd);
+}
+
+std::unique_ptr<JobLauncher> create_compilation_launcher(const std::string &wrapper) {
+  if (wrapper.empty()) {
+    return std::make_unique<LocalJobLauncher>();
+  }
+  return std::make_unique<WrappedJobLauncher>(wrapper);
+}
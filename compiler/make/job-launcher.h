@@ -0,0 +1,40 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+#include "common/mixin/not_copyable.h"
+
+// Starts the processes of the make jobs, MakeRunner waits for them as for its children
+class JobLauncher : private vk::not_copyable {
+public:
+  // returns the pid of the started process, or -1 on error
+  virtual pid_t launch(const std::string &cmd) = 0;
+  virtual ~JobLauncher() = default;
+};
+
+// runs the job command itself
+class LocalJobLauncher final : public JobLauncher {
+public:
+  pid_t launch(const std::string &cmd) final;
+};
+
+// runs the job command through a compiler wrapper, e.g. ccache, distcc or sccache,
+// the latter keeps a local server, that reuses the warm compiler state between the jobs
+class WrappedJobLauncher final : public JobLauncher {
+public:
+  explicit WrappedJobLauncher(std::string wrapper) noexcept;
+  pid_t launch(const std::string &cmd) final;
+
+private:
+  std::string wrapper_;
+  LocalJobLauncher local_launcher_;
+};
+
+// an empty wrapper means the local launcher
+std::unique_ptr<JobLauncher> create_compilation_launcher(const std::string &wrapper);
@@ -4,13 +4,13 @@
 
 #include "compiler/make/make-runner.h"
 
+#include <algorithm>
 #include <sys/wait.h>
 
 #include "common/dl-utils-lite.h"
 #include "common/server/signals.h"
 
 #include "compiler/compiler-core.h"
-#include "compiler/utils/string-utils.h"
 
 void MakeRunner::run_target(Target *target) {
   bool ready = target->mtime != 0;
@@ -25,6 +25,10 @@ void MakeRunner::run_target(Target *target) {
 
   if (!ready) {
     target->compute_priority();
+    auto previous_time_it = compile_times_.find(target->get_name());
+    if (previous_time_it != compile_times_.end()) {
+      target->expected_duration = previous_time_it->second;
+    }
     pending_jobs.push(target);
   } else {
     ready_target(target);
@@ -87,36 +91,12 @@ void MakeRunner::require_target(Target *target) {
   }
 }
 
-static int run_cmd(const string &cmd) {
-  // fmt_print("{}\n", cmd);
-  vector<string> args = split(cmd);
-  vector<char *> argv(args.size() + 1);
-  for (int i = 0; i < (int)args.size(); i++) {
-    argv[i] = (char *)args[i].c_str();
-  }
-  argv.back() = nullptr;
-
-  int pid = vfork();
-  if (pid < 0) {
-    perror("vfork failed: ");
-    return pid;
-  }
-
-  if (pid == 0) {
-    //prctl (PR_SET_PDEATHSIG, SIGKILL);
-    execvp(argv[0], &argv[0]);
-    perror("execvp failed: ");
-    _exit(1);
-  } else {
-    return pid;
-  }
-}
-
 bool MakeRunner::start_job(Target *target) {
   target->start_time = dl_time();
   string cmd = target->get_cmd();
 
-  int pid = run_cmd(cmd);
+  JobLauncher &launcher = target->is_compilation() ? *compilation_launcher_ : local_launcher_;
+  int pid = launcher.launch(cmd);
   if (pid < 0) {
     return false;
   }
@@ -128,8 +108,9 @@ bool MakeRunner::finish_job(int pid, int return_code, int by_signal) {
   auto it = jobs.find(pid);
   assert (it != jobs.end());
   Target *target = it->second;
+  target->finish_time = dl_time();
+  const double passed = target->finish_time - target->start_time;
   if (stats_file_) {
-    double passed = dl_time() - target->start_time;
     fmt_fprintf(stats_file_, "{}s {}\n", passed, target->get_name());
   }
   jobs.erase(it);
@@ -151,6 +132,7 @@ bool MakeRunner::finish_job(int pid, int return_code, int by_signal) {
   if (!target->after_run_success()) {
     return false;
   }
+  compile_times_[target->get_name()] = passed;
   ready_target(target);
   return true;
 }
@@ -169,6 +151,39 @@ void MakeRunner::on_fail() {
   }
 }
 
+// The critical path ends with the last built target and goes through the deps, which were finished last:
+// it shows the chain of the jobs, which the build was waiting for
+void MakeRunner::write_critical_path(const std::vector<Target *> &targets, double make_start_time) {
+  Target *last_target = nullptr;
+  for (auto *target : targets) {
+    if (target->finish_time > 0 && (!last_target || target->finish_time > last_target->finish_time)) {
+      last_target = target;
+    }
+  }
+  if (!last_target) {
+    return;
+  }
+
+  std::vector<Target *> critical_path;
+  for (Target *target = last_target; target != nullptr;) {
+    critical_path.emplace_back(target);
+    Target *last_dep = nullptr;
+    for (auto *dep : target->deps) {
+      if (dep->finish_time > 0 && (!last_dep || dep->finish_time > last_dep->finish_time)) {
+        last_dep = dep;
+      }
+    }
+    target = last_dep;
+  }
+  std::reverse(critical_path.begin(), critical_path.end());
+
+  fmt_fprintf(stats_file_, "critical path: {}s, {} targets\n", last_target->finish_time - make_start_time, critical_path.size());
+  for (auto *target : critical_path) {
+    fmt_fprintf(stats_file_, "critical path target: {}s {}, started after {}s\n",
+                target->finish_time - target->start_time, target->get_name(), target->start_time - make_start_time);
+  }
+}
+
 int MakeRunner::signal_flag;
 
 void MakeRunner::sigint_handler(int sig __attribute__((unused))) {
@@ -185,6 +200,7 @@ bool MakeRunner::make_targets(std::vector<Target *> targets, int jobs_count) {
   ksignal(SIGINT, MakeRunner::sigint_handler);
   ksignal(SIGTERM, MakeRunner::sigint_handler);
 
+  const double make_start_time = dl_time();
   //TODO: check timeouts
   for (auto *target : targets) {
     // fprintf (stderr, "make target: %s\n", target->get_name().c_str());
@@ -268,11 +284,16 @@ bool MakeRunner::make_targets(std::vector<Target *> targets, int jobs_count) {
   for (auto *target : targets) {
     is_ready = is_ready && target->is_ready;
   }
+  if (stats_file_ && !fail_flag && is_ready) {
+    write_critical_path(targets, make_start_time);
+  }
   return !fail_flag && is_ready;
 }
 
-MakeRunner::MakeRunner(FILE *stats_file) noexcept:
-  stats_file_(stats_file) {
+MakeRunner::MakeRunner(FILE *stats_file, CompileTimes &compile_times, const std::string &cxx_launcher) :
+  stats_file_(stats_file),
+  compile_times_(compile_times),
+  compilation_launcher_(create_compilation_launcher(cxx_launcher)) {
 }
 
 MakeRunner::~MakeRunner() {
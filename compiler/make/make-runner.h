@@ -5,16 +5,29 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <queue>
 
 #include "common/mixin/not_copyable.h"
 
+#include "compiler/make/job-launcher.h"
+#include "compiler/make/make-stats.h"
 #include "compiler/make/target.h"
 
 class MakeRunner : private vk::not_copyable {
   class compare_by_priority {
   public:
+    // the targets without the previous compilation time go first, as they may be the longest ones,
+    // then the longest targets of the previous build
     bool operator()(Target *a, Target *b) const {
+      const bool a_is_known = a->expected_duration >= 0;
+      const bool b_is_known = b->expected_duration >= 0;
+      if (a_is_known != b_is_known) {
+        return a_is_known;
+      }
+      if (a->expected_duration != b->expected_duration) {
+        return a->expected_duration < b->expected_duration;
+      }
       return a->priority < b->priority;
     }
   };
@@ -23,6 +36,10 @@ private:
   int targets_left = 0;
   std::vector<Target *> all_targets;
   FILE *stats_file_{nullptr};
+  // the times of the previous builds are used for the scheduling, they are updated by the rebuilt targets
+  CompileTimes &compile_times_;
+  std::unique_ptr<JobLauncher> compilation_launcher_;
+  LocalJobLauncher local_launcher_;
 
   std::priority_queue<Target *, std::vector<Target *>, compare_by_priority> pending_jobs;
   std::map<int, Target *> jobs;
@@ -34,6 +51,7 @@ private:
   bool start_job(Target *target) __attribute__ ((warn_unused_result));
   bool finish_job(int pid, int return_code, int by_signal) __attribute__ ((warn_unused_result));
   void on_fail();
+  void write_critical_path(const std::vector<Target *> &targets, double make_start_time);
 
   void run_target(Target *target);
   void ready_target(Target *target);
@@ -44,6 +62,6 @@ private:
 public:
   void register_target(Target *target, std::vector<Target *> &&deps);
   bool make_targets(std::vector<Target *> target, int jobs_count = 32);
-  explicit MakeRunner(FILE *stats_file) noexcept;
+  MakeRunner(FILE *stats_file, CompileTimes &compile_times, const std::string &cxx_launcher);
   ~MakeRunner();
 };
@@ -0,0 +1,47 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/make/make-stats.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+
+#include "common/wrappers/fmt_format.h"
+
+#include "compiler/kphp_assert.h"
+
+CompileTimes read_compile_times(const std::string &compile_times_file) {
+  CompileTimes compile_times;
+  std::ifstream in{compile_times_file};
+  std::string line;
+  while (std::getline(in, line)) {
+    char *end = nullptr;
+    const double seconds = std::strtod(line.c_str(), &end);
+    if (end == line.c_str() || std::strncmp(end, "s ", 2) != 0) {
+      continue;
+    }
+    compile_times[std::string{end + 2}] = seconds;
+  }
+  return compile_times;
+}
+
+void write_compile_times(const std::string &compile_times_file, const CompileTimes &compile_times) {
+  const std::string tmp_file = compile_times_file + ".tmp";
+  FILE *out = fopen(tmp_file.c_str(), "w");
+  if (!out) {
+    kphp_warning(fmt_format("Can't write compile times file '{}': {}", tmp_file, strerror(errno)));
+    return;
+  }
+  for (const auto &target_and_time : compile_times) {
+    if (access(target_and_time.first.c_str(), F_OK) == 0) {
+      fmt_fprintf(out, "{}s {}\n", target_and_time.second, target_and_time.first);
+    }
+  }
+  fclose(out);
+  if (rename(tmp_file.c_str(), compile_times_file.c_str()) == -1) {
+    kphp_warning(fmt_format("Can't rename '{}' into '{}': {}", tmp_file, compile_times_file, strerror(errno)));
+  }
+}
@@ -0,0 +1,17 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+// the compilation times in seconds by the target paths
+using CompileTimes = std::unordered_map<std::string, double>;
+
+// The compile times file keeps the last known compilation time of each target of the build, a line "{seconds}s {target path}" per target:
+// make updates the times of the rebuilt targets only, so the times of the up to date targets are kept from the previous builds
+CompileTimes read_compile_times(const std::string &compile_times_file);
+// the targets, which files don't exist anymore, are dropped
+void write_compile_times(const std::string &compile_times_file, const CompileTimes &compile_times);
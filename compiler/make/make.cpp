@@ -5,6 +5,8 @@
 #include "compiler/make/make.h"
 
 #include <forward_list>
+#include <fstream>
+#include <iterator>
 #include <queue>
 #include <unordered_map>
 
@@ -17,6 +19,7 @@
 #include "compiler/make/file-target.h"
 #include "compiler/make/hardlink-or-copy.h"
 #include "compiler/make/make-runner.h"
+#include "compiler/make/make-stats.h"
 #include "compiler/make/objs-to-bin-target.h"
 #include "compiler/make/objs-to-obj-target.h"
 #include "compiler/make/objs-to-static-lib-target.h"
@@ -65,8 +68,8 @@ private:
   }
 
 public:
-  MakeSetup(FILE *stats_file, const CompilerSettings &compiler_settings) noexcept:
-    make(stats_file),
+  MakeSetup(FILE *stats_file, CompileTimes &compile_times, const CompilerSettings &compiler_settings) :
+    make(stats_file, compile_times, compiler_settings.cxx_launcher.get()),
     settings(compiler_settings) {
   }
 
@@ -197,8 +200,9 @@ bool finalize_precompiled_header(File &runtime_headers_h, File &runtime_header_p
   return true;
 }
 
-static bool kphp_make_precompiled_headers(Index *obj_dir, const CompilerSettings &settings, FILE *stats_file) {
-  MakeSetup make{stats_file, settings};
+static bool kphp_make_precompiled_headers(Index *obj_dir, const CompilerSettings &settings, FILE *stats_file,
+                                          CompileTimes &compile_times) {
+  MakeSetup make{stats_file, compile_times, settings};
   File sha256_version_file(settings.runtime_sha256_file.get());
   kphp_assert(sha256_version_file.read_stat() > 0);
 
@@ -284,20 +288,113 @@ static std::unordered_map<File *, long long> create_dep_mtime(const Index &cpp_d
   return dep_mtime;
 }
 
+static File *create_obj_file(MakeSetup *make, Index &obj_dir, File *cpp_file, long long dep_mtime) {
+  File *obj_file = obj_dir.insert_file(static_cast<std::string>(cpp_file->name_without_ext) + ".o");
+  obj_file->compile_with_debug_info_flag = cpp_file->compile_with_debug_info_flag;
+  make->create_cpp2obj_target(cpp_file, obj_file);
+  Target *cpp_target = cpp_file->target;
+  cpp_target->force_changed(dep_mtime);
+  return obj_file;
+}
+
+// the function sources are the only ones, which are placed into the subdirs and compiled with the debug info;
+// they have no file local definitions, so they can be compiled as a part of a bigger translation unit
+static bool is_unity_build_candidate(File *cpp_file, uint64_t unity_build_size) {
+  if (!unity_build_size || cpp_file->subdir.empty() || !cpp_file->compile_with_debug_info_flag) {
+    return false;
+  }
+  // the size isn't known for the files, which were not rewritten by the code generation
+  if (!cpp_file->file_size && cpp_file->read_stat() <= 0) {
+    return false;
+  }
+  return static_cast<uint64_t>(cpp_file->file_size) * 4 <= unity_build_size;
+}
+
+// Groups the small sources of one subdir into the unity build translation units of at most unity_build_size bytes.
+// A group is also closed after a source with the name hash divisible by sources_per_group:
+// adding, removing or resizing a function regroups only the sources between the neighbour boundaries,
+// all the other groups (and their objects) stay the same.
+static std::vector<std::vector<File *>> group_unity_build_sources(std::vector<File *> sources, uint64_t unity_build_size) {
+  constexpr size_t sources_per_group = 16;
+  std::sort(sources.begin(), sources.end(), [](File *a, File *b) { return a->name < b->name; });
+
+  std::vector<std::vector<File *>> groups(1);
+  uint64_t group_size = 0;
+  for (File *source : sources) {
+    const auto source_size = static_cast<uint64_t>(source->file_size);
+    if (!groups.back().empty() && group_size + source_size > unity_build_size) {
+      groups.emplace_back();
+      group_size = 0;
+    }
+    groups.back().push_back(source);
+    group_size += source_size;
+    if (vk::std_hash(source->name) % sources_per_group == 0) {
+      groups.emplace_back();
+      group_size = 0;
+    }
+  }
+  if (groups.back().empty()) {
+    groups.pop_back();
+  }
+  return groups;
+}
+
+// The unity build source includes the sources of the group, it is rewritten only if the group is changed,
+// and its compilation time is written into the stats file as the time of the group object
+static File *create_unity_build_obj_file(MakeSetup *make, Index &obj_dir, vk::string_view subdir, const std::vector<File *> &sources,
+                                         const std::unordered_map<File *, long long> &dep_mtime) {
+  size_t hash = 0;
+  // the precompiled header is used only if it is included first by the translation unit itself
+  std::string code = "#include \"runtime-headers.h\"\n";
+  long long max_dep_mtime = 0;
+  for (File *source : sources) {
+    vk::hash_combine(hash, vk::std_hash(source->name));
+    code.append("#include \"").append(source->path).append("\"\n");
+    max_dep_mtime = std::max(max_dep_mtime, dep_mtime.at(source));
+  }
+
+  File *unity_cpp = obj_dir.insert_file(fmt_format("{}_unity_{:x}.cpp", subdir, hash));
+  std::ifstream old_unity_cpp{unity_cpp->path};
+  const std::string old_code{std::istreambuf_iterator<char>{old_unity_cpp}, std::istreambuf_iterator<char>{}};
+  if (old_code != code) {
+    std::ofstream{unity_cpp->path} << code;
+  }
+  kphp_assert_msg(unity_cpp->read_stat() > 0, fmt_format("Can't write unity build source {}", unity_cpp->path));
+
+  make->create_cpp_target(unity_cpp);
+  return create_obj_file(make, obj_dir, unity_cpp, max_dep_mtime);
+}
+
 static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, const Index &cpp_dir,
                                             const std::forward_list<Index> &imported_headers) {
   std::unordered_map<File *, long long> dep_mtime = create_dep_mtime(cpp_dir, imported_headers);
+  const uint64_t unity_build_size = G->settings().unity_build_size.get();
+  std::map<vk::string_view, std::vector<File *>> unity_build_sources;
   std::vector<File *> objs;
   for (const auto &cpp_file : cpp_dir.get_files()) {
     if (cpp_file->ext == ".cpp") {
-      File *obj_file = obj_dir.insert_file(static_cast<std::string>(cpp_file->name_without_ext) + ".o");
-      obj_file->compile_with_debug_info_flag = cpp_file->compile_with_debug_info_flag;
-      make->create_cpp2obj_target(cpp_file, obj_file);
-      Target *cpp_target = cpp_file->target;
-      cpp_target->force_changed(dep_mtime[cpp_file]);
-      objs.push_back(obj_file);
+      if (is_unity_build_candidate(cpp_file, unity_build_size)) {
+        unity_build_sources[cpp_file->subdir].push_back(cpp_file);
+        continue;
+      }
+      objs.push_back(create_obj_file(make, obj_dir, cpp_file, dep_mtime[cpp_file]));
     }
   }
+
+  size_t unity_build_groups = 0;
+  for (auto &subdir_and_sources : unity_build_sources) {
+    for (const auto &group : group_unity_build_sources(std::move(subdir_and_sources.second), unity_build_size)) {
+      if (group.size() == 1) {
+        objs.push_back(create_obj_file(make, obj_dir, group.front(), dep_mtime[group.front()]));
+      } else {
+        objs.push_back(create_unity_build_obj_file(make, obj_dir, subdir_and_sources.first, group, dep_mtime));
+        ++unity_build_groups;
+      }
+    }
+  }
+  if (unity_build_size) {
+    fmt_fprintf(stderr, "unity build groups cnt = {}\n", unity_build_groups);
+  }
   fmt_fprintf(stderr, "objs cnt = {}\n", objs.size());
 
   std::map<vk::string_view, vector<File *>> subdirs;
@@ -334,8 +431,8 @@ static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, con
 
 static bool kphp_make(File &bin, Index &obj_dir, const Index &cpp_dir, std::forward_list<File> imported_libs,
                       const std::forward_list<Index> &imported_headers, const CompilerSettings &settings,
-                      FILE *stats_file) {
-  MakeSetup make{stats_file, settings};
+                      FILE *stats_file, CompileTimes &compile_times) {
+  MakeSetup make{stats_file, compile_times, settings};
   std::vector<File *> lib_objs;
   for (File &link_file: imported_libs) {
     make.create_cpp_target(&link_file);
@@ -349,8 +446,8 @@ static bool kphp_make(File &bin, Index &obj_dir, const Index &cpp_dir, std::forw
 
 static bool kphp_make_static_lib(File &static_lib, Index &obj_dir, const Index &cpp_dir,
                                  const std::forward_list<Index> &imported_headers, const CompilerSettings &settings,
-                                 FILE *stats_file) {
-  MakeSetup make{stats_file, settings};
+                                 FILE *stats_file, CompileTimes &compile_times) {
+  MakeSetup make{stats_file, compile_times, settings};
   std::vector<File *> objs = create_obj_files(&make, obj_dir, cpp_dir, imported_headers);
   make.create_objs2static_lib_target(objs, &static_lib);
   return make.make_target(&static_lib, static_cast<int32_t>(settings.jobs_count.get()));
@@ -369,6 +466,8 @@ static std::forward_list<Index> collect_imported_headers() {
 
 void run_make() {
   const auto &settings = G->settings();
+  // the jobs are scheduled by the compilation times of the previous builds
+  CompileTimes compile_times = read_compile_times(settings.compile_times_file.get());
   FILE *make_stats_file = nullptr;
   if (!settings.stats_file.get().empty()) {
     make_stats_file = fopen(settings.stats_file.get().c_str(), "w");
@@ -394,21 +493,27 @@ void run_make() {
   bool ok = true;
   const bool pch_allowed = !settings.no_pch.get();
   if (pch_allowed) {
-    kphp_error (kphp_make_precompiled_headers(&obj_index, settings, make_stats_file), "Make precompiled header failed");
+    kphp_error (kphp_make_precompiled_headers(&obj_index, settings, make_stats_file, compile_times), "Make precompiled header failed");
   }
   if (ok) {
     auto lib_header_dirs = collect_imported_headers();
     ok = settings.is_static_lib_mode()
-         ? kphp_make_static_lib(bin_file, obj_index, G->get_index(), lib_header_dirs, settings, make_stats_file)
-         : kphp_make(bin_file, obj_index, G->get_index(), collect_imported_libs(), lib_header_dirs, settings, make_stats_file);
+         ? kphp_make_static_lib(bin_file, obj_index, G->get_index(), lib_header_dirs, settings, make_stats_file, compile_times)
+         : kphp_make(bin_file, obj_index, G->get_index(), collect_imported_libs(), lib_header_dirs, settings, make_stats_file,
+                     compile_times);
     kphp_error (ok, "Make failed");
   }
 
   if (make_stats_file) {
     fclose(make_stats_file);
   }
+  // the times of the rebuilt targets are kept even if make failed
+  if (stage::has_global_error()) {
+    write_compile_times(settings.compile_times_file.get(), compile_times);
+  }
   stage::die_if_global_errors();
   obj_index.del_extra_files();
+  write_compile_times(settings.compile_times_file.get(), compile_times);
 
   if (bin_file.read_stat() > 0) {
     G->stats.object_out_size = bin_file.file_size;
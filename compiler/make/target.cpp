@@ -27,6 +27,10 @@ void Target::compute_priority() {
   priority = 0;
 }
 
+bool Target::is_compilation() const {
+  return false;
+}
+
 bool Target::require() {
   if (is_required) {
     return false;
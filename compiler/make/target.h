@@ -34,11 +34,17 @@ protected:
   const CompilerSettings *settings{nullptr};
 public:
   long long priority;
+  // the compilation time of the previous build, -1 if unknown
+  double expected_duration = -1;
   double start_time;
+  // is set only for the targets built by this make
+  double finish_time = 0;
   Target() = default;
   virtual ~Target() = default;
 
   virtual void compute_priority();
+  // the compilations are started by the --cxx-launcher, the other jobs are always run locally
+  virtual bool is_compilation() const;
   virtual std::string get_cmd() = 0;
   std::string get_name();
 
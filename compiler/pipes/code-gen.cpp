@@ -4,6 +4,11 @@
 
 #include "compiler/pipes/code-gen.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "common/algorithms/clamp.h"
+
 #include "compiler/cpp-dest-dir-initializer.h"
 #include "compiler/code-gen/code-gen-task.h"
 #include "compiler/code-gen/code-generator.h"
@@ -26,10 +31,83 @@
 #include "compiler/data/src-file.h"
 #include "compiler/function-pass.h"
 #include "compiler/inferring/public.h"
+#include "compiler/make/make-stats.h"
 #include "compiler/pipes/collect-forkable-types.h"
 
+// the size of the function tree, the size of the generated code is roughly proportional to it
+static size_t estimate_generated_code_size(VertexPtr root) {
+  size_t size = 1;
+  for (auto child : *root) {
+    size += estimate_generated_code_size(child);
+  }
+  return size;
+}
+
+// 'vars12.o', the objects of the other vars files ('vars.o', 'vars_reset.*.o') don't depend on the split count
+static bool is_vars_part_obj(vk::string_view obj_name) {
+  if (!obj_name.starts_with("vars") || !obj_name.ends_with(".o")) {
+    return false;
+  }
+  const vk::string_view part = obj_name.substr(4, obj_name.size() - 6);
+  return !part.empty() && std::all_of(part.begin(), part.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+// Chooses the count of the vars files, so that compiling one of them takes about as long as the median function object.
+// The times are taken from the compile times file, which keeps the last known time of each target,
+// so the choice doesn't depend on what was rebuilt by the previous build.
+// Changing the count recompiles all the vars files, so the count of the previous build is kept, unless it is off by more than twice.
+static size_t choose_count_of_vars_parts(size_t cnt_global_vars) {
+  const size_t default_parts = 1 + cnt_global_vars / 1024;
+  const size_t min_parts = 1 + cnt_global_vars / 16384;
+  // VarsCpp supports up to 1024 parts
+  const size_t max_parts = std::min(1 + cnt_global_vars / 64, size_t{1024});
+
+  const std::string &objs_dir = G->settings().dest_objs_dir.get();
+  std::vector<double> function_obj_times;
+  double vars_total_time = 0;
+  size_t previous_parts = 0;
+  for (const auto &target_and_time : read_compile_times(G->settings().compile_times_file.get())) {
+    vk::string_view target{target_and_time.first};
+    if (!target.starts_with(objs_dir) || !target.ends_with(".o")) {
+      continue;
+    }
+    target.remove_prefix(objs_dir.size());
+    const size_t name_pos = target.rfind('/');
+    // the partial links and the objects of the common sources are placed into the root of the objs dir
+    if (name_pos == vk::string_view::npos) {
+      continue;
+    }
+    const vk::string_view obj_name = target.substr(name_pos + 1);
+    if (is_vars_part_obj(obj_name)) {
+      vars_total_time += target_and_time.second;
+      ++previous_parts;
+    } else if (!obj_name.starts_with("vars") && !obj_name.starts_with("_unity_")) {
+      function_obj_times.emplace_back(target_and_time.second);
+    }
+  }
+  if (function_obj_times.empty() || vars_total_time <= 0) {
+    return previous_parts ? vk::clamp(previous_parts, min_parts, max_parts) : default_parts;
+  }
+
+  std::nth_element(function_obj_times.begin(), function_obj_times.begin() + function_obj_times.size() / 2, function_obj_times.end());
+  const double median_time = std::max(function_obj_times[function_obj_times.size() / 2], 0.01);
+  const auto parts = vk::clamp(static_cast<size_t>(std::ceil(vars_total_time / median_time)), min_parts, max_parts);
+  if (previous_parts && parts <= 2 * previous_parts && 2 * parts >= previous_parts) {
+    return vk::clamp(previous_parts, min_parts, max_parts);
+  }
+  return parts;
+}
+
 size_t CodeGenF::calc_count_of_parts(size_t cnt_global_vars) {
-  return 1u + cnt_global_vars / G->settings().globals_split_count.get();
+  const size_t split_count = G->settings().globals_split_count.get();
+  if (split_count == 0) {
+    const size_t parts = choose_count_of_vars_parts(cnt_global_vars);
+    if (G->settings().verbosity.get() >= 1) {
+      fmt_fprintf(stderr, "Count of vars files is chosen to be {}\n", parts);
+    }
+    return parts;
+  }
+  return 1u + cnt_global_vars / split_count;
 }
 
 void CodeGenF::on_finish(DataStream<WriterData> &os) {
@@ -69,6 +147,7 @@ void CodeGenF::on_finish(DataStream<WriterData> &os) {
 
   vector<FunctionPtr> all_functions;
   vector<FunctionPtr> exported_functions;
+  vector<std::pair<size_t, FunctionPtr>> functions_by_size;
 
   for (const auto &function : xall) {
     if (!should_gen_function(function)) {
@@ -78,14 +157,22 @@ void CodeGenF::on_finish(DataStream<WriterData> &os) {
       continue;
     }
     all_functions.push_back(function);
-    W << Async(FunctionH(function));
-    W << Async(FunctionCpp(function));
+    functions_by_size.emplace_back(estimate_generated_code_size(function->root), function);
 
     if (function->kphp_lib_export && G->settings().is_static_lib_mode()) {
       exported_functions.emplace_back(function);
     }
   }
 
+  // the code generation tasks are taken by the threads in order, the biggest functions go first,
+  // so that the threads are not left waiting for a few huge functions at the end
+  std::stable_sort(functions_by_size.begin(), functions_by_size.end(),
+                   [](const std::pair<size_t, FunctionPtr> &a, const std::pair<size_t, FunctionPtr> &b) { return a.first > b.first; });
+  for (const auto &size_and_function : functions_by_size) {
+    W << Async(FunctionH(size_and_function.second));
+    W << Async(FunctionCpp(size_and_function.second));
+  }
+
   for (const auto &c : all_classes) {
     if (!ClassData::does_need_codegen(c)) {
       continue;
@@ -143,7 +230,8 @@ void CodeGenF::prepare_generate_function(FunctionPtr func) {
   std::replace(file_name.begin(), file_name.end(), '$', '@');
 
   func->header_name = file_name + ".h";
-  func->subdir = get_subdir(func->file_id->short_file_name);
+  // hot functions are grouped together
+  func->subdir = func->is_hot ? "o_hot" : get_subdir(func->file_id->short_file_name);
 
   if (!func->is_inline) {
     func->src_name = file_name + ".cpp";
@@ -250,6 +250,18 @@ void FilterOnlyActuallyUsedFunctionsF::on_finish(DataStream<FunctionPtr> &os) {
   remove_unused_class_methods(all, used_functions);
   stage::die_if_global_errors();
 
+  // mark the hot and cold functions, if the profiler dumps were passed
+  const auto &profile_guided_hints = G->get_profile_guided_hints();
+  if (!profile_guided_hints.empty()) {
+    for (const auto &f : used_functions) {
+      if (f) {
+        const auto hotness = profile_guided_hints.get_hotness(f);
+        f->is_hot = hotness == ProfileGuidedHints::Hotness::hot;
+        f->is_cold = hotness == ProfileGuidedHints::Hotness::cold;
+      }
+    }
+  }
+
   // forward the reachable functions into the data stream;
   // this should be the last step
   for (const auto &f : used_functions) {
@@ -9,7 +9,8 @@
 #include "compiler/inferring/public.h"
 
 void InlineSimpleFunctions::on_simple_operation() noexcept {
-  if (++n_simple_operations_ > 6) {
+  // hot functions are allowed to be a bit bigger
+  if (++n_simple_operations_ > (current_function->is_hot ? 12 : 6)) {
     inline_is_possible_ = false;
   }
 }
@@ -90,6 +91,7 @@ bool InlineSimpleFunctions::user_recursion(VertexPtr) {
 bool InlineSimpleFunctions::check_function(FunctionPtr function) const {
   return !function->is_resumable &&
          !function->is_inline &&
+         !function->is_cold &&
          !function->can_throw() &&
          !function->has_variadic_param &&
          !function->is_main_function() &&
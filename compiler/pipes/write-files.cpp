@@ -9,54 +9,44 @@
 #include "compiler/compiler-core.h"
 #include "compiler/stage.h"
 
-void WriteFilesF::execute(WriterData data, EmptyStream &) {
-  stage::set_name("Write files");
-
-  std::string full_file_name = G->cpp_dir;
-  if (!data.subdir.empty()) {
-    full_file_name += data.subdir;
-    full_file_name += "/";
-  }
-  full_file_name += data.file_name;
-
-  File *file = G->get_file_info(std::move(full_file_name));
-  file->needed = true;
-  file->includes = data.flush_includes();
-  file->lib_includes = data.flush_lib_includes();
-
-  file->compile_with_debug_info_flag = data.compile_with_debug_info();
+static unsigned long long calc_code_crc(const std::string &code) {
+  unsigned long long crc = compute_crc64(code.c_str(), code.length());
+  // -1 means unknown crc for the files
+  return crc == static_cast<unsigned long long>(-1) ? 463721894672819432ull : crc;
+}
 
-  if (file->on_disk && data.compile_with_crc()) {
-    if (file->crc64 == (unsigned long long)-1) {
-      FILE *old_file = fopen(file->path.c_str(), "r");
-      kphp_assert_msg (old_file != nullptr,
-                  fmt_format("Failed to open [{}] : {}", file->path, strerror(errno)));
-      unsigned long long old_crc = 0;
-      unsigned long long old_crc_with_comments = static_cast<unsigned long long>(-1);
-
-      if (fscanf(old_file, "//crc64:%llx", &old_crc) != 1) {
-        kphp_warning (fmt_format("can't read crc64 from [{}]\n", file->path));
-        old_crc = static_cast<unsigned long long>(-1);
-      } else {
-        if (fscanf(old_file, " //crc64_with_comments:%llx", &old_crc_with_comments) != 1) {
-          old_crc_with_comments = static_cast<unsigned long long>(-1);
-        }
+static void read_crc_from_disk(File *file) {
+  if (file->crc64 == (unsigned long long)-1) {
+    FILE *old_file = fopen(file->path.c_str(), "r");
+    kphp_assert_msg (old_file != nullptr,
+                fmt_format("Failed to open [{}] : {}", file->path, strerror(errno)));
+    unsigned long long old_crc = 0;
+    unsigned long long old_crc_with_comments = static_cast<unsigned long long>(-1);
+
+    if (fscanf(old_file, "//crc64:%llx", &old_crc) != 1) {
+      kphp_warning (fmt_format("can't read crc64 from [{}]\n", file->path));
+      old_crc = static_cast<unsigned long long>(-1);
+    } else {
+      if (fscanf(old_file, " //crc64_with_comments:%llx", &old_crc_with_comments) != 1) {
+        old_crc_with_comments = static_cast<unsigned long long>(-1);
       }
-      fclose(old_file);
-
-      file->crc64 = old_crc;
-      file->crc64_with_comments = old_crc_with_comments;
     }
+    fclose(old_file);
+
+    file->crc64 = old_crc;
+    file->crc64_with_comments = old_crc_with_comments;
+  }
+}
+
+static void write_file(File *file, const std::string &code_str, unsigned long long crc, unsigned long long crc_with_comments, bool compile_with_crc) {
+  if (file->on_disk && compile_with_crc) {
+    read_crc_from_disk(file);
   }
 
   bool need_del = false;
   bool need_fix = false;
   bool need_save_time = false;
-  const unsigned long long crc = data.calc_crc();
-  string code_str;
-  data.dump(code_str);
-  const unsigned long long crc_with_comments = compute_crc64(code_str.c_str(), code_str.length());
-  if (file->on_disk && data.compile_with_crc()) {
+  if (file->on_disk && compile_with_crc) {
     if (file->crc64 != crc) {
       need_fix = true;
       need_del = true;
@@ -86,7 +76,7 @@ void WriteFilesF::execute(WriterData data, EmptyStream &) {
     kphp_assert_msg(dest_file != nullptr,
                 fmt_format("Failed to open [{}] for write : {}\n", file->path, strerror(errno)));
 
-    if (data.compile_with_crc()) {
+    if (compile_with_crc) {
       kphp_assert(fprintf(dest_file, "//crc64:%016llx\n", ~crc) >= 0);
       kphp_assert(fprintf(dest_file, "//crc64_with_comments:%016llx\n", ~crc_with_comments) >= 0);
       kphp_assert(fprintf(dest_file, "%s", code_str.c_str()) >= 0);
@@ -116,3 +106,91 @@ void WriteFilesF::execute(WriterData data, EmptyStream &) {
     kphp_error(!need_save_time || file->mtime == mtime_before, "Failed to set previous mtime\n");
   }
 }
+
+static std::string get_shared_header_name(unsigned long long crc_with_comments) {
+  return fmt_format("o_shared/{:016x}.h", crc_with_comments);
+}
+
+static std::string get_shared_header_include(const std::string &shared_header_name) {
+  return "#pragma once\n#include \"" + shared_header_name + "\"\n";
+}
+
+static void write_shared_header_include(File *header, const std::string &shared_header_name) {
+  const std::string code = get_shared_header_include(shared_header_name);
+  const unsigned long long crc = calc_code_crc(code);
+  header->includes = {shared_header_name};
+  header->lib_includes.clear();
+  write_file(header, code, crc, crc, true);
+}
+
+// the header was deduplicated by the previous build, so it's kept including the shared header:
+// otherwise it would be rewritten back and forth, when the identical headers are generated after it
+static bool is_shared_header_include(File *header, unsigned long long crc_with_comments) {
+  if (!header->on_disk) {
+    return false;
+  }
+  read_crc_from_disk(header);
+  return header->crc64 == calc_code_crc(get_shared_header_include(get_shared_header_name(crc_with_comments)));
+}
+
+// the shared header gets a name by its content, so the same headers are deduplicated the same way
+// regardless of the order they are generated in, and they aren't rewritten by the next builds
+void WriteFilesF::write_header(File *file, WriterData &data) {
+  const unsigned long long crc_with_comments = data.get_crc_with_comments();
+  HeadersGroup &group = headers_by_crc_[crc_with_comments];
+  if (!group.first_header) {
+    group.first_header = file;
+    if (!is_shared_header_include(file, crc_with_comments)) {
+      write_file(file, data.get_code_with_comments(), data.calc_crc(), crc_with_comments, true);
+      return;
+    }
+  }
+
+  const std::string shared_header_name = get_shared_header_name(crc_with_comments);
+  if (!group.shared_header_written) {
+    File *shared_header = G->get_file_info(G->cpp_dir + shared_header_name);
+    shared_header->needed = true;
+    shared_header->includes = file->includes;
+    shared_header->lib_includes = file->lib_includes;
+    write_file(shared_header, data.get_code_with_comments(), data.calc_crc(), crc_with_comments, true);
+    group.shared_header_written = true;
+    // the first header of the group was written with the content, as it was unique at that moment
+    if (group.first_header != file) {
+      write_shared_header_include(group.first_header, shared_header_name);
+      deduplicated_headers_++;
+    }
+  }
+  write_shared_header_include(file, shared_header_name);
+  deduplicated_headers_++;
+}
+
+void WriteFilesF::execute(WriterData data, EmptyStream &) {
+  stage::set_name("Write files");
+
+  std::string full_file_name = G->cpp_dir;
+  if (!data.subdir.empty()) {
+    full_file_name += data.subdir;
+    full_file_name += "/";
+  }
+  full_file_name += data.file_name;
+
+  File *file = G->get_file_info(std::move(full_file_name));
+  file->needed = true;
+  file->includes = data.flush_includes();
+  file->lib_includes = data.flush_lib_includes();
+
+  file->compile_with_debug_info_flag = data.compile_with_debug_info();
+
+  if (!data.subdir.empty() && file->ext == ".h" && data.compile_with_crc()) {
+    write_header(file, data);
+    return;
+  }
+  write_file(file, data.get_code_with_comments(), data.calc_crc(), data.get_crc_with_comments(), data.compile_with_crc());
+}
+
+void WriteFilesF::on_finish(EmptyStream &) {
+  headers_by_crc_.clear();
+  if (G->settings().verbosity.get() >= 1) {
+    fmt_fprintf(stderr, "Deduplicated headers: {}\n", deduplicated_headers_);
+  }
+}
@@ -4,10 +4,27 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "compiler/code-gen/writer-data.h"
 #include "compiler/threading/data-stream.h"
 
+class File;
+
 class WriteFilesF {
+  struct HeadersGroup {
+    File *first_header{nullptr};
+    bool shared_header_written{false};
+  };
+
+  // the function and class headers by the crc of their content: a unique header is written right away,
+  // the identical ones are written once into o_shared/, and the headers themselves just include it
+  std::unordered_map<unsigned long long, HeadersGroup> headers_by_crc_;
+  size_t deduplicated_headers_{0};
+
+  void write_header(File *file, WriterData &data);
+
 public:
   void execute(WriterData data, EmptyStream &);
+  void on_finish(EmptyStream &);
 };
@@ -0,0 +1,111 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/profile-guided-hints.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <tuple>
+
+#include "common/wrappers/fmt_format.h"
+
+#include "compiler/data/function-data.h"
+#include "compiler/stage.h"
+
+namespace {
+
+// the order of events in the profiler dump: the line number is followed by the total_allocations ... net_ns values
+constexpr size_t cpu_ns_event_index = 14;
+
+std::string strip_function_label(const std::string &function_name) {
+  // labeled functions are dumped as 'function_name (label)'
+  const auto label_pos = function_name.find(" (");
+  return label_pos == std::string::npos ? function_name : function_name.substr(0, label_pos);
+}
+
+bool parse_costs_line(const std::string &line, std::vector<uint64_t> &costs) {
+  costs.clear();
+  std::istringstream line_stream{line};
+  uint64_t value = 0;
+  // skip the function line
+  if (!(line_stream >> value)) {
+    return false;
+  }
+  while (line_stream >> value) {
+    costs.emplace_back(value);
+  }
+  return costs.size() > cpu_ns_event_index;
+}
+
+} // namespace
+
+void ProfileGuidedHints::load_dump(const std::string &profiler_dump, std::unordered_map<std::string, FunctionProfile> &profiles) {
+  std::ifstream dump{profiler_dump};
+  kphp_error_return(dump.is_open(), fmt_format("Can't open profiler dump '{}'", profiler_dump));
+
+  FunctionProfile *current_function = nullptr;
+  std::string callee_name;
+  bool self_costs_expected = false;
+  std::vector<uint64_t> costs;
+  for (std::string line; std::getline(dump, line);) {
+    if (line.compare(0, 3, "fn=") == 0) {
+      current_function = &profiles[strip_function_label(line.substr(3))];
+      self_costs_expected = true;
+    } else if (line.compare(0, 4, "cfn=") == 0) {
+      callee_name = strip_function_label(line.substr(4));
+    } else if (line.compare(0, 6, "calls=") == 0) {
+      if (!callee_name.empty()) {
+        profiles[callee_name].calls += std::strtoull(line.c_str() + 6, nullptr, 10);
+      }
+    } else if (self_costs_expected && current_function && parse_costs_line(line, costs)) {
+      current_function->self_cpu_ns += costs[cpu_ns_event_index];
+      self_costs_expected = false;
+    }
+  }
+}
+
+void ProfileGuidedHints::load_from(const std::vector<std::string> &profiler_dumps) {
+  std::unordered_map<std::string, FunctionProfile> profiles;
+  for (const auto &profiler_dump : profiler_dumps) {
+    load_dump(profiler_dump, profiles);
+  }
+
+  std::vector<std::pair<std::string, FunctionProfile>> sorted_profiles{profiles.begin(), profiles.end()};
+  std::sort(sorted_profiles.begin(), sorted_profiles.end(),
+            [](const auto &lhs, const auto &rhs) {
+              return std::tie(rhs.second.self_cpu_ns, rhs.second.calls) < std::tie(lhs.second.self_cpu_ns, lhs.second.calls);
+            });
+
+  uint64_t total_cpu_ns = 0;
+  for (const auto &function : sorted_profiles) {
+    total_cpu_ns += function.second.self_cpu_ns;
+  }
+  if (!total_cpu_ns) {
+    return;
+  }
+
+  uint64_t accumulated_cpu_ns = 0;
+  for (const auto &function : sorted_profiles) {
+    const double cpu_share_before = static_cast<double>(accumulated_cpu_ns) / static_cast<double>(total_cpu_ns);
+    accumulated_cpu_ns += function.second.self_cpu_ns;
+    if (cpu_share_before < hot_cpu_share) {
+      functions_.emplace(function.first, Hotness::hot);
+    } else if (cpu_share_before >= cold_cpu_share) {
+      functions_.emplace(function.first, Hotness::cold);
+    }
+  }
+}
+
+ProfileGuidedHints::Hotness ProfileGuidedHints::get_hotness(FunctionPtr function) const {
+  if (functions_.empty()) {
+    return Hotness::unknown;
+  }
+  return get_hotness(function->get_human_readable_name(false));
+}
+
+ProfileGuidedHints::Hotness ProfileGuidedHints::get_hotness(const std::string &function_name) const {
+  auto it = functions_.find(function_name);
+  return it == functions_.end() ? Hotness::unknown : it->second;
+}
@@ -0,0 +1,45 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "compiler/data/data_ptr.h"
+
+// Hot/cold hints for the generated functions, collected from the tracing profiler dumps (callgrind format, see runtime/profiler.cpp).
+// Functions are ordered by their self cpu time: the hottest ones that cover hot_cpu_share of the whole profiled time are hot,
+// the tail which exceeds cold_cpu_share of the profiled time is cold, others are kept as is.
+class ProfileGuidedHints {
+public:
+  enum class Hotness : uint8_t {
+    unknown,
+    hot,
+    cold
+  };
+
+  void load_from(const std::vector<std::string> &profiler_dumps);
+
+  Hotness get_hotness(FunctionPtr function) const;
+  Hotness get_hotness(const std::string &function_name) const;
+
+  bool empty() const {
+    return functions_.empty();
+  }
+
+  static constexpr double hot_cpu_share = 0.9;
+  static constexpr double cold_cpu_share = 0.999;
+
+private:
+  struct FunctionProfile {
+    uint64_t self_cpu_ns{0};
+    uint64_t calls{0};
+  };
+
+  void load_dump(const std::string &profiler_dump, std::unordered_map<std::string, FunctionProfile> &profiles);
+
+  std::unordered_map<std::string, Hotness> functions_;
+};
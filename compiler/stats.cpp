@@ -57,6 +57,14 @@ void Stats::update_memory_stats() {
   memory_rss_peak_ = mem_info.rss_peak;
 }
 
+void Stats::on_type_inference_finished(double inference_time) {
+  mem_info_t mem_info;
+  get_mem_stats(getpid(), &mem_info);
+
+  memory_rss_peak_after_type_inference_ = mem_info.rss_peak;
+  type_inference_time = inference_time;
+}
+
 void Stats::write_to(std::ostream &out, bool with_indent) const {
   const char *indent = with_indent ? "  " : "";
   const char *block_sep = with_indent ? "\n" : "";
@@ -75,6 +83,8 @@ void Stats::write_to(std::ostream &out, bool with_indent) const {
   out << indent << "types.local_mixed: " << cnt_mixed_vars << std::endl;
   out << indent << "types.params_mixed: " << cnt_mixed_params << std::endl;
   out << indent << "types.const_params_mixed: " << cnt_const_mixed_params << std::endl;
+  out << indent << "types.interned: " << cnt_interned_types << std::endl;
+  out << indent << "types.interned_reused: " << cnt_interned_types_reused << std::endl;
   out << block_sep;
   out << indent << "functions.total: " << total_functions_ << std::endl;
   out << indent << "functions.total_inline: " << total_inline_functions_ << std::endl;
@@ -83,8 +93,10 @@ void Stats::write_to(std::ostream &out, bool with_indent) const {
   out << block_sep;
   out << indent << "memory.rss: " << memory_rss_ * 1024 << std::endl;
   out << indent << "memory.rss_peak: " << memory_rss_peak_ * 1024 << std::endl;
+  out << indent << "memory.rss_peak_after_type_inference: " << memory_rss_peak_after_type_inference_ * 1024 << std::endl;
   out << block_sep;
   out << indent << "compilation.transpilation_time: " << transpilation_time << std::endl;
+  out << indent << "compilation.type_inference_time: " << type_inference_time << std::endl;
   out << indent << "compilation.total_time: " << total_time << std::endl;
   out << indent << "compilation.object_out_size: " << object_out_size << std::endl;
   out << block_sep;
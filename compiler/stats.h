@@ -16,6 +16,7 @@ public:
   void on_function_processed(FunctionPtr function);
 
   void update_memory_stats();
+  void on_type_inference_finished(double inference_time);
 
   void write_to(std::ostream &out, bool with_indent = true) const;
 
@@ -25,9 +26,12 @@ public:
   std::atomic<std::uint64_t> cnt_mixed_vars{0u};
   std::atomic<std::uint64_t> cnt_const_mixed_params{0u};
   std::atomic<std::uint64_t> cnt_make_clone{0u};
+  std::atomic<std::uint64_t> cnt_interned_types{0u};
+  std::atomic<std::uint64_t> cnt_interned_types_reused{0u};
 
   std::atomic<std::uint64_t> object_out_size{0u};
   std::atomic<double> transpilation_time{0.0};
+  std::atomic<double> type_inference_time{0.0};
   std::atomic<double> total_time{0.0};
 
   std::unordered_map<std::string, ProfilerRaw> profiler_stats;
@@ -47,6 +51,7 @@ private:
 
   std::atomic<std::uint64_t> memory_rss_{0};
   std::atomic<std::uint64_t> memory_rss_peak_{0};
+  std::atomic<std::uint64_t> memory_rss_peak_after_type_inference_{0};
 };
 
 
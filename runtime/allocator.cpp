@@ -62,6 +62,10 @@ size_t get_heap_memory_used() noexcept {
   return get_memory_dealer().get_heap_resource().memory_used();
 }
 
+const memory_resource::MemoryStats &get_global_init_memory_stats() noexcept {
+  return get_memory_dealer().get_global_init_resource().get_memory_stats();
+}
+
 void global_init_script_allocator() noexcept {
   auto &dealer = get_memory_dealer();
   php_assert(dealer.heap_script_resource_replacer());
@@ -95,6 +99,13 @@ void free_script_allocator() noexcept {
   script_allocator_enabled = false;
 }
 
+void set_script_allocation_sampler(memory_resource::allocation_sampler sampler, size_t sampling_period) noexcept {
+  auto &dealer = get_memory_dealer();
+  php_assert(dealer.is_default_allocator_used());
+
+  dealer.current_script_resource().set_allocation_sampler(sampler, sampling_period);
+}
+
 void *allocate(size_t size) noexcept {
   php_assert(size);
   auto &dealer = get_memory_dealer();
@@ -13,6 +13,7 @@
 
 namespace memory_resource {
 class unsynchronized_pool_resource;
+using allocation_sampler = void (*)(size_t sampled_bytes);
 }
 
 namespace dl {
@@ -26,10 +27,12 @@ void restore_default_script_allocator(bool force_disable) noexcept;
 
 const memory_resource::MemoryStats &get_script_memory_stats() noexcept;
 size_t get_heap_memory_used() noexcept;
+const memory_resource::MemoryStats &get_global_init_memory_stats() noexcept;
 
 void global_init_script_allocator() noexcept;
 void init_script_allocator(void *buffer, size_t buffer_size) noexcept; // init script allocator with arena of n bytes at buf
 void free_script_allocator() noexcept;
+void set_script_allocation_sampler(memory_resource::allocation_sampler sampler, size_t sampling_period) noexcept; // nullptr disables sampling
 
 void *allocate(size_t n) noexcept; // allocate script memory
 void *allocate0(size_t n) noexcept; // allocate zeroed script memory
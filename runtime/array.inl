@@ -475,6 +475,42 @@ void array<T>::array_inner::unset_map_value(int64_t int_key) {
   }
 }
 
+template<class T>
+void array<T>::array_inner::relocate_map_entry(string_hash_entry *entry, bool is_string_entry) noexcept {
+  list_hash_entry *new_entry = nullptr;
+  if (is_string_entry) {
+    string_hash_entry *string_entries = get_string_entries();
+    uint32_t bucket = choose_bucket_string(entry->int_key);
+    while (string_entries[bucket].next != EMPTY_POINTER) {
+      if (unlikely (++bucket == string_buf_size)) {
+        bucket = 0;
+      }
+    }
+    new_entry = string_entries + bucket;
+    memcpy(new_entry, entry, sizeof(string_hash_entry));
+    string_size++;
+  } else {
+    uint32_t bucket = choose_bucket_int(entry->int_key);
+    while (int_entries[bucket].next != EMPTY_POINTER) {
+      if (unlikely (++bucket == int_buf_size)) {
+        bucket = 0;
+      }
+    }
+    new_entry = int_entries + bucket;
+    memcpy(new_entry, entry, sizeof(int_hash_entry));
+    int_size++;
+    if (entry->int_key > max_key) {
+      max_key = entry->int_key;
+    }
+  }
+
+  new_entry->prev = end()->prev;
+  get_entry(end()->prev)->next = get_pointer(new_entry);
+
+  new_entry->next = get_pointer(end());
+  end()->prev = get_pointer(new_entry);
+}
+
 template<class T>
 template<class S>
 auto &array<T>::array_inner::find_map_entry(S &self, int64_t int_key) noexcept {
@@ -720,20 +756,7 @@ void array<T>::mutate_if_map_needed_int() {
   if (p->int_size * 5 > 3 * p->int_buf_size) {
     int64_t new_int_size = max(int64_t{p->int_size * 2 + 1}, int64_t{p->string_size});
     int64_t new_string_size = max(int64_t{p->string_size}, int64_t{p->string_buf_size >> 1} - 1);
-    array_inner *new_array = array_inner::create(new_int_size, new_string_size, false);
-
-    for (string_hash_entry *it = p->begin(); it != p->end(); it = p->next(it)) {
-      if (p->is_string_hash_entry(it)) {
-        new_array->emplace_string_key_map_value(overwrite_element::YES,
-                                                it->int_key, std::move(it->string_key), std::move(it->value));
-      } else {
-        new_array->emplace_int_key_map_value(overwrite_element::YES,
-                                             it->int_key, std::move(it->value));
-      }
-    }
-
-    p->dispose();
-    p = new_array;
+    rehash_map(new_int_size, new_string_size);
   }
 }
 
@@ -747,21 +770,24 @@ void array<T>::mutate_if_map_needed_string() {
   if (p->string_size * 5 > 3 * p->string_buf_size) {
     int64_t new_int_size = max(int64_t{p->int_size}, int64_t{p->int_buf_size >> 1} - 1);
     int64_t new_string_size = max(int64_t{p->string_size * 2 + 1}, int64_t{p->int_size});
-    array_inner *new_array = array_inner::create(new_int_size, new_string_size, false);
+    rehash_map(new_int_size, new_string_size);
+  }
+}
 
-    for (string_hash_entry *it = p->begin(); it != p->end(); it = p->next(it)) {
-      if (p->is_string_hash_entry(it)) {
-        new_array->emplace_string_key_map_value(overwrite_element::YES,
-                                                it->int_key, std::move(it->string_key), std::move(it->value));
-      } else {
-        new_array->emplace_int_key_map_value(overwrite_element::YES,
-                                             it->int_key, std::move(it->value));
-      }
-    }
+template<class T>
+void array<T>::rehash_map(int64_t new_int_size, int64_t new_string_size) {
+  // not shared (ref_cnt == 0), so the entries can be relocated to the new table as is:
+  // the keys are unique, neither the keys comparison nor the values moving and destruction is needed
+  php_assert(p->ref_cnt == 0);
+  array_inner *new_array = array_inner::create(new_int_size, new_string_size, false);
 
-    p->dispose();
-    p = new_array;
+  for (string_hash_entry *it = p->begin(); it != p->end(); it = p->next(it)) {
+    new_array->relocate_map_entry(it, p->is_string_hash_entry(it));
   }
+
+  auto shifted_p = reinterpret_cast<char *>(p) - sizeof(array_inner_fields_for_map);
+  dl::deallocate(shifted_p, array_inner::sizeof_map(p->int_buf_size, p->string_buf_size));
+  p = new_array;
 }
 
 template<class T>
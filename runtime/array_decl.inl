@@ -169,6 +169,9 @@ private:
     inline void unset_vector_value();
     inline void unset_map_value(int64_t int_key);
 
+    // the key is known to be absent, so only an empty bucket is looked for; the entry is moved with memcpy, as on unset
+    inline void relocate_map_entry(string_hash_entry *entry, bool is_string_entry) noexcept;
+
     // to avoid the const_cast, declare these functions as static with a template self parameter (this)
     template<class S>
     static inline auto &find_map_entry(S &self, int64_t int_key) noexcept;
@@ -208,6 +211,7 @@ private:
   inline void mutate_if_map_needed_int();
   inline void mutate_if_map_needed_string();
   inline void mutate_to_map_if_vector_or_map_need_string();
+  inline void rehash_map(int64_t new_int_size, int64_t new_string_size);
 
   inline void convert_to_map();
 
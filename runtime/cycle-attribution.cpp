@@ -0,0 +1,38 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/cycle-attribution.h"
+
+bool CycleAttribution::enabled_ = false;
+
+const char *cycle_subsystem_name(CycleSubsystem subsystem) noexcept {
+  switch (subsystem) {
+    case CycleSubsystem::other:
+      return "other";
+    case CycleSubsystem::json:
+      return "json";
+    case CycleSubsystem::regexp:
+      return "regexp";
+    case CycleSubsystem::serialization:
+      return "serialization";
+    case CycleSubsystem::tl:
+      return "tl";
+    case CycleSubsystem::instance_cache:
+      return "instance_cache";
+    case CycleSubsystem::count:
+      break;
+  }
+  return "unknown";
+}
+
+void CycleAttribution::start_request() noexcept {
+  request_cycles_ = {};
+  current_ = CycleSubsystem::other;
+  last_switch_tsc_ = cycleclock_now();
+}
+
+void CycleAttribution::finish_request() noexcept {
+  // the scopes may be left unbalanced by the script termination
+  switch_to(CycleSubsystem::other);
+}
@@ -0,0 +1,93 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "common/cycleclock.h"
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+// The cheap attribution of the request cpu cycles to the major runtime subsystems:
+// the subsystem scopes switch the current subsystem, so the nested scopes are not counted twice,
+// the cycles of a nested scope are attributed to its subsystem only.
+// The script allocations have no scope: a pair of rdtsc costs more than an allocation itself,
+// their cycles go to the enclosing subsystem, and their number is taken from the script memory stats.
+enum class CycleSubsystem : uint8_t {
+  // the cycles outside the subsystems are not reported
+  other,
+  json,
+  regexp,
+  serialization,
+  tl,
+  instance_cache,
+  count
+};
+
+constexpr size_t CYCLE_SUBSYSTEMS_COUNT = static_cast<size_t>(CycleSubsystem::count);
+using CycleSubsystemsCounters = std::array<uint64_t, CYCLE_SUBSYSTEMS_COUNT>;
+
+const char *cycle_subsystem_name(CycleSubsystem subsystem) noexcept;
+
+class CycleAttribution : vk::not_copyable {
+public:
+  static void set_enabled(bool enabled) noexcept {
+    enabled_ = enabled;
+  }
+
+  static bool is_enabled() noexcept {
+    return enabled_;
+  }
+
+  void start_request() noexcept;
+  void finish_request() noexcept;
+
+  const CycleSubsystemsCounters &get_request_cycles() const noexcept {
+    return request_cycles_;
+  }
+
+  // charges the cycles since the last switch to the current subsystem and returns it
+  CycleSubsystem switch_to(CycleSubsystem subsystem) noexcept {
+    const uint64_t now = cycleclock_now();
+    request_cycles_[static_cast<size_t>(current_)] += now - last_switch_tsc_;
+    last_switch_tsc_ = now;
+    const CycleSubsystem prev = current_;
+    current_ = subsystem;
+    return prev;
+  }
+
+private:
+  CycleAttribution() = default;
+
+  friend vk::singleton<CycleAttribution>;
+
+  // a plain global, so the disabled scopes cost a load and a branch without the singleton guard check
+  static bool enabled_;
+  CycleSubsystem current_{CycleSubsystem::other};
+  uint64_t last_switch_tsc_{0};
+  CycleSubsystemsCounters request_cycles_{};
+};
+
+class CycleAttributionScope : vk::not_copyable {
+public:
+  explicit CycleAttributionScope(CycleSubsystem subsystem) noexcept {
+    if (CycleAttribution::is_enabled()) {
+      attribution_ = &vk::singleton<CycleAttribution>::get();
+      prev_ = attribution_->switch_to(subsystem);
+    }
+  }
+
+  ~CycleAttributionScope() noexcept {
+    if (attribution_) {
+      attribution_->switch_to(prev_);
+    }
+  }
+
+private:
+  CycleAttribution *attribution_{nullptr};
+  CycleSubsystem prev_{CycleSubsystem::other};
+};
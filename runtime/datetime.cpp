@@ -12,8 +12,6 @@
 #include "runtime/critical_section.h"
 #include "runtime/string_functions.h"
 
-extern long timezone;
-
 
 static const char *day_of_week_names_short[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
 static const char *day_of_week_names_full[] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
@@ -23,21 +21,73 @@ static const char *month_names_full[] = {"January", "February", "March", "April"
                                          "December"};
 static const int days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 
-static time_t gmmktime(struct tm *tm) {
-  char *tz = getenv("TZ");
-  setenv("TZ", "", 1);
-  tzset();
+// The only supported timezone is Etc/GMT-3 (see f$date_default_timezone_set), it has a fixed offset and no DST.
+// So the conversions below are done arithmetically, unlike libc localtime_r()/mktime() they don't take the libc timezone lock
+// and don't check the TZ environment variable on every call, gmmktime() doesn't need to switch the TZ back and forth.
+constexpr int32_t LOCAL_TIMEZONE_OFFSET = 3 * 3600;
+static char LOCAL_TIMEZONE_ABBREVIATION[] = "+03";
+static char UTC_TIMEZONE_ABBREVIATION[] = "GMT";
 
-  time_t result = mktime(tm);
+static int64_t floor_div(int64_t a, int64_t b) {
+  return a / b - (a % b < 0);
+}
 
-  if (tz) {
-    setenv("TZ", tz, 1);
-  } else {
-    unsetenv("TZ");
-  }
-  tzset();
+// days since 1970-01-01 of the proleptic Gregorian calendar date, month is in [1, 12]
+static int64_t days_from_civil(int64_t year, int64_t month, int64_t day) {
+  year -= month <= 2;
+  const int64_t era = floor_div(year, 400);
+  const int64_t year_of_era = year - era * 400;
+  const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
 
-  return result;
+// the same as gmtime_r()
+static void timestamp_to_utc_tm(int64_t timestamp, tm &t) {
+  const int64_t days = floor_div(timestamp, 86400);
+  const int64_t seconds = timestamp - days * 86400;
+
+  const int64_t shifted_days = days + 719468;
+  const int64_t era = floor_div(shifted_days, 146097);
+  const int64_t day_of_era = shifted_days - era * 146097;
+  const int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+  const int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  const int64_t mp = (5 * day_of_year + 2) / 153;
+  const int64_t day = day_of_year - (153 * mp + 2) / 5 + 1;
+  const int64_t month = mp < 10 ? mp + 3 : mp - 9;
+  const int64_t year = year_of_era + era * 400 + (month <= 2);
+
+  t.tm_sec = static_cast<int32_t>(seconds % 60);
+  t.tm_min = static_cast<int32_t>(seconds / 60 % 60);
+  t.tm_hour = static_cast<int32_t>(seconds / 3600);
+  t.tm_mday = static_cast<int32_t>(day);
+  t.tm_mon = static_cast<int32_t>(month - 1);
+  t.tm_year = static_cast<int32_t>(year - 1900);
+  t.tm_wday = static_cast<int32_t>(days + 4 - floor_div(days + 4, 7) * 7); // 1970-01-01 is Thursday
+  t.tm_yday = static_cast<int32_t>(days - days_from_civil(year, 1, 1));
+  t.tm_isdst = 0;
+  t.tm_gmtoff = 0;
+  t.tm_zone = UTC_TIMEZONE_ABBREVIATION;
+}
+
+// the same as localtime_r() in the local timezone
+static void timestamp_to_local_tm(int64_t timestamp, tm &t) {
+  timestamp_to_utc_tm(timestamp + LOCAL_TIMEZONE_OFFSET, t);
+  t.tm_gmtoff = LOCAL_TIMEZONE_OFFSET;
+  t.tm_zone = LOCAL_TIMEZONE_ABBREVIATION;
+}
+
+// the same as timegm(), the fields out of their ranges are normalized as mktime() does, tm isn't modified
+static int64_t utc_tm_to_timestamp(const tm &t) {
+  const int64_t month = t.tm_mon;
+  const int64_t year = t.tm_year + int64_t{1900} + floor_div(month, 12);
+  const int64_t days = days_from_civil(year, month - floor_div(month, 12) * 12 + 1, 1) + t.tm_mday - 1;
+  return days * 86400 + t.tm_hour * int64_t{3600} + t.tm_min * int64_t{60} + t.tm_sec;
+}
+
+// the same as mktime() in the local timezone
+static int64_t local_tm_to_timestamp(const tm &t) {
+  return utc_tm_to_timestamp(t) - LOCAL_TIMEZONE_OFFSET;
 }
 
 static inline int32_t is_leap(int32_t year) {
@@ -365,8 +415,7 @@ string f$date(const string &format, int64_t timestamp) {
     timestamp = time(nullptr);
   }
   tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  timestamp_to_local_tm(timestamp, t);
 
   return date(format, t, timestamp, true);
 }
@@ -391,8 +440,7 @@ array<mixed> f$getdate(int64_t timestamp) {
     timestamp = time(nullptr);
   }
   tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  timestamp_to_local_tm(timestamp, t);
 
   array<mixed> result(array_size(1, 10, false));
 
@@ -416,16 +464,14 @@ string f$gmdate(const string &format, int64_t timestamp) {
     timestamp = time(nullptr);
   }
   tm t;
-  time_t timestamp_t = timestamp;
-  gmtime_r(&timestamp_t, &t);
+  timestamp_to_utc_tm(timestamp, t);
 
   return date(format, t, timestamp, false);
 }
 
 int64_t f$gmmktime(int64_t h, int64_t m, int64_t s, int64_t month, int64_t day, int64_t year) {
   tm t;
-  time_t timestamp_t = time(nullptr);
-  gmtime_r(&timestamp_t, &t);
+  timestamp_to_utc_tm(time(nullptr), t);
 
   if (h != std::numeric_limits<int64_t>::min()) {
     t.tm_hour = static_cast<int32_t>(h);
@@ -436,7 +482,7 @@ int64_t f$gmmktime(int64_t h, int64_t m, int64_t s, int64_t month, int64_t day,
   }
 
   if (s != std::numeric_limits<int64_t>::min()) {
-    t.tm_sec = static_cast<int32_t>(s - timezone);
+    t.tm_sec = static_cast<int32_t>(s + LOCAL_TIMEZONE_OFFSET);
   }
 
   if (month != std::numeric_limits<int64_t>::min()) {
@@ -452,7 +498,7 @@ int64_t f$gmmktime(int64_t h, int64_t m, int64_t s, int64_t month, int64_t day,
   }
 
   t.tm_isdst = -1;
-  return gmmktime(&t) - 3 * 3600;
+  return utc_tm_to_timestamp(t) - LOCAL_TIMEZONE_OFFSET;
 }
 
 array<mixed> f$localtime(int64_t timestamp, bool is_associative) {
@@ -460,8 +506,7 @@ array<mixed> f$localtime(int64_t timestamp, bool is_associative) {
     timestamp = time(nullptr);
   }
   tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  timestamp_to_local_tm(timestamp, t);
 
   if (!is_associative) {
     return array<mixed>::create(t.tm_sec, t.tm_min, t.tm_hour, t.tm_mday, t.tm_mon, t.tm_year, t.tm_wday, t.tm_yday, t.tm_isdst);
@@ -513,8 +558,7 @@ mixed f$microtime(bool get_as_float) {
 
 int64_t f$mktime(int64_t h, int64_t m, int64_t s, int64_t month, int64_t day, int64_t year) {
   tm t;
-  time_t timestamp_t = time(nullptr);
-  localtime_r(&timestamp_t, &t);
+  timestamp_to_local_tm(time(nullptr), t);
 
   if (h != std::numeric_limits<int64_t>::min()) {
     t.tm_hour = static_cast<int32_t>(h);
@@ -542,7 +586,7 @@ int64_t f$mktime(int64_t h, int64_t m, int64_t s, int64_t month, int64_t day, in
 
   t.tm_isdst = -1;
 
-  return mktime(&t);
+  return local_tm_to_timestamp(t);
 }
 
 string f$strftime(const string &format, int64_t timestamp) {
@@ -550,8 +594,7 @@ string f$strftime(const string &format, int64_t timestamp) {
     timestamp = time(nullptr);
   }
   tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  timestamp_to_local_tm(timestamp, t);
 
   if (!strftime(php_buf, PHP_BUF_LEN, format.c_str(), &t)) {
     return string();
@@ -565,8 +608,7 @@ Optional<int64_t> f$strtotime(const string &time_str, int64_t timestamp) {
     timestamp = time(nullptr);
   }
   tm t;
-  time_t timestamp_t = timestamp;
-  localtime_r(&timestamp_t, &t);
+  timestamp_to_local_tm(timestamp, t);
 
   string s = f$trim(time_str);
 
@@ -807,7 +849,7 @@ Optional<int64_t> f$strtotime(const string &time_str, int64_t timestamp) {
 
   if ((int)s.size() == 0) {
     t.tm_isdst = -1;
-    return need_gmt ? gmmktime(&t) : mktime(&t);
+    return need_gmt ? utc_tm_to_timestamp(t) : local_tm_to_timestamp(t);
   }
 
   php_critical_error ("strtotime can't parse string \"%s\", unparsed part: \"%s\"", time_str.c_str(), s.c_str());
@@ -0,0 +1,60 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "runtime/kphp_core.h"
+
+// The global constants are initialized in the master process, and their memory is shared with the workers until it's written.
+// Copying a nested value of a constant would increment its reference counter and make a private copy of the page,
+// therefore the nested strings and arrays get the constant reference counter too.
+
+void pin_global_const(string &value) noexcept;
+void pin_global_const(mixed &value) noexcept;
+
+template<class T>
+void pin_global_const(array<T> &value) noexcept;
+
+template<class T>
+void pin_global_const(Optional<T> &value) noexcept;
+
+// the other types have no reference counters or are never a part of a constant
+template<class T>
+void pin_global_const(T &) noexcept {
+}
+
+inline void pin_global_const(string &value) noexcept {
+  value.set_reference_counter_to(ExtraRefCnt::for_global_const);
+}
+
+inline void pin_global_const(mixed &value) noexcept {
+  if (value.is_string()) {
+    pin_global_const(value.as_string());
+  } else if (value.is_array()) {
+    pin_global_const(value.as_array());
+  }
+}
+
+template<class T>
+void pin_global_const(array<T> &value) noexcept {
+  // it's pinned already or placed into the read only memory
+  if (value.is_reference_counter(ExtraRefCnt::for_global_const)) {
+    return;
+  }
+  // the const iteration doesn't mutate the array, the reference counters are changed in place
+  for (auto it = value.cbegin(); it != value.cend(); ++it) {
+    if (it.is_string_key()) {
+      pin_global_const(const_cast<string &>(it.get_string_key()));
+    }
+    pin_global_const(const_cast<T &>(it.get_value()));
+  }
+  value.set_reference_counter_to(ExtraRefCnt::for_global_const);
+}
+
+template<class T>
+void pin_global_const(Optional<T> &value) noexcept {
+  if (value.has_value()) {
+    pin_global_const(value.val());
+  }
+}
@@ -0,0 +1,351 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "common/mixin/not_copyable.h"
+
+#include "runtime/msgpack-serialization.h"
+
+// The class layout independent format of the instance cache elements, the instance cache is passed in it to the new server version
+// on the graceful restart. An instance is packed as msgpack [class name, schema hash, {field name: value}],
+// the schema hash is calculated over the names and the types of the fields, so an instance is restored only if its class is not changed.
+
+namespace impl_ {
+
+constexpr uint64_t INSTANCE_SCHEMA_HASH_INIT = 14695981039346656037ULL;
+
+inline uint64_t instance_schema_hash_append(uint64_t hash, const char *s) noexcept {
+  // FNV-1a
+  for (; *s; ++s) {
+    hash = (hash ^ static_cast<uint8_t>(*s)) * 1099511628211ULL;
+  }
+  return (hash ^ 0xff) * 1099511628211ULL;
+}
+
+} // namespace impl_
+
+class InstanceCacheDumpVisitor : vk::not_copyable {
+public:
+  explicit InstanceCacheDumpVisitor(std::string &buffer) noexcept:
+    buffer_(buffer),
+    packer_(*this) {
+  }
+
+  // the msgpack stream interface
+  void write(const char *data, size_t size) noexcept {
+    buffer_.append(data, size);
+  }
+
+  template<typename T>
+  void operator()(const char *field_name, const T &value) noexcept {
+    schema_hash_ = impl_::instance_schema_hash_append(impl_::instance_schema_hash_append(schema_hash_, field_name), typeid(T).name());
+    ++fields_count_;
+    pack_raw_string(field_name, strlen(field_name));
+    dump(value);
+  }
+
+  template<typename I>
+  void dump(const class_instance<I> &instance) noexcept {
+    if (instance.is_null()) {
+      packer_.pack_nil();
+      return;
+    }
+    packer_.pack_array(3);
+    const char *class_name = instance.get_class();
+    pack_raw_string(class_name, strlen(class_name));
+    // the schema hash and the fields count are known only after the fields are visited, they are patched then
+    const size_t schema_hash_pos = buffer_.size();
+    packer_.pack_fix_uint64(0);
+    const size_t fields_count_pos = buffer_.size();
+    const char map32_header[5] = {static_cast<char>(0xdf), 0, 0, 0, 0};
+    write(map32_header, sizeof(map32_header));
+
+    const uint64_t outer_schema_hash = schema_hash_;
+    const uint32_t outer_fields_count = fields_count_;
+    schema_hash_ = impl_::INSTANCE_SCHEMA_HASH_INIT;
+    fields_count_ = 0;
+    instance.get()->accept(*this);
+    for (int i = 0; i < 8; ++i) {
+      buffer_[schema_hash_pos + 1 + i] = static_cast<char>(schema_hash_ >> (56 - 8 * i));
+    }
+    for (int i = 0; i < 4; ++i) {
+      buffer_[fields_count_pos + 1 + i] = static_cast<char>(fields_count_ >> (24 - 8 * i));
+    }
+    schema_hash_ = outer_schema_hash;
+    fields_count_ = outer_fields_count;
+  }
+
+  // the keys are kept as they are, so arrays are always packed as maps
+  template<typename T>
+  void dump(const array<T> &arr) noexcept {
+    packer_.pack_map(static_cast<uint32_t>(arr.count()));
+    for (const auto &it : arr) {
+      if (it.is_string_key()) {
+        packer_.pack(it.get_string_key());
+      } else {
+        packer_.pack(it.get_int_key());
+      }
+      dump(it.get_value());
+    }
+  }
+
+  template<typename T>
+  void dump(const Optional<T> &value) noexcept {
+    if (value.has_value()) {
+      dump(value.val());
+    } else if (value.is_null()) {
+      packer_.pack_nil();
+    } else {
+      packer_.pack_false();
+    }
+  }
+
+  template<typename ...Args>
+  void dump(const std::tuple<Args...> &value) noexcept {
+    packer_.pack_array(sizeof...(Args));
+    dump_tuple(value, std::index_sequence_for<Args...>{});
+  }
+
+  template<size_t ...Is, typename ...T>
+  void dump(const shape<std::index_sequence<Is...>, T...> &value) noexcept {
+    packer_.pack_array(sizeof...(Is));
+    std::initializer_list<int32_t>{((void)dump(value.template get<Is>()), 0)...};
+  }
+
+  void dump(const mixed &value) noexcept {
+    packer_.pack(value);
+  }
+
+  void dump(const string &value) noexcept {
+    packer_.pack(value);
+  }
+
+  void dump(bool value) noexcept {
+    packer_.pack(value);
+  }
+
+  void dump(int64_t value) noexcept {
+    packer_.pack(value);
+  }
+
+  void dump(double value) noexcept {
+    packer_.pack(value);
+  }
+
+  // the other types can't be restored
+  template<typename T>
+  void dump(const T &) noexcept {
+    is_ok_ = false;
+    packer_.pack_nil();
+  }
+
+  // writes the already dumped instance
+  void dump_raw(const char *data, size_t size) noexcept {
+    write(data, size);
+  }
+
+  bool is_ok() const noexcept {
+    return is_ok_;
+  }
+
+private:
+  template<typename ...Args, size_t ...Is>
+  void dump_tuple(const std::tuple<Args...> &value, std::index_sequence<Is...>) noexcept {
+    std::initializer_list<int32_t>{((void)dump(std::get<Is>(value)), 0)...};
+  }
+
+  void pack_raw_string(const char *s, size_t len) noexcept {
+    packer_.pack_str(static_cast<uint32_t>(len));
+    packer_.pack_str_body(s, static_cast<uint32_t>(len));
+  }
+
+  std::string &buffer_;
+  msgpack::packer<InstanceCacheDumpVisitor> packer_;
+  uint64_t schema_hash_{impl_::INSTANCE_SCHEMA_HASH_INIT};
+  uint32_t fields_count_{0};
+  bool is_ok_{true};
+};
+
+class InstanceCacheRestoreVisitor : vk::not_copyable {
+public:
+  explicit InstanceCacheRestoreVisitor(const msgpack::object_map &fields) noexcept:
+    fields_(fields) {
+  }
+
+  template<typename T>
+  void operator()(const char *field_name, T &value) noexcept {
+    schema_hash_ = impl_::instance_schema_hash_append(impl_::instance_schema_hash_append(schema_hash_, field_name), typeid(T).name());
+    const msgpack::object *field = find_field(field_name);
+    is_ok_ = is_ok_ && field && restore(*field, value);
+  }
+
+  template<typename I>
+  static bool restore(const msgpack::object &obj, class_instance<I> &instance) noexcept {
+    if (obj.type == msgpack::type::NIL) {
+      instance = class_instance<I>{};
+      return true;
+    }
+    return obj.type == msgpack::type::ARRAY && obj.via.array.size == 3 && restore_instance(obj.via.array.ptr, instance);
+  }
+
+  template<typename T>
+  static bool restore(const msgpack::object &obj, array<T> &arr) noexcept {
+    if (obj.type != msgpack::type::MAP) {
+      return false;
+    }
+    arr = array<T>{array_size{static_cast<int64_t>(obj.via.map.size), 0, false}};
+    for (uint32_t i = 0; i < obj.via.map.size; ++i) {
+      const msgpack::object_kv &kv = obj.via.map.ptr[i];
+      T value;
+      if (!restore(kv.val, value)) {
+        return false;
+      }
+      if (kv.key.type == msgpack::type::POSITIVE_INTEGER || kv.key.type == msgpack::type::NEGATIVE_INTEGER) {
+        arr.set_value(kv.key.via.i64, std::move(value));
+      } else if (kv.key.type == msgpack::type::STR) {
+        arr.set_value(string{kv.key.via.str.ptr, kv.key.via.str.size}, std::move(value));
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template<typename T>
+  static bool restore(const msgpack::object &obj, Optional<T> &value) noexcept {
+    if (obj.type == msgpack::type::NIL) {
+      value = Optional<T>{};
+      return true;
+    }
+    if (obj.type == msgpack::type::BOOLEAN && !obj.via.boolean && !std::is_same<T, bool>{}) {
+      value = false;
+      return true;
+    }
+    T inner;
+    if (!restore(obj, inner)) {
+      return false;
+    }
+    value = std::move(inner);
+    return true;
+  }
+
+  template<typename ...Args>
+  static bool restore(const msgpack::object &obj, std::tuple<Args...> &value) noexcept {
+    return obj.type == msgpack::type::ARRAY && obj.via.array.size == sizeof...(Args) &&
+           restore_tuple(obj.via.array.ptr, value, std::index_sequence_for<Args...>{});
+  }
+
+  template<size_t ...Is, typename ...T>
+  static bool restore(const msgpack::object &obj, shape<std::index_sequence<Is...>, T...> &value) noexcept {
+    if (obj.type != msgpack::type::ARRAY || obj.via.array.size != sizeof...(Is)) {
+      return false;
+    }
+    const bool results[] = {true, restore(obj.via.array.ptr[Is], value.template get<Is>())...};
+    return std::all_of(std::begin(results), std::end(results), [](bool r) { return r; });
+  }
+
+  static bool restore(const msgpack::object &obj, mixed &value) noexcept {
+    try {
+      obj.convert(value);
+      return true;
+    } catch (...) {
+      return false;
+    }
+  }
+
+  static bool restore(const msgpack::object &obj, string &value) noexcept {
+    if (obj.type != msgpack::type::STR) {
+      return false;
+    }
+    value = string{obj.via.str.ptr, obj.via.str.size};
+    return true;
+  }
+
+  static bool restore(const msgpack::object &obj, bool &value) noexcept {
+    if (obj.type != msgpack::type::BOOLEAN) {
+      return false;
+    }
+    value = obj.via.boolean;
+    return true;
+  }
+
+  static bool restore(const msgpack::object &obj, int64_t &value) noexcept {
+    if (obj.type != msgpack::type::POSITIVE_INTEGER && obj.type != msgpack::type::NEGATIVE_INTEGER) {
+      return false;
+    }
+    value = obj.via.i64;
+    return true;
+  }
+
+  static bool restore(const msgpack::object &obj, double &value) noexcept {
+    if (obj.type != msgpack::type::FLOAT32 && obj.type != msgpack::type::FLOAT64) {
+      return false;
+    }
+    value = obj.via.f64;
+    return true;
+  }
+
+  template<typename T>
+  static bool restore(const msgpack::object &, T &) noexcept {
+    return false;
+  }
+
+private:
+  template<typename I>
+  static std::enable_if_t<!std::is_abstract<I>{}, bool> restore_instance(const msgpack::object *node, class_instance<I> &instance) noexcept {
+    const msgpack::object &class_name = node[0];
+    const msgpack::object &schema_hash = node[1];
+    const msgpack::object &fields = node[2];
+    if (class_name.type != msgpack::type::STR || schema_hash.type != msgpack::type::POSITIVE_INTEGER || fields.type != msgpack::type::MAP) {
+      return false;
+    }
+    instance.alloc();
+    if (strlen(instance.get_class()) != class_name.via.str.size || memcmp(instance.get_class(), class_name.via.str.ptr, class_name.via.str.size) != 0) {
+      return false;
+    }
+    InstanceCacheRestoreVisitor fields_visitor{fields.via.map};
+    instance.get()->accept(fields_visitor);
+    return fields_visitor.is_ok_ && fields_visitor.schema_hash_ == schema_hash.via.u64 && fields_visitor.fields_found_ == fields.via.map.size;
+  }
+
+  template<typename I>
+  static std::enable_if_t<std::is_abstract<I>{}, bool> restore_instance(const msgpack::object *, class_instance<I> &) noexcept {
+    return false;
+  }
+
+  template<typename ...Args, size_t ...Is>
+  static bool restore_tuple(const msgpack::object *items, std::tuple<Args...> &value, std::index_sequence<Is...>) noexcept {
+    const bool results[] = {true, restore(items[Is], std::get<Is>(value))...};
+    return std::all_of(std::begin(results), std::end(results), [](bool r) { return r; });
+  }
+
+  const msgpack::object *find_field(const char *field_name) noexcept {
+    const size_t len = strlen(field_name);
+    // the fields are visited in the same order as they were dumped
+    for (uint32_t i = 0; i < fields_.size; ++i) {
+      const msgpack::object_kv &kv = fields_.ptr[(next_field_ + i) % fields_.size];
+      if (kv.key.type == msgpack::type::STR && kv.key.via.str.size == len && !memcmp(kv.key.via.str.ptr, field_name, len)) {
+        next_field_ = (next_field_ + i + 1) % fields_.size;
+        ++fields_found_;
+        return &kv.val;
+      }
+    }
+    return nullptr;
+  }
+
+  const msgpack::object_map &fields_;
+  uint32_t next_field_{0};
+  uint32_t fields_found_{0};
+  uint64_t schema_hash_{impl_::INSTANCE_SCHEMA_HASH_INIT};
+  bool is_ok_{true};
+};
@@ -5,12 +5,16 @@
 #include "runtime/instance-cache.h"
 
 #include <chrono>
+#include <cstdio>
 #include <forward_list>
 #include <map>
 #include <mutex>
+#include <unistd.h>
 #include <unordered_set>
+#include <vector>
 
 #include "common/kprintf.h"
+#include "common/wrappers/string_view.h"
 
 #include "runtime/allocator.h"
 #include "runtime/critical_section.h"
@@ -47,6 +51,13 @@ static constexpr std::chrono::minutes PHYSICAL_REMOVING_DELAY{1};
 static constexpr size_t DATA_SHARDS_COUNT{997u};
 // The buckets check step during the cache cleanup
 static constexpr size_t SHARDS_PURGE_PERIOD{5u};
+// The dump file header and its format version
+static constexpr const char *DUMP_MAGIC{"kphp-instance-cache"};
+static constexpr int64_t DUMP_VERSION{1};
+// The part of the memory limit, that can be used by the loaded dump, the rest is left for the new elements
+static constexpr double DUMP_LOADING_MEMORY_RATIO{0.5};
+// The dump file is written by the pieces of this size
+static constexpr size_t DUMP_WRITE_BUFFER_SIZE{1024u * 1024u};
 
 class ElementHolder;
 
@@ -405,6 +416,42 @@ public:
     return result;
   }
 
+  void replace_serialized(const string &key, const InstanceCacheSerializedCopyist &serialized, const InstanceCopyistBase *restored_wrapper) noexcept {
+    php_assert(current_ && context_);
+    // request_cache_ uses a script memory
+    request_cache_.unset(key);
+    auto &data = current_->get_data(key);
+    update_now();
+    if (restored_wrapper) {
+      if (context_->memory_swap_required) {
+        return;
+      }
+      InstanceDeepCopyVisitor detach_processor{context_->memory_resource, ExtraRefCnt::for_instance_cache};
+      const ElementHolder *inserted_element = try_insert_element_into_cache(
+        data, key, 0, *restored_wrapper, detach_processor, &serialized);
+      if (!inserted_element) {
+        // the element will be restored again by the next fetch
+        if (unlikely(!detach_processor.is_ok())) {
+          fire_warning(detach_processor, restored_wrapper->get_class());
+        }
+        return;
+      }
+      ic_debug("element '%s' was successfully restored\n", key.c_str());
+      context_->stats.elements_restored_on_restart.fetch_add(1, std::memory_order_relaxed);
+      // request_cache_ uses a script memory
+      request_cache_.set_value(key, inserted_element);
+      return;
+    }
+
+    // the element can't be restored by this server version, expire it so that the next store is not skipped
+    ic_debug("element '%s' can't be restored\n", key.c_str());
+    std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
+    auto it = data.storage.find(key);
+    if (it != data.storage.end() && it->second->instance_wrapper.get() == &serialized) {
+      it->second->expiring_at = it->second->stored_at;
+    }
+  }
+
   bool update_ttl(const string &key, int64_t ttl) {
     php_assert(current_ && context_);
     ic_debug("update_ttl '%s', new ttl '%" PRIi64 "'\n", key.c_str(), ttl);
@@ -510,6 +557,131 @@ public:
     last_memory_stats_ = context.memory_resource.get_memory_stats();
   }
 
+  // this function should be called only from master
+  bool dump_to_file(const char *path) {
+    update_now();
+    const std::string tmp_path = std::string{path} + ".tmp";
+    FILE *file = fopen(tmp_path.c_str(), "wb");
+    if (!file) {
+      kprintf("Can't open instance cache dump file '%s': %m\n", tmp_path.c_str());
+      return false;
+    }
+
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer{buffer};
+    packer.pack_array(2);
+    packer.pack(DUMP_MAGIC);
+    packer.pack(DUMP_VERSION);
+
+    auto &current_data = data_manager_.get_current_resource();
+    auto *data_shards = current_data.get_data_shards();
+    std::vector<std::pair<std::string, vk::intrusive_ptr<ElementHolder>>> elements;
+    size_t elements_dumped = 0;
+    size_t elements_skipped = 0;
+    bool ok = true;
+    for (size_t shard_id = 0; shard_id < current_data.get_data_shards_count() && ok; ++shard_id) {
+      auto &data_shard = data_shards[shard_id];
+      if (data_shard.is_storage_empty.load(std::memory_order_relaxed)) {
+        continue;
+      }
+      {
+        // the elements are held by the intrusive_ptr, so they are dumped without the lock
+        std::lock_guard<inter_process_mutex> shared_data_lock{data_shard.storage_mutex};
+        for (const auto &stored_element : data_shard.storage) {
+          if (stored_element.second->expiring_at > now_) {
+            elements.emplace_back(std::string{stored_element.first.c_str(), stored_element.first.size()}, stored_element.second);
+          }
+        }
+      }
+
+      std::string node;
+      for (const auto &element : elements) {
+        node.clear();
+        InstanceCacheDumpVisitor dump_processor{node};
+        if (!element.second->instance_wrapper->dump(dump_processor)) {
+          ++elements_skipped;
+          continue;
+        }
+        const char *class_name = element.second->instance_wrapper->get_class();
+        packer.pack_array(5);
+        packer.pack(element.first);
+        packer.pack(class_name);
+        packer.pack(static_cast<int64_t>(element.second->stored_at.count()));
+        packer.pack(static_cast<int64_t>(element.second->expiring_at.count()));
+        packer.pack_bin(static_cast<uint32_t>(node.size()));
+        packer.pack_bin_body(node.data(), static_cast<uint32_t>(node.size()));
+        ++elements_dumped;
+        if (buffer.size() >= DUMP_WRITE_BUFFER_SIZE) {
+          ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+          buffer.clear();
+        }
+      }
+      elements.clear();
+    }
+    ok = ok && fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tmp_path.c_str(), path) != 0) {
+      kprintf("Can't write instance cache dump file '%s': %m\n", path);
+      unlink(tmp_path.c_str());
+      return false;
+    }
+    kprintf("Instance cache is dumped to '%s': %zu elements, %zu elements are skipped\n", path, elements_dumped, elements_skipped);
+    return true;
+  }
+
+  // this function should be called only from master
+  bool load_from_file(const char *path) {
+    std::string content;
+    if (!read_file(path, content)) {
+      return false;
+    }
+
+    update_now();
+    size_t elements_loaded = 0;
+    size_t elements_skipped = 0;
+    try {
+      size_t offset = 0;
+      msgpack::object_handle header = msgpack::unpack(content.data(), content.size(), offset);
+      const msgpack::object &header_obj = header.get();
+      if (header_obj.type != msgpack::type::ARRAY || header_obj.via.array.size != 2 ||
+          header_obj.via.array.ptr[0].as<std::string>() != DUMP_MAGIC || header_obj.via.array.ptr[1].as<int64_t>() != DUMP_VERSION) {
+        kprintf("Instance cache dump file '%s' has unknown format\n", path);
+        return false;
+      }
+
+      while (offset < content.size()) {
+        msgpack::object_handle entry = msgpack::unpack(content.data(), content.size(), offset);
+        const msgpack::object &entry_obj = entry.get();
+        if (entry_obj.type != msgpack::type::ARRAY || entry_obj.via.array.size != 5) {
+          kprintf("Instance cache dump file '%s' has malformed element\n", path);
+          break;
+        }
+        const msgpack::object *fields = entry_obj.via.array.ptr;
+        if (fields[0].type != msgpack::type::STR || fields[1].type != msgpack::type::STR || fields[4].type != msgpack::type::BIN) {
+          kprintf("Instance cache dump file '%s' has malformed element\n", path);
+          break;
+        }
+        const vk::string_view key{fields[0].via.str.ptr, fields[0].via.str.size};
+        const vk::string_view class_name{fields[1].via.str.ptr, fields[1].via.str.size};
+        const vk::string_view node{fields[4].via.bin.ptr, fields[4].via.bin.size};
+        const std::chrono::nanoseconds stored_at{fields[2].as<int64_t>()};
+        const std::chrono::nanoseconds expiring_at{fields[3].as<int64_t>()};
+        if (expiring_at <= now_) {
+          ++elements_skipped;
+          continue;
+        }
+        if (!insert_serialized_element(key, class_name, node, stored_at, expiring_at)) {
+          break;
+        }
+        ++elements_loaded;
+      }
+    } catch (const std::exception &e) {
+      kprintf("Instance cache dump file '%s' is malformed: %s\n", path, e.what());
+    }
+    kprintf("Instance cache is loaded from '%s': %zu elements, %zu expired elements are skipped\n", path, elements_loaded, elements_skipped);
+    return true;
+  }
+
   // this function should be called only from master
   InstanceCacheSwapStatus try_swap_memory_resource() {
     const auto &memory_stats = get_last_memory_stats();
@@ -534,6 +706,76 @@ public:
   }
 
 private:
+  static bool read_file(const char *path, std::string &content) noexcept {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+      kprintf("Can't open instance cache dump file '%s': %m\n", path);
+      return false;
+    }
+    char chunk[64 * 1024];
+    size_t read_bytes = 0;
+    while ((read_bytes = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      content.append(chunk, read_bytes);
+    }
+    const bool ok = !ferror(file);
+    fclose(file);
+    if (!ok) {
+      kprintf("Can't read instance cache dump file '%s'\n", path);
+    }
+    return ok;
+  }
+
+  // returns false if there is no memory for the element
+  bool insert_serialized_element(vk::string_view key, vk::string_view class_name, vk::string_view node,
+                                 std::chrono::nanoseconds stored_at, std::chrono::nanoseconds expiring_at) noexcept {
+    auto &current_data = data_manager_.get_current_resource();
+    auto &context = current_data.get_context();
+
+    const auto &memory_stats = context.memory_resource.get_memory_stats();
+    const size_t element_size = key.size() + class_name.size() + node.size() + sizeof(ElementHolder) + sizeof(InstanceCacheSerializedCopyist) +
+                                ElementStorage_::allocator_type::max_value_type_size() + 3 * string::inner_sizeof();
+    if (static_cast<double>(memory_stats.real_memory_used + element_size) > DUMP_LOADING_MEMORY_RATIO * static_cast<double>(memory_stats.memory_limit)) {
+      return false;
+    }
+
+    // replace the default script allocator, as this call happens from the master process
+    auto shared_memory_guard = context.memory_replacement_guard(true);
+    std::lock_guard<inter_process_mutex> allocator_lock{context.allocator_mutex};
+    InstanceDeepCopyVisitor detach_processor{context.memory_resource, ExtraRefCnt::for_instance_cache};
+    string key_in_shared_memory{key.data(), static_cast<string::size_type>(key.size())};
+    string class_name_in_shared_memory{class_name.data(), static_cast<string::size_type>(class_name.size())};
+    string node_in_shared_memory{node.data(), static_cast<string::size_type>(node.size())};
+    detach_processor.process(key_in_shared_memory);
+    detach_processor.process(class_name_in_shared_memory);
+    detach_processor.process(node_in_shared_memory);
+    auto wrapper = make_unique_on_script_memory<InstanceCacheSerializedCopyist>(std::move(class_name_in_shared_memory), std::move(node_in_shared_memory));
+    void *mem = detach_processor.prepare_raw_memory(sizeof(ElementHolder));
+    if (unlikely(!wrapper || !mem || !detach_processor.is_ok())) {
+      InstanceDeepDestroyVisitor{ExtraRefCnt::for_instance_cache}.process(key_in_shared_memory);
+      return false;
+    }
+    vk::intrusive_ptr<ElementHolder> element{new(mem) ElementHolder{now_, 0, std::move(wrapper), context}};
+    element->stored_at = stored_at;
+    element->expiring_at = expiring_at;
+
+    auto &data = current_data.get_data(key_in_shared_memory);
+    {
+      std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
+      auto it = data.storage.find(key_in_shared_memory);
+      if (it == data.storage.end()) {
+        data.storage.emplace(std::move(key_in_shared_memory), std::move(element));
+        data.is_storage_empty.store(false, std::memory_order_relaxed);
+        context.stats.elements_cached.fetch_add(1, std::memory_order_relaxed);
+        context.stats.elements_loaded_on_restart.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        InstanceDeepDestroyVisitor{ExtraRefCnt::for_instance_cache}.process(key_in_shared_memory);
+      }
+    }
+    element.reset();
+    context.clear_garbage();
+    return true;
+  }
+
   bool is_element_insertion_can_be_skipped(SharedDataStorages &data, const string &key) const {
     std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
     auto it = data.storage.find(key);
@@ -587,10 +829,12 @@ private:
     }
   }
 
+  // if the replaced_wrapper is passed, the element is inserted only instead of it and gets its time points
   ElementHolder *try_insert_element_into_cache(SharedDataStorages &data,
                                                const string &key_in_script_memory, int64_t ttl,
                                                const InstanceCopyistBase &instance_wrapper,
-                                               InstanceDeepCopyVisitor &detach_processor) noexcept {
+                                               InstanceDeepCopyVisitor &detach_processor,
+                                               const InstanceCopyistBase *replaced_wrapper = nullptr) noexcept {
     // swap the allocator
     auto shared_memory_guard = context_->memory_replacement_guard();
 
@@ -609,6 +853,14 @@ private:
         vk::intrusive_ptr<ElementHolder> element{new(mem) ElementHolder{now_, ttl, std::move(cached_instance_wrapper), *context_}};
         std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
         auto it = data.storage.find(key_in_script_memory);
+        if (replaced_wrapper) {
+          if (it == data.storage.end() || it->second->instance_wrapper.get() != replaced_wrapper) {
+            return nullptr;
+          }
+          element->stored_at = it->second->stored_at;
+          element->expiring_at = it->second->expiring_at;
+          element->early_fetch_performed = it->second->early_fetch_performed;
+        }
         if (it == data.storage.end()) {
           string key_in_shared_memory = key_in_script_memory;
           if (unlikely(!detach_processor.process(key_in_shared_memory))) {
@@ -690,6 +942,10 @@ const InstanceCopyistBase *instance_cache_fetch_wrapper(const string &key, bool
   return InstanceCache::get().fetch(key, even_if_expired);
 }
 
+void instance_cache_replace_serialized(const string &key, const InstanceCacheSerializedCopyist &serialized, const InstanceCopyistBase *restored_wrapper) {
+  InstanceCache::get().replace_serialized(key, serialized, restored_wrapper);
+}
+
 } // namespace impl_
 
 void global_init_instance_cache_lib() {
@@ -729,6 +985,16 @@ void instance_cache_purge_expired_elements() {
   impl_::InstanceCache::get().purge_expired();
 }
 
+// should be called only from master
+bool instance_cache_dump_to_file(const char *path) {
+  return impl_::InstanceCache::get().dump_to_file(path);
+}
+
+// should be called only from master
+bool instance_cache_load_from_file(const char *path) {
+  return impl_::InstanceCache::get().load_from_file(path);
+}
+
 void instance_cache_release_all_resources_acquired_by_this_proc() {
   impl_::InstanceCache::get().force_release_all_resources();
 }
@@ -18,14 +18,72 @@
 
 #include "common/mixin/not_copyable.h"
 
+#include "runtime/allocator.h"
+#include "runtime/cycle-attribution.h"
 #include "runtime/instance-copy-processor.h"
 #include "runtime/kphp_core.h"
 #include "runtime/shape.h"
 
+// An element loaded from the instance cache dump of the previous server version,
+// it is kept in the dumped form until the first fetch, which knows the expected class and restores it
+class InstanceCacheSerializedCopyist final : public InstanceCopyistBase {
+public:
+  // the strings are expected to be allocated in the instance cache memory
+  InstanceCacheSerializedCopyist(string &&class_name, string &&serialized) noexcept:
+    class_name_(std::move(class_name)),
+    serialized_(std::move(serialized)) {
+  }
+
+  const char *get_class() const noexcept final {
+    return class_name_.c_str();
+  }
+
+  // the element is never stored again, it is replaced by the restored instance
+  std::unique_ptr<InstanceCopyistBase> deep_copy_and_set_ref_cnt(InstanceDeepCopyVisitor &) const noexcept final {
+    return {};
+  }
+
+  std::unique_ptr<InstanceCopyistBase> shallow_copy() const noexcept final {
+    return {};
+  }
+
+  bool dump(InstanceCacheDumpVisitor &dump_processor) const noexcept final {
+    dump_processor.dump_raw(serialized_.c_str(), serialized_.size());
+    return true;
+  }
+
+  // returns null if the dumped instance doesn't match the class of this server version
+  template<typename ClassInstanceType>
+  ClassInstanceType restore() const noexcept {
+    const auto malloc_replacement_guard = make_malloc_replacement_with_script_allocator();
+    ClassInstanceType result;
+    try {
+      msgpack::object_handle oh = msgpack::unpack(serialized_.c_str(), serialized_.size());
+      if (!InstanceCacheRestoreVisitor::restore(oh.get(), result)) {
+        result = ClassInstanceType{};
+      }
+    } catch (...) {
+      result = ClassInstanceType{};
+    }
+    return result;
+  }
+
+  ~InstanceCacheSerializedCopyist() noexcept final {
+    InstanceDeepDestroyVisitor{ExtraRefCnt::for_instance_cache}.process(class_name_);
+    InstanceDeepDestroyVisitor{ExtraRefCnt::for_instance_cache}.process(serialized_);
+  }
+
+private:
+  string class_name_;
+  string serialized_;
+};
+
 namespace impl_ {
 
 bool instance_cache_store(const string &key, const InstanceCopyistBase &instance_wrapper, int64_t ttl);
 const InstanceCopyistBase *instance_cache_fetch_wrapper(const string &key, bool even_if_expired);
+// replaces the fetched serialized element with the restored instance, or expires it if the restored_wrapper is null
+void instance_cache_replace_serialized(const string &key, const InstanceCacheSerializedCopyist &serialized, const InstanceCopyistBase *restored_wrapper);
 
 } // namespace impl_
 
@@ -52,6 +110,9 @@ struct InstanceCacheStats : private vk::not_copyable {
   std::atomic<uint64_t> elements_created{0};
   std::atomic<uint64_t> elements_destroyed{0};
   std::atomic<uint64_t> elements_cached{0};
+
+  std::atomic<uint64_t> elements_loaded_on_restart{0};
+  std::atomic<uint64_t> elements_restored_on_restart{0};
 };
 
 enum class InstanceCacheSwapStatus {
@@ -67,6 +128,10 @@ const InstanceCacheStats &instance_cache_get_stats();
 const memory_resource::MemoryStats &instance_cache_get_memory_stats();
 // these function should be called from master
 void instance_cache_purge_expired_elements();
+// these function should be called from master, the dump is used to pass the instance cache to the new server version on the graceful restart
+bool instance_cache_dump_to_file(const char *path);
+// these function should be called from master
+bool instance_cache_load_from_file(const char *path);
 
 void instance_cache_release_all_resources_acquired_by_this_proc();
 
@@ -76,6 +141,7 @@ bool f$instance_cache_store(const string &key, const ClassInstanceType &instance
   if (instance.is_null()) {
     return false;
   }
+  CycleAttributionScope cycle_attribution{CycleSubsystem::instance_cache};
   InstanceCopyistImpl<ClassInstanceType> instance_wrapper{instance};
   return impl_::instance_cache_store(key, instance_wrapper, ttl);
 }
@@ -83,6 +149,7 @@ bool f$instance_cache_store(const string &key, const ClassInstanceType &instance
 template<typename ClassInstanceType>
 ClassInstanceType f$instance_cache_fetch(const string &class_name, const string &key, bool even_if_expired = false) {
   static_assert(is_class_instance<ClassInstanceType>::value, "class_instance<> type expected");
+  CycleAttributionScope cycle_attribution{CycleSubsystem::instance_cache};
   if (const auto *base_wrapper = impl_::instance_cache_fetch_wrapper(key, even_if_expired)) {
     // do not use first parameter (class name) for verifying type,
     // because different classes from separated libs may have same names
@@ -90,6 +157,15 @@ ClassInstanceType f$instance_cache_fetch(const string &class_name, const string
       auto result = wrapper->get_instance();
       php_assert(!result.is_null());
       return result;
+    } else if (auto serialized = dynamic_cast<const InstanceCacheSerializedCopyist *>(base_wrapper)) {
+      auto result = serialized->template restore<ClassInstanceType>();
+      if (result.is_null()) {
+        impl_::instance_cache_replace_serialized(key, *serialized, nullptr);
+      } else {
+        InstanceCopyistImpl<ClassInstanceType> instance_wrapper{result};
+        impl_::instance_cache_replace_serialized(key, *serialized, &instance_wrapper);
+      }
+      return result;
     } else {
       php_warning("Trying to fetch incompatible instance class: expect '%s', got '%s'",
                   class_name.c_str(), base_wrapper->get_class());
@@ -9,6 +9,7 @@
 
 #include "common/mixin/not_copyable.h"
 
+#include "runtime/instance-cache-dump-processor.h"
 #include "runtime/kphp_core.h"
 #include "runtime/memory_resource/unsynchronized_pool_resource.h"
 
@@ -233,6 +234,8 @@ public:
   virtual const char *get_class() const noexcept = 0;
   virtual std::unique_ptr<InstanceCopyistBase> deep_copy_and_set_ref_cnt(InstanceDeepCopyVisitor &detach_processor) const noexcept = 0;
   virtual std::unique_ptr<InstanceCopyistBase> shallow_copy() const noexcept = 0;
+  // returns false if the instance has values, which can't be restored from the dump
+  virtual bool dump(InstanceCacheDumpVisitor &dump_processor) const noexcept = 0;
   virtual ~InstanceCopyistBase() noexcept = default;
 };
 
@@ -275,6 +278,11 @@ public:
     return make_unique_on_script_memory<InstanceCopyistImpl<class_instance<I>>>(instance_);
   }
 
+  bool dump(InstanceCacheDumpVisitor &dump_processor) const noexcept final {
+    dump_processor.dump(instance_);
+    return dump_processor.is_ok();
+  }
+
   class_instance<I> get_instance() const noexcept {
     return instance_;
   }
@@ -32,6 +32,7 @@
 #include "runtime/job-workers/server-functions.h"
 #include "runtime/kphp-backtrace.h"
 #include "runtime/math_functions.h"
+#include "runtime/mbstring.h"
 #include "runtime/memcache.h"
 #include "runtime/mysql.h"
 #include "runtime/net_events.h"
@@ -2187,6 +2188,7 @@ static void free_runtime_libs() {
   free_memcache_lib();
   free_mysql_lib();
   free_files_lib();
+  free_mbstring_lib();
   free_openssl_lib();
   free_rpc_lib();
   free_typed_rpc_lib();
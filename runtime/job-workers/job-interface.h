@@ -14,6 +14,10 @@ class InstanceToArrayVisitor;
 
 class InstanceMemoryEstimateVisitor;
 
+class InstanceCacheDumpVisitor;
+
+class InstanceCacheRestoreVisitor;
+
 namespace job_workers {
 
 struct SendingInstanceBase : abstract_refcountable_php_interface {
@@ -27,6 +31,9 @@ struct SendingInstanceBase : abstract_refcountable_php_interface {
 
   virtual void accept(InstanceMemoryEstimateVisitor &) noexcept {}
 
+  virtual void accept(InstanceCacheDumpVisitor &) noexcept {}
+  virtual void accept(InstanceCacheRestoreVisitor &) noexcept {}
+
   virtual size_t virtual_builtin_sizeof() const noexcept = 0;
   virtual SendingInstanceBase *virtual_builtin_clone() const noexcept = 0;
 
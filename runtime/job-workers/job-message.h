@@ -20,6 +20,8 @@ struct JobSharedMessage : vk::not_copyable {
 
   int job_id{0};
   int job_result_fd_idx{-1};
+  // the monotonic time, when the message was put to the shared queue
+  double queued_time{0};
 };
 
 } // namespace job_workers
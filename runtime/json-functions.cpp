@@ -527,6 +527,7 @@ mixed f$json_decode(const string &v, bool assoc) noexcept {
   // TODO It was a warning before (in case if assoc is false), but then it was disabled, should we enable it again?
   static_cast<void>(assoc);
 
+  CycleAttributionScope cycle_attribution{CycleSubsystem::json};
   mixed result;
   int i = 0;
   if (do_json_decode(v.c_str(), v.size(), i, result)) {
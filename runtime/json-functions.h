@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "runtime/cycle-attribution.h"
 #include "runtime/exception.h"
 #include "runtime/kphp_core.h"
 
@@ -107,6 +108,7 @@ Optional<string> f$json_encode(const T &v, int64_t options = 0, bool simple_enco
     return false;
   }
 
+  CycleAttributionScope cycle_attribution{CycleSubsystem::json};
   static_SB.clean();
   if (unlikely(!impl_::JsonEncoder(options, simple_encode).encode(v))) {
     return false;
@@ -116,6 +118,7 @@ Optional<string> f$json_encode(const T &v, int64_t options = 0, bool simple_enco
 
 template<class T>
 string f$vk_json_encode_safe(const T &v, bool simple_encode = true) noexcept {
+  CycleAttributionScope cycle_attribution{CycleSubsystem::json};
   static_SB.clean();
   string_buffer::string_buffer_error_flag = STRING_BUFFER_ERROR_FLAG_ON;
   impl_::JsonEncoder(0, simple_encode).encode(v);
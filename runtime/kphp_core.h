@@ -1359,6 +1359,8 @@ array<int64_t> f$memory_get_detailed_stats() {
       std::make_pair(string{"max_real_memory_used"}, static_cast<int64_t>(stats.max_real_memory_used)),
       std::make_pair(string{"max_memory_used"}, static_cast<int64_t>(stats.max_memory_used)),
       std::make_pair(string{"defragmentation_calls"}, static_cast<int64_t>(stats.defragmentation_calls)),
+      std::make_pair(string{"huge_pieces_coalescing_calls"}, static_cast<int64_t>(stats.huge_pieces_coalescing_calls)),
+      std::make_pair(string{"defragmentation_time_ns"}, static_cast<int64_t>(stats.defragmentation_time_ns)),
       std::make_pair(string{"huge_memory_pieces"}, static_cast<int64_t>(stats.huge_memory_pieces)),
       std::make_pair(string{"small_memory_pieces"}, static_cast<int64_t>(stats.small_memory_pieces)),
       std::make_pair(string{"heap_memory_used"}, static_cast<int64_t>(dl::get_heap_memory_used()))
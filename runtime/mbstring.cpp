@@ -17,42 +17,193 @@ static int mb_detect_encoding(const string &encoding) {
   return -1;
 }
 
-static int64_t mb_UTF8_strlen(const char *s) {
+namespace {
+
+constexpr uint64_t MB_HIGH_BITS = 0x8080808080808080ULL;
+constexpr uint64_t MB_LOW_BITS = 0x0101010101010101ULL;
+
+uint64_t mb_load_word(const char *s) noexcept {
+  uint64_t word = 0;
+  memcpy(&word, s, sizeof(word));
+  return word;
+}
+
+// the number of bytes in the word, that are not the UTF-8 continuation bytes (10xxxxxx)
+int mb_UTF8_word_chars(uint64_t word) noexcept {
+  return 8 - __builtin_popcountll(word & ~(word << 1) & MB_HIGH_BITS);
+}
+
+bool mb_is_char_start(char c) noexcept {
+  return (static_cast<unsigned char>(c) & 0xc0) != 0x80;
+}
+
+// the string length up to the first '\0', as all the mb_ functions treat the strings as the C strings
+int64_t mb_UTF8_size(const string &str) noexcept {
+  const void *zero = memchr(str.c_str(), 0, str.size());
+  return zero ? static_cast<const char *>(zero) - str.c_str() : str.size();
+}
+
+int64_t mb_UTF8_count(const char *s, int64_t size) noexcept {
   int64_t res = 0;
-  for (int64_t i = 0; s[i]; i++) {
-    if ((((unsigned char)s[i]) & 0xc0) != 0x80) {
-      res++;
-    }
+  int64_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    res += mb_UTF8_word_chars(mb_load_word(s + i));
+  }
+  for (; i < size; i++) {
+    res += mb_is_char_start(s[i]);
   }
   return res;
 }
 
-static int64_t mb_UTF8_advance(const char *s, int64_t cnt) {
+// the byte offset of the cnt-th char or size if there are less chars
+int64_t mb_UTF8_advance(const char *s, int64_t size, int64_t cnt) noexcept {
   php_assert (cnt >= 0);
-  int64_t i;
-  for (i = 0; s[i] && cnt >= 0; i++) {
-    if ((((unsigned char)s[i]) & 0xc0) != 0x80) {
-      cnt--;
+  int64_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const int chars = mb_UTF8_word_chars(mb_load_word(s + i));
+    if (chars > cnt) {
+      break;
     }
+    cnt -= chars;
   }
-  if (cnt < 0) {
-    i--;
+  for (; i < size; i++) {
+    if (mb_is_char_start(s[i]) && cnt-- == 0) {
+      return i;
+    }
   }
-  return i;
+  return size;
 }
 
-static int64_t mb_UTF8_get_offset(const char *s, int64_t pos) {
-  int64_t res = 0;
-  for (int64_t i = 0; i < pos && s[i]; i++) {
-    if ((((unsigned char)s[i]) & 0xc0) != 0x80) {
-      res++;
+// The char offsets index of the last long UTF-8 string passed to mb_strlen, mb_substr or mb_strpos.
+// The byte offset of each MB_INDEX_STEP-th char is remembered, so the loops like
+// 'for ($i = 0; $i < mb_strlen($s); ++$i) { $c = mb_substr($s, $i, 1); }' don't rescan the string from its beginning.
+// The index is keyed by the data pointer and the size of the string and doesn't reference it, so the appends don't copy
+// the indexed string. The string drops the index, when its data is modified in place or freed (see string::mb_indexed_data).
+constexpr int64_t MB_INDEX_MIN_SIZE = 1024;
+constexpr int64_t MB_INDEX_STEP = 64;
+
+class MbUTF8Index {
+public:
+  bool is_applicable(const string &str) const noexcept {
+    return str.size() >= MB_INDEX_MIN_SIZE;
+  }
+
+  void assign(const string &str) noexcept {
+    if (string::mb_indexed_data != str.c_str() || str_size_ != str.size()) {
+      string::mb_indexed_data = str.c_str();
+      str_size_ = str.size();
+      size_ = mb_UTF8_size(str);
+      length_ = -1;
+      is_complete_ = false;
+      checkpoints_ = array<int64_t>();
     }
   }
-  return res;
+
+  const char *data() const noexcept {
+    return string::mb_indexed_data;
+  }
+
+  int64_t size() const noexcept {
+    return size_;
+  }
+
+  int64_t length() noexcept {
+    if (length_ < 0) {
+      const int64_t last = checkpoints_.count();
+      const int64_t from = last ? checkpoints_.get_value(last - 1) : 0;
+      length_ = last * MB_INDEX_STEP + mb_UTF8_count(data() + from, size_ - from);
+    }
+    return length_;
+  }
+
+  int64_t advance(int64_t cnt) noexcept {
+    php_assert (cnt >= 0);
+    // checkpoints_[i] is the byte offset of the ((i + 1) * MB_INDEX_STEP)-th char
+    const int64_t checkpoint = cnt / MB_INDEX_STEP;
+    while (checkpoints_.count() < checkpoint && !is_complete_) {
+      const int64_t last = checkpoints_.count();
+      const int64_t from = last ? checkpoints_.get_value(last - 1) : 0;
+      const int64_t next = from + mb_UTF8_advance(data() + from, size_ - from, MB_INDEX_STEP);
+      if (next == size_) {
+        is_complete_ = true;
+        break;
+      }
+      checkpoints_.push_back(next);
+    }
+    const int64_t known = std::min(checkpoint, checkpoints_.count());
+    const int64_t from = known ? checkpoints_.get_value(known - 1) : 0;
+    return from + mb_UTF8_advance(data() + from, size_ - from, cnt - known * MB_INDEX_STEP);
+  }
+
+  void reset() noexcept {
+    string::mb_indexed_data = nullptr;
+    hard_reset_var(checkpoints_);
+    str_size_ = 0;
+    size_ = 0;
+    length_ = -1;
+    is_complete_ = false;
+  }
+
+private:
+  string::size_type str_size_{0};
+  // the size up to the first '\0'
+  int64_t size_{0};
+  int64_t length_{-1};
+  bool is_complete_{false};
+  array<int64_t> checkpoints_;
+};
+
+MbUTF8Index mb_UTF8_index;
+
+int64_t mb_UTF8_strlen(const string &str) noexcept {
+  if (mb_UTF8_index.is_applicable(str)) {
+    mb_UTF8_index.assign(str);
+    return mb_UTF8_index.length();
+  }
+  return mb_UTF8_count(str.c_str(), mb_UTF8_size(str));
+}
+
+int64_t mb_UTF8_advance(const string &str, int64_t cnt) noexcept {
+  if (mb_UTF8_index.is_applicable(str)) {
+    mb_UTF8_index.assign(str);
+    return mb_UTF8_index.advance(cnt);
+  }
+  return mb_UTF8_advance(str.c_str(), mb_UTF8_size(str), cnt);
+}
+
+// the long strings don't get rescanned for '\0', their size is cached by the index
+int64_t mb_UTF8_cached_size(const string &str) noexcept {
+  if (mb_UTF8_index.is_applicable(str)) {
+    mb_UTF8_index.assign(str);
+    return mb_UTF8_index.size();
+  }
+  return mb_UTF8_size(str);
+}
+
+} // namespace
+
+const char *string::mb_indexed_data = nullptr;
+
+void free_mbstring_lib() {
+  mb_UTF8_index.reset();
 }
 
 bool mb_UTF8_check(const char *s) {
+  return mb_UTF8_check(s, strlen(s));
+}
+
+bool mb_UTF8_check(const char *s, size_t size) {
+  const char *end = s + size;
   do {
+    // the ascii chars are skipped by words, a word with '\0' is left for the bytewise check
+    while (end - s >= 8) {
+      const uint64_t word = mb_load_word(s);
+      if ((word & MB_HIGH_BITS) || ((word - MB_LOW_BITS) & ~word & MB_HIGH_BITS)) {
+        break;
+      }
+      s += 8;
+    }
+
 #define CHECK(condition) if (!(condition)) {return false;}
     unsigned int a = (unsigned char)(*s++);
     if ((a & 0x80) == 0) {
@@ -105,7 +256,7 @@ bool f$mb_check_encoding(const string &str, const string &encoding) {
     return true;
   }
 
-  return mb_UTF8_check(str.c_str());
+  return mb_UTF8_check(str.c_str(), str.size());
 }
 
 
@@ -120,7 +271,7 @@ int64_t f$mb_strlen(const string &str, const string &encoding) {
     return str.size();
   }
 
-  return mb_UTF8_strlen(str.c_str());
+  return mb_UTF8_strlen(str);
 }
 
 
@@ -284,12 +435,13 @@ Optional<int64_t> mp_strpos_impl(const string &haystack, const string &needle, i
     return f$strpos(haystack, needle, offset);
   }
 
-  int64_t UTF8_offset = mb_UTF8_advance(haystack.c_str(), offset);
+  const int64_t UTF8_offset = mb_UTF8_advance(haystack, offset);
   const char *s = static_cast<const char *>(memmem(haystack.c_str() + UTF8_offset, haystack.size() - UTF8_offset, needle.c_str(), needle.size()));
   if (unlikely(s == nullptr)) {
     return false;
   }
-  return mb_UTF8_get_offset(haystack.c_str() + UTF8_offset, s - (haystack.c_str() + UTF8_offset)) + offset;
+  const int64_t UTF8_pos = std::min<int64_t>(s - haystack.c_str(), mb_UTF8_cached_size(haystack));
+  return mb_UTF8_count(haystack.c_str() + UTF8_offset, UTF8_pos - UTF8_offset) + offset;
 }
 
 } // namespace
@@ -330,7 +482,7 @@ string f$mb_substr(const string &str, int64_t start, const mixed &length_var, co
     return res.val();
   }
 
-  int64_t len = mb_UTF8_strlen(str.c_str());
+  int64_t len = mb_UTF8_strlen(str);
   if (start < 0) {
     start += len;
   }
@@ -347,8 +499,8 @@ string f$mb_substr(const string &str, int64_t start, const mixed &length_var, co
     length = len - start;
   }
 
-  int64_t UTF8_start = mb_UTF8_advance(str.c_str(), start);
-  int64_t UTF8_length = mb_UTF8_advance(str.c_str() + UTF8_start, length);
+  int64_t UTF8_start = mb_UTF8_advance(str, start);
+  int64_t UTF8_end = mb_UTF8_advance(str, start + length);
 
-  return string(str.c_str() + UTF8_start, static_cast<string::size_type>(UTF8_length));
+  return string(str.c_str() + UTF8_start, static_cast<string::size_type>(UTF8_end - UTF8_start));
 }
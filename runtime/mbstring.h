@@ -10,6 +10,8 @@
 #include "runtime/string_functions.h"
 
 bool mb_UTF8_check(const char *s);
+// checks up to the first '\0' like the previous one, size is used only to read the string by words
+bool mb_UTF8_check(const char *s, size_t size);
 
 bool f$mb_check_encoding(const string &str, const string &encoding = CP1251);
 
@@ -24,3 +26,5 @@ Optional<int64_t> f$mb_strpos(const string &haystack, const string &needle, int6
 Optional<int64_t> f$mb_stripos(const string &haystack, const string &needle, int64_t offset = 0, const string &encoding = CP1251) noexcept;
 
 string f$mb_substr(const string &str, int64_t start, const mixed &length = std::numeric_limits<int64_t>::max(), const string &encoding = CP1251);
+
+void free_mbstring_lib();
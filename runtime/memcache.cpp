@@ -4,9 +4,11 @@
 
 #include "runtime/memcache.h"
 
+#include <cmath>
 #include <cstdlib>
 #include <ctime>
 
+#include "common/precise-time.h"
 #include "common/tl/constants/engine.h"
 #include "common/wrappers/gnu-builtins.h"
 
@@ -19,6 +21,7 @@ static_assert(TL_ENGINE_MC_GET_QUERY == ENGINE_MC_GET_QUERY, "bad ENGINE_MC_GET_
 #include "runtime/math_functions.h"
 #include "runtime/openssl.h"
 #include "runtime/regexp.h"
+#include "runtime/resumable.h"
 #include "runtime/serialize-functions.h"
 #include "runtime/string_functions.h"
 #include "runtime/zlib.h"
@@ -38,96 +41,14 @@ static const char *mc_last_key{nullptr};
 static int mc_last_key_len{0};
 static mixed mc_res;
 static bool mc_bool_res{false};
+// set by the rpc_mc_* functions if the query wasn't sent or wasn't answered
+static bool rpc_mc_failed{false};
 
 mixed rpc_mc_run_increment(int op, const class_instance<C$RpcConnection> &conn, const string &key, int64_t v, double timeout);
 bool rpc_mc_run_set(int32_t op, const class_instance<C$RpcConnection> &conn, const string &key, const mixed &value, int64_t flags, int64_t expire, double timeout);
 bool f$rpc_mc_delete(const class_instance<C$RpcConnection> &conn, const string &key, double timeout = -1.0, bool fake = false);
 mixed f$rpc_mc_get(const class_instance<C$RpcConnection> &conn, const string &key, double timeout = -1.0, bool fake = false);
 
-Optional<array<mixed>> f$rpc_mc_multiget(const class_instance<C$RpcConnection> &conn, const array<mixed> &keys, double timeout, bool fake = false) {
-  mc_method = "multiget";
-  resumable_finished = true;
-
-  array<string> query_names(array_size(keys.count(), 0, true));
-  int64_t queue_id = -1;
-  uint32_t keys_n = 0;
-  int64_t first_request_id = 0;
-  size_t bytes_sent = 0;
-  for (auto it = keys.begin(); it != keys.end(); ++it) {
-    const string key = f$strval(it.get_value());
-    const string real_key = mc_prepare_key(key);
-    const bool is_immediate = mc_is_immediate_query(real_key);
-
-    f$rpc_clean();
-    store_int(fake ? ENGINE_MC_GET_QUERY : MEMCACHE_GET);
-    store_string(real_key.c_str() + is_immediate, real_key.size() - is_immediate);
-
-    size_t current_sent_size = real_key.size() + 32;//estimate
-    bytes_sent += current_sent_size;
-    if (bytes_sent >= (1 << 15) && bytes_sent > current_sent_size) {
-      f$rpc_flush();
-      bytes_sent = current_sent_size;
-    }
-    int64_t request_id = rpc_send(conn, timeout, is_immediate);
-    if (request_id > 0) {
-      if (first_request_id == 0) {
-        first_request_id = request_id;
-      }
-      if (!is_immediate) {
-        queue_id = wait_queue_push_unsafe(queue_id, request_id);
-        keys_n++;
-      }
-      query_names.push_back(key);
-    } else {
-      return false;
-    }
-  }
-  if (bytes_sent > 0) {
-    f$rpc_flush();
-  }
-
-  if (queue_id == -1) {
-    return array<mixed>();
-  }
-
-  array<mixed> result(array_size(0, keys_n, false));
-
-  while (keys_n > 0) {
-    int64_t request_id = wait_queue_next_synchronously(queue_id).val();
-    if (request_id <= 0) {
-      break;
-    }
-    keys_n--;
-
-    int64_t k = request_id - first_request_id;
-    php_assert(static_cast<uint64_t>(k) < query_names.count());
-
-    bool parse_result = rpc_get_and_parse(request_id, -1);
-    php_assert (resumable_finished);
-    if (!parse_result) {
-      continue;
-    }
-
-    int32_t op = TRY_CALL(int32_t, bool, rpc_lookup_int());
-    if (op == MEMCACHE_ERROR) {
-      TRY_CALL_VOID(bool, rpc_fetch_int());//op
-      TRY_CALL_VOID(bool, f$fetch_long());//query_id
-      TRY_CALL_VOID(bool, rpc_fetch_int());
-      TRY_CALL_VOID(bool, f$fetch_string());
-    } else if (op == MEMCACHE_VALUE_NOT_FOUND) {
-      TRY_CALL_VOID(bool, rpc_fetch_int());//op
-    } else {
-      mixed q_result = TRY_CALL(mixed, bool, f$fetch_memcache_value());
-      result.set_value(query_names.get_value(k), q_result);
-    }
-
-    if (!f$fetch_eof()) {
-      php_warning("Not all data fetched during fetch memcache.Value");
-    }
-  }
-  return result;
-}
-
 const string mc_prepare_key(const string &key) {
   if (key.size() < 3) {
     php_warning("Very short key \"%s\" in Memcache::%s", key.c_str(), mc_method);
@@ -422,21 +343,127 @@ C$McMemcache::host::host() :
   host_num(-1),
   host_port(-1),
   host_weight(0),
-  timeout_ms(200) {
+  timeout_ms(200),
+  retry_interval(15),
+  host_hash(0) {
 }
 
-C$McMemcache::host::host(int32_t host_num, int32_t host_port, int32_t host_weight, int32_t timeout_ms) :
+C$McMemcache::host::host(int32_t host_num, int32_t host_port, int32_t host_weight, int32_t timeout_ms, int32_t retry_interval, int64_t host_hash) :
   host_num(host_num),
   host_port(host_port),
   host_weight(host_weight),
-  timeout_ms(timeout_ms) {
+  timeout_ms(timeout_ms),
+  retry_interval(retry_interval),
+  host_hash(host_hash) {
 }
 
+int64_t mc_host_hash(const string &host_name, int64_t port) {
+  return string_hash(host_name.c_str(), host_name.size()) ^ static_cast<int64_t>(port * 0x9e3779b97f4a7c15ULL);
+}
 
-C$McMemcache::host get_host(const array<C$McMemcache::host> &hosts) {
-  php_assert (hosts.count() > 0);
+static uint64_t mix_hash(uint64_t h) {
+  // splitmix64 finalizer
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
 
-  return hosts.get_value(f$array_rand(hosts));
+double mc_host_score(int64_t host_hash, int64_t host_weight, int64_t key_hash) {
+  const uint64_t h = mix_hash(mix_hash(static_cast<uint64_t>(key_hash)) ^ static_cast<uint64_t>(host_hash));
+  // u is uniformly distributed in (0, 1), so weight / -ln(u) chooses hosts proportionally to their weights
+  const double u = (static_cast<double>(h >> 11) + 0.5) / static_cast<double>(1ULL << 53);
+  return static_cast<double>(std::max(host_weight, int64_t{1})) / -std::log(u);
+}
+
+namespace {
+
+// The health of the memcache hosts lives in the worker between the requests.
+// After several consecutive failures a host is ejected for its retry interval, its keys are sent to the other hosts;
+// after the interval the host gets queries again and is ejected on the first failure until it answers.
+struct mc_host_health {
+  int32_t host_num{-1};
+  int32_t consecutive_failures{0};
+  double ejected_until{0};
+  int64_t queries{0};
+  int64_t hits{0};
+  int64_t misses{0};
+  int64_t failures{0};
+  int64_t ejections{0};
+  char name[64]{0};
+};
+
+constexpr int32_t MC_HOSTS_HEALTH_SIZE = 1024;
+constexpr int32_t MC_FAILURES_TO_EJECT = 3;
+constexpr int32_t MC_DEFAULT_RETRY_INTERVAL = 15;
+
+mc_host_health mc_hosts_health[MC_HOSTS_HEALTH_SIZE];
+
+mc_host_health *get_host_health(int32_t host_num) {
+  if (host_num < 0) {
+    return nullptr;
+  }
+  for (int32_t i = 0; i < MC_HOSTS_HEALTH_SIZE; ++i) {
+    mc_host_health &health = mc_hosts_health[(host_num + i) % MC_HOSTS_HEALTH_SIZE];
+    if (health.host_num == host_num) {
+      return &health;
+    }
+    if (health.host_num == -1) {
+      health.host_num = host_num;
+      return &health;
+    }
+  }
+  return nullptr;
+}
+
+void register_host(int32_t host_num, const string &host_name, int64_t port) {
+  if (mc_host_health *health = get_host_health(host_num)) {
+    if (!health->name[0]) {
+      snprintf(health->name, sizeof(health->name), "%s:%" PRIi64, host_name.c_str(), port);
+    }
+  }
+}
+
+bool is_host_available(int32_t host_num) {
+  const mc_host_health *health = get_host_health(host_num);
+  return !health || health->ejected_until <= get_utime_monotonic();
+}
+
+void register_host_answer(int32_t host_num, int64_t hits, int64_t misses) {
+  if (mc_host_health *health = get_host_health(host_num)) {
+    health->queries++;
+    health->hits += hits;
+    health->misses += misses;
+    health->consecutive_failures = 0;
+  }
+}
+
+void register_host_failure(int32_t host_num, int32_t retry_interval) {
+  if (mc_host_health *health = get_host_health(host_num)) {
+    health->queries++;
+    health->failures++;
+    if (++health->consecutive_failures >= MC_FAILURES_TO_EJECT) {
+      health->ejected_until = get_utime_monotonic() + retry_interval;
+      health->ejections++;
+    }
+  }
+}
+
+} // namespace
+
+static bool is_mc_host_available(const C$McMemcache::host &h) {
+  return is_host_available(h.host_num);
+}
+
+static C$McMemcache::host get_host(const array<C$McMemcache::host> &hosts, const string &real_key) {
+  return hosts.get_value(mc_choose_host(hosts, real_key.hash(), is_mc_host_available));
+}
+
+static void register_mc_result(const C$McMemcache::host &cur_host, bool answered, int64_t hits = 0, int64_t misses = 0) {
+  if (answered) {
+    register_host_answer(cur_host.host_num, hits, misses);
+  } else {
+    register_host_failure(cur_host.host_num, cur_host.retry_interval);
+  }
 }
 
 
@@ -484,14 +511,14 @@ static bool run_set(const class_instance<C$McMemcache> &mc, const string &key, c
                      << "\r\n";
 
   mc_bool_res = false;
-  auto cur_host = get_host(mc->hosts);
+  auto cur_host = get_host(mc->hosts, real_key);
   if (mc_is_immediate_query(real_key)) {
-    mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, nullptr);
+    register_mc_result(cur_host, mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, nullptr));
     return true;
   } else {
     mc_last_key = real_key.c_str();
     mc_last_key_len = (int)real_key.size();
-    mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, mc_set_callback);
+    register_mc_result(cur_host, mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, mc_set_callback));
     return mc_bool_res;
   }
 }
@@ -525,20 +552,20 @@ mixed run_increment(const class_instance<C$McMemcache> &mc, const string &key, c
   drivers_SB << "\r\n";
 
   mc_res = false;
-  auto cur_host = get_host(mc->hosts);
+  auto cur_host = get_host(mc->hosts, real_key);
   if (mc_is_immediate_query(real_key)) {
-    mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, nullptr);
+    register_mc_result(cur_host, mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, nullptr));
     return 0;
   } else {
     mc_last_key = real_key.c_str();
     mc_last_key_len = (int)real_key.size();
-    mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, mc_increment_callback);
+    register_mc_result(cur_host, mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, mc_increment_callback));
     return mc_res;
   }
 }
 
 bool f$McMemcache$$addServer(const class_instance<C$McMemcache> & mc, const string &host_name, int64_t port,
-                             bool persistent __attribute__((unused)), int64_t weight, double timeout, int64_t retry_interval __attribute__((unused)),
+                             bool persistent __attribute__((unused)), int64_t weight, double timeout, int64_t retry_interval,
                              bool status __attribute__((unused)), const mixed &failure_callback __attribute__((unused)), int64_t timeoutms) {
   int32_t result_timeout = static_cast<int32_t>(static_cast<int64_t>(timeout * 1000) + timeoutms);
 
@@ -549,9 +576,18 @@ bool f$McMemcache$$addServer(const class_instance<C$McMemcache> & mc, const stri
     result_timeout = MAX_TIMEOUT;
   }
 
+  if (retry_interval <= 0) {
+    retry_interval = MC_DEFAULT_RETRY_INTERVAL;
+  }
+  if (retry_interval >= MAX_TIMEOUT) {
+    retry_interval = MAX_TIMEOUT;
+  }
+
   int host_num = mc_connect_to(host_name.c_str(), static_cast<int32_t>(port));
   if (host_num >= 0) {
-    mc->hosts.push_back({host_num, static_cast<int32_t>(port), static_cast<int32_t>(weight), result_timeout});
+    register_host(host_num, host_name, port);
+    mc->hosts.push_back({host_num, static_cast<int32_t>(port), static_cast<int32_t>(weight), result_timeout,
+                         static_cast<int32_t>(retry_interval), mc_host_hash(host_name, port)});
   }
   return host_num >= 0;
 }
@@ -584,25 +620,37 @@ mixed f$McMemcache$$get(const class_instance<C$McMemcache> &v$this, const mixed
       return array<mixed>();
     }
 
-    drivers_SB.clean();
-    drivers_SB << "get";
-    bool is_immediate_query = true;
+    // the keys are split by their hosts, a query is sent to each host with its keys
+    array<array<string>> keys_by_host;
     for (array<mixed>::const_iterator p = key_var.begin(); p != key_var.end(); ++p) {
       const string key = p.get_value().to_string();
       const string real_key = mc_prepare_key(key);
-      drivers_SB << ' ' << real_key;
-      is_immediate_query = is_immediate_query && mc_is_immediate_query(real_key);
+      keys_by_host[mc_choose_host(v$this->hosts, real_key.hash(), is_mc_host_available)].push_back(real_key);
     }
-    drivers_SB << "\r\n";
 
     mc_res = array<mixed>(array_size(0, key_var.count(), false));
-    auto cur_host = get_host(v$this->hosts);
-    if (is_immediate_query) {
-      mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, nullptr); //TODO wrong if we have no mc_proxy
-    } else {
-      mc_last_key = drivers_SB.c_str();
-      mc_last_key_len = (int)drivers_SB.size();
-      mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, mc_multiget_callback); //TODO wrong if we have no mc_proxy
+    for (const auto &host_keys : keys_by_host) {
+      const array<string> &real_keys = host_keys.get_value();
+      drivers_SB.clean();
+      drivers_SB << "get";
+      bool is_immediate_query = true;
+      for (const auto &real_key : real_keys) {
+        drivers_SB << ' ' << real_key.get_value();
+        is_immediate_query = is_immediate_query && mc_is_immediate_query(real_key.get_value());
+      }
+      drivers_SB << "\r\n";
+
+      auto cur_host = v$this->hosts.get_value(host_keys.get_key());
+      if (is_immediate_query) {
+        register_mc_result(cur_host, mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, nullptr));
+      } else {
+        mc_last_key = drivers_SB.c_str();
+        mc_last_key_len = (int)drivers_SB.size();
+        const int64_t found_before = mc_res.as_array().count();
+        const bool answered = mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, mc_multiget_callback);
+        const int64_t hits = mc_res.as_array().count() - found_before;
+        register_mc_result(cur_host, answered, hits, real_keys.count() - hits);
+      }
     }
   } else {
     if (v$this->hosts.count() <= 0) {
@@ -615,15 +663,17 @@ mixed f$McMemcache$$get(const class_instance<C$McMemcache> &v$this, const mixed
 
     drivers_SB.clean() << "get " << real_key << "\r\n";
 
-    auto cur_host = get_host(v$this->hosts);
+    auto cur_host = get_host(v$this->hosts, real_key);
     if (mc_is_immediate_query(real_key)) {
       mc_res = true;
-      mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, nullptr);
+      register_mc_result(cur_host, mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, nullptr));
     } else {
       mc_res = false;
       mc_last_key = real_key.c_str();
       mc_last_key_len = (int)real_key.size();
-      mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, mc_get_callback);
+      const bool answered = mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, mc_get_callback);
+      const bool hit = !(mc_res.is_bool() && !mc_res.as_bool());
+      register_mc_result(cur_host, answered, hit, !hit);
     }
   }
   return mc_res;
@@ -641,14 +691,14 @@ bool f$McMemcache$$delete(const class_instance<C$McMemcache> &v$this,const strin
   drivers_SB.clean() << "delete " << real_key << "\r\n";
 
   mc_bool_res = false;
-  auto cur_host = get_host(v$this->hosts);
+  auto cur_host = get_host(v$this->hosts, real_key);
   if (mc_is_immediate_query(real_key)) {
-    mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, nullptr);
+    register_mc_result(cur_host, mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, nullptr));
     return true;
   } else {
     mc_last_key = real_key.c_str();
     mc_last_key_len = (int)real_key.size();
-    mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), cur_host.timeout_ms, 0, mc_delete_callback);
+    register_mc_result(cur_host, mc_run_query(cur_host.host_num, drivers_SB.c_str(), drivers_SB.size(), fork_deadline_timeout_ms(cur_host.timeout_ms), 0, mc_delete_callback));
     return mc_bool_res;
   }
 }
@@ -671,22 +721,128 @@ mixed f$McMemcache$$getVersion(const class_instance<C$McMemcache>& v$this) {
   }
 
   mc_res = false;
-  auto cur_host = get_host(v$this->hosts);
-  mc_run_query(cur_host.host_num, version_str, (int)strlen(version_str), cur_host.timeout_ms, 1, mc_version_callback);
+  auto cur_host = get_host(v$this->hosts, string());
+  register_mc_result(cur_host, mc_run_query(cur_host.host_num, version_str, (int)strlen(version_str), fork_deadline_timeout_ms(cur_host.timeout_ms), 1, mc_version_callback));
 
   return mc_res;
 }
 
 
-static C$RpcMemcache::host get_host(const array<C$RpcMemcache::host> &hosts) {
-  php_assert (hosts.count() > 0);
-  return hosts.get_value(f$array_rand(hosts));
+static bool is_rpc_host_available(const C$RpcMemcache::host &h) {
+  return is_host_available(h.conn.get()->host_num);
+}
+
+static C$RpcMemcache::host get_host(const array<C$RpcMemcache::host> &hosts, const string &real_key) {
+  return hosts.get_value(mc_choose_host(hosts, real_key.hash(), is_rpc_host_available));
+}
+
+static void register_rpc_mc_result(const C$RpcMemcache::host &cur_host, int64_t hits = 0, int64_t misses = 0) {
+  if (rpc_mc_failed) {
+    register_host_failure(cur_host.conn.get()->host_num, MC_DEFAULT_RETRY_INTERVAL);
+  } else {
+    register_host_answer(cur_host.conn.get()->host_num, hits, misses);
+  }
+}
+
+// each key is sent to its own host, all the queries are sent before waiting for the answers
+static Optional<array<mixed>> rpc_mc_run_multiget(const array<C$RpcMemcache::host> &hosts, const array<mixed> &keys, double timeout, bool fake) {
+  mc_method = "multiget";
+  resumable_finished = true;
+
+  array<string> query_names(array_size(keys.count(), 0, false));
+  array<int64_t> query_hosts(array_size(keys.count(), 0, false));
+  int64_t queue_id = -1;
+  uint32_t keys_n = 0;
+  size_t bytes_sent = 0;
+  bool all_sends_failed = true;
+  for (auto it = keys.begin(); it != keys.end(); ++it) {
+    const string key = f$strval(it.get_value());
+    const string real_key = mc_prepare_key(key);
+    const bool is_immediate = mc_is_immediate_query(real_key);
+    const int64_t host_id = mc_choose_host(hosts, real_key.hash(), is_rpc_host_available);
+    const C$RpcMemcache::host &cur_host = hosts.get_value(host_id);
+
+    f$rpc_clean();
+    store_int(fake ? ENGINE_MC_GET_QUERY : MEMCACHE_GET);
+    store_string(real_key.c_str() + is_immediate, real_key.size() - is_immediate);
+
+    size_t current_sent_size = real_key.size() + 32;//estimate
+    bytes_sent += current_sent_size;
+    if (bytes_sent >= (1 << 15) && bytes_sent > current_sent_size) {
+      f$rpc_flush();
+      bytes_sent = current_sent_size;
+    }
+    int64_t request_id = rpc_send(cur_host.conn, timeout, is_immediate);
+    if (request_id > 0) {
+      all_sends_failed = false;
+      if (!is_immediate) {
+        queue_id = wait_queue_push_unsafe(queue_id, request_id);
+        keys_n++;
+        query_names.set_value(request_id, key);
+        query_hosts.set_value(request_id, host_id);
+      }
+    } else {
+      register_host_failure(cur_host.conn.get()->host_num, MC_DEFAULT_RETRY_INTERVAL);
+    }
+  }
+  if (bytes_sent > 0) {
+    f$rpc_flush();
+  }
+
+  if (all_sends_failed && keys.count() > 0) {
+    return false;
+  }
+  if (queue_id == -1) {
+    return array<mixed>();
+  }
+
+  array<mixed> result(array_size(0, keys_n, false));
+
+  while (keys_n > 0) {
+    int64_t request_id = wait_queue_next_synchronously(queue_id).val();
+    if (request_id <= 0) {
+      break;
+    }
+    keys_n--;
+
+    php_assert(query_names.has_key(request_id));
+    const int32_t host_num = hosts.get_value(query_hosts.get_value(request_id)).conn.get()->host_num;
+
+    bool parse_result = rpc_get_and_parse(request_id, -1);
+    php_assert (resumable_finished);
+    if (!parse_result) {
+      register_host_failure(host_num, MC_DEFAULT_RETRY_INTERVAL);
+      continue;
+    }
+
+    int32_t op = TRY_CALL(int32_t, bool, rpc_lookup_int());
+    if (op == MEMCACHE_ERROR) {
+      TRY_CALL_VOID(bool, rpc_fetch_int());//op
+      TRY_CALL_VOID(bool, f$fetch_long());//query_id
+      TRY_CALL_VOID(bool, rpc_fetch_int());
+      TRY_CALL_VOID(bool, f$fetch_string());
+      register_host_answer(host_num, 0, 0);
+    } else if (op == MEMCACHE_VALUE_NOT_FOUND) {
+      TRY_CALL_VOID(bool, rpc_fetch_int());//op
+      register_host_answer(host_num, 0, 1);
+    } else {
+      mixed q_result = TRY_CALL(mixed, bool, f$fetch_memcache_value());
+      result.set_value(query_names.get_value(request_id), q_result);
+      register_host_answer(host_num, 1, 0);
+    }
+
+    if (!f$fetch_eof()) {
+      php_warning("Not all data fetched during fetch memcache.Value");
+    }
+  }
+  return result;
 }
 
 bool f$RpcMemcache$$rpc_connect(const class_instance<C$RpcMemcache> &v$this, const string &host_name, int64_t port, const mixed &default_actor_id, double timeout, double connect_timeout, double reconnect_timeout) {
   class_instance<C$RpcConnection> c = f$new_rpc_connection(host_name, port, default_actor_id, timeout, connect_timeout, reconnect_timeout);
   if (!c.is_null() && c.get()->host_num >= 0) {
-    auto h = C$RpcMemcache::host(std::move(c));
+    register_host(c.get()->host_num, host_name, port);
+    auto h = C$RpcMemcache::host(std::move(c), mc_host_hash(host_name, port));
     v$this->hosts.push_back(std::move(h));
     return true;
   }
@@ -715,9 +871,12 @@ bool f$RpcMemcache$$add(const class_instance<C$RpcMemcache> &v$this, const strin
   }
 
   const string real_key = mc_prepare_key(key);
-  auto cur_host = get_host(v$this->hosts);
+  auto cur_host = get_host(v$this->hosts, real_key);
   mc_method = "add";
-  return catchException(rpc_mc_run_set(v$this->fake ? TL_ENGINE_MC_ADD_QUERY : MEMCACHE_ADD, cur_host.conn, real_key, value, flags, expire, -1), false);
+  rpc_mc_failed = false;
+  const bool result = catchException(rpc_mc_run_set(v$this->fake ? TL_ENGINE_MC_ADD_QUERY : MEMCACHE_ADD, cur_host.conn, real_key, value, flags, expire, -1), false);
+  register_rpc_mc_result(cur_host);
+  return result;
 }
 
 bool f$RpcMemcache$$set(const class_instance<C$RpcMemcache> &v$this,const string &key, const mixed &value, int64_t flags, int64_t expire) {
@@ -727,9 +886,12 @@ bool f$RpcMemcache$$set(const class_instance<C$RpcMemcache> &v$this,const string
   }
 
   const string real_key = mc_prepare_key(key);
-  auto cur_host = get_host(v$this->hosts);
+  auto cur_host = get_host(v$this->hosts, real_key);
   mc_method = "set";
-  return catchException(rpc_mc_run_set(v$this->fake ? TL_ENGINE_MC_SET_QUERY : MEMCACHE_SET, cur_host.conn, real_key, value, flags, expire, -1), false);
+  rpc_mc_failed = false;
+  const bool result = catchException(rpc_mc_run_set(v$this->fake ? TL_ENGINE_MC_SET_QUERY : MEMCACHE_SET, cur_host.conn, real_key, value, flags, expire, -1), false);
+  register_rpc_mc_result(cur_host);
+  return result;
 }
 
 bool f$RpcMemcache$$replace(const class_instance<C$RpcMemcache> &v$this, const string &key, const mixed &value, int64_t flags, int64_t expire) {
@@ -739,9 +901,12 @@ bool f$RpcMemcache$$replace(const class_instance<C$RpcMemcache> &v$this, const s
   }
 
   const string real_key = mc_prepare_key(key);
-  auto cur_host = get_host(v$this->hosts);
+  auto cur_host = get_host(v$this->hosts, real_key);
   mc_method = "replace";
-  return catchException(rpc_mc_run_set(v$this->fake ? TL_ENGINE_MC_REPLACE_QUERY : MEMCACHE_REPLACE, cur_host.conn, real_key, value, flags, expire, -1.0), false);
+  rpc_mc_failed = false;
+  const bool result = catchException(rpc_mc_run_set(v$this->fake ? TL_ENGINE_MC_REPLACE_QUERY : MEMCACHE_REPLACE, cur_host.conn, real_key, value, flags, expire, -1.0), false);
+  register_rpc_mc_result(cur_host);
+  return result;
 }
 
 mixed f$RpcMemcache$$get(const class_instance<C$RpcMemcache> &mc, const mixed &key_var) {
@@ -751,8 +916,7 @@ mixed f$RpcMemcache$$get(const class_instance<C$RpcMemcache> &mc, const mixed &k
       return array<mixed>();
     }
 
-    auto cur_host = get_host(mc->hosts);
-    mixed res = f$rpc_mc_multiget(cur_host.conn, key_var.to_array(), -1.0, mc->fake);
+    mixed res = rpc_mc_run_multiget(mc->hosts, key_var.to_array(), -1.0, mc->fake);
     php_assert(resumable_finished);
     return catchException<mixed>(res, array<mixed>());
   } else {
@@ -764,8 +928,12 @@ mixed f$RpcMemcache$$get(const class_instance<C$RpcMemcache> &mc, const mixed &k
     const string key = key_var.to_string();
     const string real_key = mc_prepare_key(key);
 
-    auto cur_host = get_host(mc->hosts);
-    return catchException<mixed>(f$rpc_mc_get(cur_host.conn, real_key, -1.0, mc->fake), false);
+    auto cur_host = get_host(mc->hosts, real_key);
+    rpc_mc_failed = false;
+    mixed result = catchException<mixed>(f$rpc_mc_get(cur_host.conn, real_key, -1.0, mc->fake), false);
+    const bool hit = !(result.is_bool() && !result.as_bool());
+    register_rpc_mc_result(cur_host, hit, !hit);
+    return result;
   }
 }
 
@@ -776,8 +944,11 @@ bool f$RpcMemcache$$delete(const class_instance<C$RpcMemcache> &mc, const string
   }
 
   const string real_key = mc_prepare_key(key);
-  auto cur_host = get_host(mc->hosts);
-  return catchException(f$rpc_mc_delete(cur_host.conn, real_key, -1.0, mc->fake), false);
+  auto cur_host = get_host(mc->hosts, real_key);
+  rpc_mc_failed = false;
+  const bool result = catchException(f$rpc_mc_delete(cur_host.conn, real_key, -1.0, mc->fake), false);
+  register_rpc_mc_result(cur_host);
+  return result;
 }
 
 mixed f$RpcMemcache$$decrement(const class_instance<C$RpcMemcache> &v$this, const string &key, int64_t count) {
@@ -787,9 +958,12 @@ mixed f$RpcMemcache$$decrement(const class_instance<C$RpcMemcache> &v$this, cons
   }
 
   const string real_key = mc_prepare_key(key);
-  auto cur_host = get_host(v$this->hosts);
+  auto cur_host = get_host(v$this->hosts, real_key);
   mc_method = "decrement";
-  return catchException(rpc_mc_run_increment(v$this->fake ? TL_ENGINE_MC_DECR_QUERY : MEMCACHE_DECR, cur_host.conn, real_key, count, -1), false);
+  rpc_mc_failed = false;
+  mixed result = catchException(rpc_mc_run_increment(v$this->fake ? TL_ENGINE_MC_DECR_QUERY : MEMCACHE_DECR, cur_host.conn, real_key, count, -1), false);
+  register_rpc_mc_result(cur_host);
+  return result;
 }
 
 mixed f$RpcMemcache$$increment(const class_instance<C$RpcMemcache> &v$this, const string &key, int64_t count) {
@@ -799,9 +973,12 @@ mixed f$RpcMemcache$$increment(const class_instance<C$RpcMemcache> &v$this, cons
   }
 
   const string real_key = mc_prepare_key(key);
-  auto cur_host = get_host(v$this->hosts);
+  auto cur_host = get_host(v$this->hosts, real_key);
   mc_method = "increment";
-  return catchException(rpc_mc_run_increment(v$this->fake ? TL_ENGINE_MC_INCR_QUERY : MEMCACHE_INCR, cur_host.conn, real_key, count, -1.0), false);
+  rpc_mc_failed = false;
+  mixed result = catchException(rpc_mc_run_increment(v$this->fake ? TL_ENGINE_MC_INCR_QUERY : MEMCACHE_INCR, cur_host.conn, real_key, count, -1.0), false);
+  register_rpc_mc_result(cur_host);
+  return result;
 }
 
 mixed f$RpcMemcache$$getVersion(const class_instance<C$RpcMemcache>& mc) {
@@ -841,6 +1018,7 @@ mixed f$rpc_mc_get(const class_instance<C$RpcConnection> &conn, const string &ke
 
   int64_t request_id = rpc_send(conn, timeout, is_immediate);
   if (request_id <= 0) {
+    rpc_mc_failed = true;
     return false;
   }
   f$rpc_flush();
@@ -851,6 +1029,7 @@ mixed f$rpc_mc_get(const class_instance<C$RpcConnection> &conn, const string &ke
   wait_without_result_synchronously(request_id);
   if (!rpc_get_and_parse(request_id, timeout)) {
     php_assert (resumable_finished);
+    rpc_mc_failed = true;
     return false;
   }
 
@@ -907,6 +1086,7 @@ bool rpc_mc_run_set(int32_t op, const class_instance<C$RpcConnection> &conn, con
 
   int64_t request_id = rpc_send(conn, timeout, is_immediate);
   if (request_id <= 0) {
+    rpc_mc_failed = true;
     return false;
   }
   f$rpc_flush();
@@ -917,6 +1097,7 @@ bool rpc_mc_run_set(int32_t op, const class_instance<C$RpcConnection> &conn, con
   wait_without_result_synchronously(request_id);
   if (!rpc_get_and_parse(request_id, timeout)) {
     php_assert (resumable_finished);
+    rpc_mc_failed = true;
     return false;
   }
 
@@ -935,6 +1116,7 @@ mixed rpc_mc_run_increment(int op, const class_instance<C$RpcConnection> &conn,
 
   int64_t request_id = rpc_send(conn, timeout, is_immediate);
   if (request_id <= 0) {
+    rpc_mc_failed = true;
     return false;
   }
   f$rpc_flush();
@@ -945,6 +1127,7 @@ mixed rpc_mc_run_increment(int op, const class_instance<C$RpcConnection> &conn,
   wait_without_result_synchronously(request_id);
   if (!rpc_get_and_parse(request_id, timeout)) {
     php_assert (resumable_finished);
+    rpc_mc_failed = true;
     return false;
   }
 
@@ -967,6 +1150,7 @@ bool f$rpc_mc_delete(const class_instance<C$RpcConnection> &conn, const string &
 
   int64_t request_id = rpc_send(conn, timeout, is_immediate);
   if (request_id <= 0) {
+    rpc_mc_failed = true;
     return false;
   }
   f$rpc_flush();
@@ -977,6 +1161,7 @@ bool f$rpc_mc_delete(const class_instance<C$RpcConnection> &conn, const string &
   wait_without_result_synchronously(request_id);
   if (!rpc_get_and_parse(request_id, timeout)) {
     php_assert (resumable_finished);
+    rpc_mc_failed = true;
     return false;
   }
 
@@ -984,10 +1169,30 @@ bool f$rpc_mc_delete(const class_instance<C$RpcConnection> &conn, const string &
   return res == MEMCACHE_TRUE;
 }
 
+array<array<int64_t>> f$memcache_get_hosts_stats() {
+  array<array<int64_t>> result;
+  const double now = get_utime_monotonic();
+  for (const mc_host_health &health : mc_hosts_health) {
+    if (health.host_num == -1 || !health.name[0]) {
+      continue;
+    }
+    array<int64_t> host_stats(array_size(0, 6, false));
+    host_stats.set_value(string("queries"), health.queries);
+    host_stats.set_value(string("hits"), health.hits);
+    host_stats.set_value(string("misses"), health.misses);
+    host_stats.set_value(string("failures"), health.failures);
+    host_stats.set_value(string("ejections"), health.ejections);
+    host_stats.set_value(string("ejected"), health.ejected_until > now);
+    result.set_value(string(health.name), std::move(host_stats));
+  }
+  return result;
+}
+
 static void reset_drivers_global_vars() {
   hard_reset_var(mc_method);
   hard_reset_var(mc_bool_res);
   hard_reset_var(mc_res);
+  hard_reset_var(rpc_mc_failed);
 }
 
 void init_memcache_lib() {
@@ -24,6 +24,33 @@ mixed mc_get_value(const char *result_str, int32_t result_str_len, int64_t flags
 
 bool mc_is_immediate_query(const string &key);
 
+int64_t mc_host_hash(const string &host_name, int64_t port);
+
+// the weighted rendezvous hashing score of the host for the key
+double mc_host_score(int64_t host_hash, int64_t host_weight, int64_t key_hash);
+
+// Returns the index of the host with the maximum score for the key, so each key is always sent to the same host,
+// the keys are distributed proportionally to the host weights and removing a host remaps only the keys of that host.
+// Unavailable (ejected) hosts are skipped, unless all the hosts are unavailable.
+template<class HostT, class IsAvailableT>
+int64_t mc_choose_host(const array<HostT> &hosts, int64_t key_hash, const IsAvailableT &is_available) {
+  php_assert(hosts.count() > 0);
+  int64_t chosen = -1;
+  double chosen_score = 0;
+  bool chosen_is_available = false;
+  for (auto it = hosts.begin(); it != hosts.end(); ++it) {
+    const HostT &host = it.get_value();
+    const bool host_is_available = is_available(host);
+    const double score = mc_host_score(host.host_hash, host.host_weight, key_hash);
+    if (chosen == -1 || (host_is_available && !chosen_is_available) || (host_is_available == chosen_is_available && score > chosen_score)) {
+      chosen = it.get_key().to_int();
+      chosen_score = score;
+      chosen_is_available = host_is_available;
+    }
+  }
+  return chosen;
+}
+
 
 constexpr int64_t MEMCACHE_SERIALIZED = 1;
 constexpr int64_t MEMCACHE_COMPRESSED = 2;
@@ -43,9 +70,11 @@ public:
     int32_t host_port;
     int32_t host_weight;
     int32_t timeout_ms;
+    int32_t retry_interval;
+    int64_t host_hash;
 
     host();
-    host(int32_t host_num, int32_t host_port, int32_t host_weight, int32_t timeout_ms);
+    host(int32_t host_num, int32_t host_port, int32_t host_weight, int32_t timeout_ms, int32_t retry_interval, int64_t host_hash);
   };
 
   void accept(InstanceMemoryEstimateVisitor &visitor) final {
@@ -72,10 +101,13 @@ public:
   class host {
   public:
     class_instance<C$RpcConnection> conn;
+    int64_t host_weight{1};
+    int64_t host_hash{0};
 
     host() = default;
-    explicit host(class_instance<C$RpcConnection> &&c) :
-      conn(std::move(c)) {}
+    host(class_instance<C$RpcConnection> &&c, int64_t host_hash) :
+      conn(std::move(c)),
+      host_hash(host_hash) {}
   };
 
   void accept(InstanceMemoryEstimateVisitor &visitor) final {
@@ -126,6 +158,9 @@ mixed f$RpcMemcache$$decrement(const class_instance<C$RpcMemcache> &v$this, cons
 mixed f$RpcMemcache$$increment(const class_instance<C$RpcMemcache> &v$this, const string &key, int64_t count = 1);
 mixed f$RpcMemcache$$getVersion(const class_instance<C$RpcMemcache>& v$this);
 
+// per worker statistics of the memcache hosts: 'host:port' => [queries, hits, misses, failures, ejections, ejected]
+array<array<int64_t>> f$memcache_get_hosts_stats();
+
 /*
  *
  *     IMPLEMENTATION
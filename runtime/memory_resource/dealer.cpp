@@ -8,7 +8,7 @@ namespace memory_resource {
 
 Dealer::Dealer() noexcept :
   current_script_resource_(&default_script_resource_) {
-  set_script_resource_replacer(heap_resource_);
+  set_script_resource_replacer(global_init_resource_);
 }
 
 } // namespace memory_resource
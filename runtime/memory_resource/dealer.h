@@ -3,6 +3,7 @@
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 
 #pragma once
+#include "runtime/memory_resource/global_init_resource.h"
 #include "runtime/memory_resource/heap_resource.h"
 #include "runtime/memory_resource/unsynchronized_pool_resource.h"
 
@@ -12,7 +13,7 @@ class Dealer {
 public:
   Dealer() noexcept;
 
-  void set_script_resource_replacer(heap_resource &heap_replacer) noexcept {
+  void set_script_resource_replacer(global_init_resource &heap_replacer) noexcept {
     php_assert(!heap_replacer_);
     heap_replacer_ = &heap_replacer;
   }
@@ -31,13 +32,18 @@ public:
 
   void drop_replacer() noexcept {
     php_assert(heap_replacer_);
+    heap_replacer_->freeze();
     heap_replacer_ = nullptr;
   }
 
-  heap_resource *heap_script_resource_replacer() const noexcept {
+  global_init_resource *heap_script_resource_replacer() const noexcept {
     return heap_replacer_;
   }
 
+  const global_init_resource &get_global_init_resource() const noexcept {
+    return global_init_resource_;
+  }
+
   heap_resource &get_heap_resource() noexcept {
     return heap_resource_;
   }
@@ -48,10 +54,11 @@ public:
 
 private:
   heap_resource heap_resource_;
+  global_init_resource global_init_resource_{heap_resource_};
   unsynchronized_pool_resource default_script_resource_;
 
   unsynchronized_pool_resource *current_script_resource_{nullptr};
-  memory_resource::heap_resource *heap_replacer_{nullptr};
+  global_init_resource *heap_replacer_{nullptr};
 };
 
 } // namespace memory_resource
@@ -0,0 +1,88 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/memory_resource/global_init_resource.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "runtime/critical_section.h"
+
+namespace memory_resource {
+
+constexpr size_t global_init_resource::MAPPING_SIZE_;
+
+void *global_init_resource::allocate(size_t size) noexcept {
+  if (!can_allocate(size)) {
+    return heap_.allocate(size);
+  }
+  dl::CriticalSectionGuard lock;
+  return pool_.allocate(size);
+}
+
+void *global_init_resource::allocate0(size_t size) noexcept {
+  if (!can_allocate(size)) {
+    return heap_.allocate0(size);
+  }
+  dl::CriticalSectionGuard lock;
+  return pool_.allocate0(size);
+}
+
+void *global_init_resource::reallocate(void *mem, size_t new_size, size_t old_size) noexcept {
+  if (!contains(mem)) {
+    return heap_.reallocate(mem, new_size, old_size);
+  }
+  if (can_allocate(new_size)) {
+    dl::CriticalSectionGuard lock;
+    return pool_.reallocate(mem, new_size, old_size);
+  }
+  void *new_mem = heap_.allocate(new_size);
+  if (new_mem) {
+    memcpy(new_mem, mem, old_size);
+    deallocate(mem, old_size);
+  }
+  return new_mem;
+}
+
+void global_init_resource::deallocate(void *mem, size_t size) noexcept {
+  if (!contains(mem)) {
+    heap_.deallocate(mem, size);
+    return;
+  }
+  dl::CriticalSectionGuard lock;
+  pool_.deallocate(mem, size);
+}
+
+void global_init_resource::freeze() noexcept {
+  frozen_ = true;
+  if (!mapping_begin_) {
+    return;
+  }
+  const auto page_size = static_cast<size_t>(getpagesize());
+  const size_t touched_size = (get_memory_stats().max_real_memory_used + page_size - 1) / page_size * page_size;
+  if (touched_size < mapping_size_ && munmap(mapping_begin_ + touched_size, mapping_size_ - touched_size) == 0) {
+    mapping_size_ = touched_size;
+  }
+}
+
+bool global_init_resource::can_allocate(size_t size) noexcept {
+  return !frozen_ && (mapping_begin_ || reserve()) && pool_.is_enough_memory_for(size);
+}
+
+bool global_init_resource::reserve() noexcept {
+  if (reserve_failed_) {
+    return false;
+  }
+  void *mem = mmap(nullptr, MAPPING_SIZE_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mem == MAP_FAILED) {
+    reserve_failed_ = true;
+    return false;
+  }
+  mapping_begin_ = static_cast<char *>(mem);
+  mapping_size_ = MAPPING_SIZE_;
+  pool_.init(mapping_begin_, mapping_size_);
+  return true;
+}
+
+} // namespace memory_resource
@@ -0,0 +1,53 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "runtime/memory_resource/heap_resource.h"
+#include "runtime/memory_resource/unsynchronized_pool_resource.h"
+
+namespace memory_resource {
+
+// The resource for the allocations made before the first script run: global constants, runtime libs data, etc.
+// It happens in the master process, and the workers inherit this memory after the fork.
+// It is placed into a separate mapping, so its pages are not mixed up with the heap pages written after the fork,
+// and they stay shared between all the workers. If the mapping can't be reserved or is exhausted, the heap is used.
+class global_init_resource {
+public:
+  explicit global_init_resource(heap_resource &heap) noexcept :
+    heap_(heap) {}
+
+  void *allocate(size_t size) noexcept;
+  void *allocate0(size_t size) noexcept;
+  void *reallocate(void *mem, size_t new_size, size_t old_size) noexcept;
+  void deallocate(void *mem, size_t size) noexcept;
+
+  // no allocations are expected after the freeze, the untouched part of the mapping is released
+  void freeze() noexcept;
+
+  const MemoryStats &get_memory_stats() const noexcept {
+    return pool_.get_memory_stats();
+  }
+
+private:
+  bool can_allocate(size_t size) noexcept;
+  bool reserve() noexcept;
+
+  bool contains(const void *mem) const noexcept {
+    return mapping_begin_ <= static_cast<const char *>(mem) && static_cast<const char *>(mem) < mapping_begin_ + mapping_size_;
+  }
+
+  // only the touched pages are really allocated
+  static constexpr size_t MAPPING_SIZE_{1u << 30u};
+
+  heap_resource &heap_;
+  unsynchronized_pool_resource pool_;
+
+  char *mapping_begin_{nullptr};
+  size_t mapping_size_{0};
+  bool reserve_failed_{false};
+  bool frozen_{false};
+};
+
+} // namespace memory_resource
@@ -26,8 +26,11 @@ void MemoryStats::write_stats_to(stats_t *stats, const char *prefix) const noexc
   write_stat(stats, prefix, "memory.real_used", real_memory_used);
   write_stat(stats, prefix, "memory.real_used_max", max_real_memory_used);
   write_stat(stats, prefix, "memory.defragmentation_calls", defragmentation_calls);
+  write_stat(stats, prefix, "memory.huge_pieces_coalescing_calls", huge_pieces_coalescing_calls);
+  write_stat(stats, prefix, "memory.defragmentation_time_ns", defragmentation_time_ns);
   write_stat(stats, prefix, "memory.huge_memory_pieces", huge_memory_pieces);
   write_stat(stats, prefix, "memory.small_memory_pieces", small_memory_pieces);
+  write_stat(stats, prefix, "memory.sampled_allocations", sampled_allocations);
 }
 
 } // namespace memory_resource
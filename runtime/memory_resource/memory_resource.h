@@ -42,6 +42,8 @@ public:
   size_t memory_limit{0}; // size of memory arena
 
   size_t defragmentation_calls{0}; // the number of defragmentation process calls
+  size_t huge_pieces_coalescing_calls{0}; // the number of huge pieces coalescing calls (cheaper than defragmentation)
+  size_t defragmentation_time_ns{0}; // the total time spent on defragmentation and coalescing
 
   size_t huge_memory_pieces{0}; // the number of huge memory pirces (in rb tree)
   size_t small_memory_pieces{0}; // the number of small memory pieces (in lists)
@@ -49,6 +51,8 @@ public:
   size_t total_allocations{0}; // the total number of allocations
   size_t total_memory_allocated{0}; // the total amount of the memory allocated (doesn't take the freed memory into the account)
 
+  size_t sampled_allocations{0}; // the number of sampling points hit by the allocation sampler
+
   void write_stats_to(stats_t *stats, const char *prefix) const noexcept;
 };
 
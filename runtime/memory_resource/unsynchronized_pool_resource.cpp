@@ -4,11 +4,20 @@
 
 #include "runtime/memory_resource/unsynchronized_pool_resource.h"
 
+#include <chrono>
+
 #include "common/wrappers/likely.h"
 
 #include "runtime/memory_resource/details/memory_ordered_chunk_list.h"
 
 namespace memory_resource {
+namespace {
+
+size_t nanoseconds_since(std::chrono::steady_clock::time_point start) noexcept {
+  return static_cast<size_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
 
 constexpr size_t unsynchronized_pool_resource::MAX_CHUNK_BLOCK_SIZE_;
 
@@ -22,13 +31,10 @@ void unsynchronized_pool_resource::init(void *buffer, size_t buffer_size) noexce
 
 void unsynchronized_pool_resource::perform_defragmentation() noexcept {
   memory_debug("perform memory defragmentation\n");
+  const auto start = std::chrono::steady_clock::now();
   details::memory_ordered_chunk_list mem_list{memory_begin_};
 
-  huge_pieces_.flush_to(mem_list);
-  if (const size_t fallback_resource_left_size = fallback_resource_.size()) {
-    mem_list.add_memory(fallback_resource_.memory_current(), fallback_resource_left_size);
-    fallback_resource_.init(nullptr, 0);
-  }
+  flush_huge_pieces_to(mem_list);
 
   // chunk_id == 0 ignored, because it always empty and unused
   php_assert(free_chunks_[0].get_mem() == nullptr);
@@ -40,16 +46,59 @@ void unsynchronized_pool_resource::perform_defragmentation() noexcept {
   }
 
   stats_.small_memory_pieces = 0;
+  put_memory_back_from(mem_list);
+
+  // update stat
+  register_deallocation(0);
+  ++stats_.defragmentation_calls;
+  stats_.defragmentation_time_ns += nanoseconds_since(start);
+}
+
+void unsynchronized_pool_resource::coalesce_huge_pieces() noexcept {
+  memory_debug("coalesce huge memory pieces\n");
+  const auto start = std::chrono::steady_clock::now();
+  details::memory_ordered_chunk_list mem_list{memory_begin_};
+
+  // the small pieces are left as is, so the cost depends on the number of the huge pieces only
+  flush_huge_pieces_to(mem_list);
+  put_memory_back_from(mem_list);
+
+  register_deallocation(0);
+  ++stats_.huge_pieces_coalescing_calls;
+  stats_.defragmentation_time_ns += nanoseconds_since(start);
+}
+
+void unsynchronized_pool_resource::flush_huge_pieces_to(details::memory_ordered_chunk_list &mem_list) noexcept {
+  huge_pieces_.flush_to(mem_list);
   stats_.huge_memory_pieces = 0;
+  if (const size_t fallback_resource_left_size = fallback_resource_.size()) {
+    mem_list.add_memory(fallback_resource_.memory_current(), fallback_resource_left_size);
+    fallback_resource_.init(nullptr, 0);
+  }
+}
+
+void unsynchronized_pool_resource::put_memory_back_from(details::memory_ordered_chunk_list &mem_list) noexcept {
   for (auto *free_mem = mem_list.flush(); free_mem;) {
     const auto next_mem = mem_list.get_next(free_mem);
     put_memory_back(free_mem, free_mem->size());
     free_mem = next_mem;
   }
+}
 
-  // update stat
-  register_deallocation(0);
-  ++stats_.defragmentation_calls;
+void unsynchronized_pool_resource::set_allocation_sampler(allocation_sampler sampler, size_t sampling_period) noexcept {
+  php_assert(!sampler || sampling_period);
+  allocation_sampler_ = sampler;
+  sampling_period_ = sampler ? sampling_period : 0;
+  bytes_until_sample_ = sampler ? sampling_period : std::numeric_limits<size_t>::max();
+}
+
+void unsynchronized_pool_resource::sample_allocation(size_t aligned_size) noexcept {
+  // a huge allocation may cover several sampling points
+  const size_t bytes_after_sample = aligned_size - bytes_until_sample_;
+  const size_t samples = 1 + bytes_after_sample / sampling_period_;
+  bytes_until_sample_ = sampling_period_ - bytes_after_sample % sampling_period_;
+  stats_.sampled_allocations += samples;
+  allocation_sampler_(samples * sampling_period_);
 }
 
 void *unsynchronized_pool_resource::allocate_small_piece_from_fallback_resource(size_t aligned_size) noexcept {
@@ -79,6 +128,13 @@ void *unsynchronized_pool_resource::allocate_small_piece_from_fallback_resource(
 
 void *unsynchronized_pool_resource::perform_defragmentation_and_allocate_huge_piece(size_t aligned_size) noexcept {
   // the body of this function is moved to the cpp file intentionally, so it doesn't get inlined into the allocate method
+  // the arrays growing by doubling leave adjacent huge pieces, try to coalesce them first without the full defragmentation
+  if (stats_.huge_memory_pieces || fallback_resource_.size()) {
+    coalesce_huge_pieces();
+    if (void *mem = allocate_huge_piece(aligned_size, true)) {
+      return mem;
+    }
+  }
   perform_defragmentation();
   return allocate_huge_piece(aligned_size, false);
 }
@@ -15,6 +15,9 @@
 
 namespace memory_resource {
 
+// called on each sampled allocation, sampled_bytes is a multiple of the sampling period
+using allocation_sampler = void (*)(size_t sampled_bytes);
+
 class unsynchronized_pool_resource : private monotonic_buffer_resource {
 public:
   using monotonic_buffer_resource::try_expand;
@@ -39,6 +42,14 @@ public:
     }
 
     register_allocation(mem, aligned_size);
+    if (unlikely(aligned_size >= bytes_until_sample_)) {
+      // the failed allocation isn't sampled, it will be sampled by the next one
+      if (mem) {
+        sample_allocation(aligned_size);
+      }
+    } else {
+      bytes_until_sample_ -= aligned_size;
+    }
     return mem;
   }
 
@@ -65,6 +76,10 @@ public:
 
   void perform_defragmentation() noexcept;
 
+  // every sampling_period-th allocated byte is sampled, so the allocations are sampled proportionally to their sizes;
+  // nullptr sampler disables the sampling
+  void set_allocation_sampler(allocation_sampler sampler, size_t sampling_period) noexcept;
+
   bool is_enough_memory_for(size_t size) const noexcept {
     const auto aligned_size = details::align_for_chunk(size);
     // not using free_chunks_ here as the real size can be smaller
@@ -102,8 +117,12 @@ private:
     return mem;
   }
 
+  void sample_allocation(size_t aligned_size) noexcept;
   void *allocate_small_piece_from_fallback_resource(size_t aligned_size) noexcept;
   void *perform_defragmentation_and_allocate_huge_piece(size_t aligned_size) noexcept;
+  void coalesce_huge_pieces() noexcept;
+  void flush_huge_pieces_to(details::memory_ordered_chunk_list &mem_list) noexcept;
+  void put_memory_back_from(details::memory_ordered_chunk_list &mem_list) noexcept;
 
   void put_memory_back(void *mem, size_t size) noexcept {
     if (!monotonic_buffer_resource::put_memory_back(mem, size)) {
@@ -123,6 +142,10 @@ private:
 
   static constexpr size_t MAX_CHUNK_BLOCK_SIZE_{16u * 1024u};
   std::array<details::memory_chunk_list, details::get_chunk_id(MAX_CHUNK_BLOCK_SIZE_)> free_chunks_;
+
+  allocation_sampler allocation_sampler_{nullptr};
+  size_t sampling_period_{0};
+  size_t bytes_until_sample_{std::numeric_limits<size_t>::max()};
 };
 
 } // namespace memory_resource
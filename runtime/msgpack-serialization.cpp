@@ -15,3 +15,260 @@ size_t CheckInstanceDepth::depth = 0;
 } // namespace adaptor
 } // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
 } // namespace msgpack
+
+namespace {
+
+// The raw msgpack reader, which walks over the packed values without unpacking them
+class MsgpackRawReader {
+public:
+  enum class Kind {
+    SCALAR,
+    INTEGER,
+    STRING,
+    ARRAY,
+    MAP
+  };
+
+  struct Header {
+    Kind kind{Kind::SCALAR};
+    // the number of the nested values for arrays and maps
+    uint64_t items{0};
+    // the value of integers
+    int64_t int_value{0};
+    // the bytes of strings, bin and ext values
+    const char *payload{nullptr};
+    size_t payload_len{0};
+  };
+
+  MsgpackRawReader(const char *data, size_t size) noexcept :
+    data_(data),
+    size_(size) {}
+
+  size_t pos() const noexcept {
+    return pos_;
+  }
+
+  // reads the header of the value at the current position and moves over its payload, but not over the nested values
+  bool read_header(Header &h) noexcept {
+    h = Header{};
+    if (pos_ >= size_) {
+      return false;
+    }
+    const auto type = static_cast<uint8_t>(data_[pos_++]);
+    if (type <= 0x7f) {
+      h.kind = Kind::INTEGER;
+      h.int_value = type;
+      return true;
+    }
+    if (type >= 0xe0) {
+      h.kind = Kind::INTEGER;
+      h.int_value = static_cast<int8_t>(type);
+      return true;
+    }
+    if (type <= 0x8f) {
+      h.kind = Kind::MAP;
+      h.items = 2 * (type & 0x0f);
+      return true;
+    }
+    if (type <= 0x9f) {
+      h.kind = Kind::ARRAY;
+      h.items = type & 0x0f;
+      return true;
+    }
+    if (type <= 0xbf) {
+      h.kind = Kind::STRING;
+      return read_payload(type & 0x1f, h);
+    }
+
+    uint64_t len = 0;
+    switch (type) {
+      case 0xc0: // nil
+      case 0xc2: // false
+      case 0xc3: // true
+        return true;
+      case 0xc4: // bin 8, 16, 32
+      case 0xc5:
+      case 0xc6:
+        return read_uint(1 << (type - 0xc4), len) && read_payload(len, h);
+      case 0xc7: // ext 8, 16, 32
+      case 0xc8:
+      case 0xc9:
+        return read_uint(1 << (type - 0xc7), len) && read_payload(len + 1, h);
+      case 0xca: // float 32
+        return read_payload(4, h);
+      case 0xcb: // float 64
+        return read_payload(8, h);
+      case 0xcc: // uint 8, 16, 32, 64
+      case 0xcd:
+      case 0xce:
+      case 0xcf:
+        h.kind = Kind::INTEGER;
+        if (!read_uint(1 << (type - 0xcc), len)) {
+          return false;
+        }
+        h.int_value = static_cast<int64_t>(len);
+        return true;
+      case 0xd0: // int 8, 16, 32, 64
+      case 0xd1:
+      case 0xd2:
+      case 0xd3: {
+        h.kind = Kind::INTEGER;
+        const int bytes = 1 << (type - 0xd0);
+        if (!read_uint(bytes, len)) {
+          return false;
+        }
+        // sign extension
+        const int shift = 64 - 8 * bytes;
+        h.int_value = static_cast<int64_t>(len << shift) >> shift;
+        return true;
+      }
+      case 0xd4: // fixext 1, 2, 4, 8, 16
+      case 0xd5:
+      case 0xd6:
+      case 0xd7:
+      case 0xd8:
+        return read_payload((1 << (type - 0xd4)) + 1, h);
+      case 0xd9: // str 8, 16, 32
+      case 0xda:
+      case 0xdb:
+        h.kind = Kind::STRING;
+        return read_uint(1 << (type - 0xd9), len) && read_payload(len, h);
+      case 0xdc: // array 16, 32
+      case 0xdd:
+        h.kind = Kind::ARRAY;
+        return read_uint(2 << (type - 0xdc), h.items);
+      case 0xde: // map 16, 32
+      case 0xdf:
+        h.kind = Kind::MAP;
+        if (!read_uint(2 << (type - 0xde), h.items)) {
+          return false;
+        }
+        h.items *= 2;
+        return true;
+      default: // 0xc1 is never used
+        return false;
+    }
+  }
+
+  // moves over the values at the current position with all their nested values
+  bool skip_values(uint64_t count) noexcept {
+    uint64_t pending = count;
+    Header h;
+    while (pending) {
+      if (!read_header(h)) {
+        return false;
+      }
+      pending = pending - 1 + h.items;
+      // each nested value takes at least one byte, it protects from the huge fake counters
+      if (pending > size_ - pos_) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool skip_value() noexcept {
+    return skip_values(1);
+  }
+
+private:
+  bool read_uint(int bytes, uint64_t &value) noexcept {
+    if (size_ - pos_ < static_cast<size_t>(bytes)) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < bytes; ++i) {
+      value = (value << 8) | static_cast<uint8_t>(data_[pos_++]);
+    }
+    return true;
+  }
+
+  bool read_payload(uint64_t len, Header &h) noexcept {
+    if (size_ - pos_ < len) {
+      return false;
+    }
+    h.payload = data_ + pos_;
+    h.payload_len = len;
+    pos_ += len;
+    return true;
+  }
+
+  const char *data_{nullptr};
+  size_t size_{0};
+  size_t pos_{0};
+};
+
+// the map keys are compared like the php array keys: the numeric strings are the same as the integers
+bool msgpack_key_matches(const MsgpackRawReader::Header &key, const mixed &path_key) noexcept {
+  int64_t int_key = 0;
+  if (path_key.is_string() && !path_key.as_string().try_to_int(&int_key)) {
+    return key.kind == MsgpackRawReader::Kind::STRING && path_key.as_string() == string(key.payload, static_cast<string::size_type>(key.payload_len));
+  }
+  if (!path_key.is_string()) {
+    int_key = path_key.to_int();
+  }
+  if (key.kind == MsgpackRawReader::Kind::INTEGER) {
+    return key.int_value == int_key;
+  }
+  int64_t key_as_int = 0;
+  return key.kind == MsgpackRawReader::Kind::STRING
+         && php_try_to_int(key.payload, key.payload_len, &key_as_int) && key_as_int == int_key;
+}
+
+} // namespace
+
+mixed msgpack_deserialize_path(const string &buffer, const array<mixed> &path) noexcept {
+  MsgpackRawReader reader{buffer.c_str(), buffer.size()};
+  MsgpackRawReader::Header h;
+  for (const auto &it : path) {
+    const mixed &path_key = it.get_value();
+    if (!reader.read_header(h)) {
+      php_warning("Malformed msgpack buffer in msgpack_deserialize_path");
+      return {};
+    }
+
+    bool found = false;
+    if (h.kind == MsgpackRawReader::Kind::ARRAY) {
+      int64_t index = 0;
+      if (path_key.is_string() && !path_key.as_string().try_to_int(&index)) {
+        return {};
+      }
+      if (!path_key.is_string()) {
+        index = path_key.to_int();
+      }
+      if (index < 0 || static_cast<uint64_t>(index) >= h.items) {
+        return {};
+      }
+      for (int64_t i = 0; i < index; ++i) {
+        if (!reader.skip_value()) {
+          php_warning("Malformed msgpack buffer in msgpack_deserialize_path");
+          return {};
+        }
+      }
+      found = true;
+    } else if (h.kind == MsgpackRawReader::Kind::MAP) {
+      MsgpackRawReader::Header key;
+      for (uint64_t i = 0; i < h.items / 2 && !found; ++i) {
+        if (!reader.read_header(key)) {
+          php_warning("Malformed msgpack buffer in msgpack_deserialize_path");
+          return {};
+        }
+        found = key.items == 0 && msgpack_key_matches(key, path_key);
+        if (!found && !(reader.skip_values(key.items) && reader.skip_value())) {
+          php_warning("Malformed msgpack buffer in msgpack_deserialize_path");
+          return {};
+        }
+      }
+    }
+    if (!found) {
+      return {};
+    }
+  }
+
+  const size_t value_begin = reader.pos();
+  if (!reader.skip_value()) {
+    php_warning("Malformed msgpack buffer in msgpack_deserialize_path");
+    return {};
+  }
+  return msgpack_deserialize_buffer<mixed>(buffer.c_str() + value_begin, reader.pos() - value_begin, nullptr);
+}
@@ -6,9 +6,8 @@
 
 #include <msgpack.hpp>
 
-#include "common/containers/final_action.h"
-
 #include "runtime/critical_section.h"
+#include "runtime/cycle-attribution.h"
 #include "runtime/exception.h"
 #include "runtime/interface.h"
 #include "runtime/kphp_core.h"
@@ -350,20 +349,35 @@ struct pack<class_instance<T>> {
 } // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
 } // namespace msgpack
 
-template<class T>
-inline Optional<string> f$msgpack_serialize(const T &value, string *out_err_msg = nullptr) noexcept {
-  f$ob_start();
-  php_assert(f$ob_get_length().has_value() && f$ob_get_length().val() == 0);
+// the stream for the first packing pass, which only computes the packed size
+struct MsgpackSizeCounter {
+  size_t size{0};
+
+  void write(const char *, size_t len) noexcept {
+    size += len;
+  }
+};
 
-  string_buffer::string_buffer_error_flag = STRING_BUFFER_ERROR_FLAG_ON;
-  auto clean_buffer = vk::finally([] {
-    f$ob_end_clean();
-    string_buffer::string_buffer_error_flag = STRING_BUFFER_ERROR_FLAG_OFF;
-  });
+// the stream for the second packing pass, which writes into the string allocated with the exact size
+struct MsgpackStringWriter {
+  char *pos{nullptr};
+  const char *end{nullptr};
 
-  msgpack::pack(*coub, value);
+  void write(const char *buf, size_t len) noexcept {
+    php_assert(len <= static_cast<size_t>(end - pos));
+    memcpy(pos, buf, len);
+    pos += len;
+  }
+};
+
+// the value is packed twice: the first pass computes the size, so the result is allocated once and isn't copied
+template<class T>
+inline Optional<string> f$msgpack_serialize(const T &value, string *out_err_msg = nullptr) noexcept {
+  CycleAttributionScope cycle_attribution{CycleSubsystem::serialization};
+  MsgpackSizeCounter counter;
+  msgpack::pack(counter, value);
 
-  if (string_buffer::string_buffer_error_flag == STRING_BUFFER_ERROR_FLAG_FAILED) {
+  if (counter.size >= string_buffer::MAX_BUFFER_LEN) {
     string err_msg{"msgpacke_serialize buffer overflow"};
     if (out_err_msg) {
       *out_err_msg = std::move(err_msg);
@@ -372,8 +386,16 @@ inline Optional<string> f$msgpack_serialize(const T &value, string *out_err_msg
     }
     return {};
   }
+  if (msgpack::adaptor::CheckInstanceDepth::is_exceeded()) {
+    // the caller reports it, the result is useless anyway
+    return string{};
+  }
 
-  return coub->str();
+  string result{static_cast<string::size_type>(counter.size), false};
+  MsgpackStringWriter writer{result.buffer(), result.c_str() + counter.size};
+  msgpack::pack(writer, value);
+  php_assert(writer.pos == writer.end);
+  return result;
 }
 
 template<class T>
@@ -412,21 +434,22 @@ inline Optional<string> f$instance_serialize(const class_instance<InstanceClass>
  * https://monoinfinito.wordpress.com/series/exception-handling-in-c/
  */
 template<class ResultType = mixed>
-inline ResultType f$msgpack_deserialize(const string &buffer, string *out_err_msg = nullptr) noexcept {
-  if (buffer.empty()) {
+inline ResultType msgpack_deserialize_buffer(const char *data, size_t size, string *out_err_msg) noexcept {
+  if (size == 0) {
     return {};
   }
 
+  CycleAttributionScope cycle_attribution{CycleSubsystem::serialization};
   const auto malloc_replacement_guard = make_malloc_replacement_with_script_allocator();
   string err_msg;
   try {
     size_t off{0};
-    msgpack::object_handle oh = msgpack::unpack(buffer.c_str(), buffer.size(), off);
+    msgpack::object_handle oh = msgpack::unpack(data, size, off);
     msgpack::object obj = oh.get();
 
-    if (off != buffer.size()) {
+    if (off != size) {
       err_msg.append("Consumed only first ").append(static_cast<int64_t>(off))
-             .append(" characters of ").append(static_cast<int64_t>(buffer.size()))
+             .append(" characters of ").append(static_cast<int64_t>(size))
              .append(" during deserialization");
     } else {
       return obj.as<ResultType>();
@@ -451,6 +474,24 @@ inline ResultType f$msgpack_deserialize(const string &buffer, string *out_err_ms
   return {};
 }
 
+template<class ResultType = mixed>
+inline ResultType f$msgpack_deserialize(const string &buffer, string *out_err_msg = nullptr) noexcept {
+  return msgpack_deserialize_buffer<ResultType>(buffer.c_str(), buffer.size(), out_err_msg);
+}
+
+// Deserializes only the value found by the path of array indices or map keys, e.g. ['items', 5, 'id'],
+// the rest of the buffer is skipped without unpacking; returns null if there is no such value
+mixed msgpack_deserialize_path(const string &buffer, const array<mixed> &path) noexcept;
+
+template<class T>
+inline mixed f$msgpack_deserialize_path(const string &buffer, const array<T> &path) noexcept {
+  array<mixed> mixed_path{array_size{path.count(), 0, true}};
+  for (const auto &it : path) {
+    mixed_path.push_back(it.get_value());
+  }
+  return msgpack_deserialize_path(buffer, mixed_path);
+}
+
 template<class ResultType = mixed>
 inline ResultType f$msgpack_deserialize_safe(const string &buffer) noexcept {
   string err_msg;
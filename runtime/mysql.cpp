@@ -4,6 +4,7 @@
 
 #include "runtime/mysql.h"
 
+#include "runtime/resumable.h"
 #include "server/php-queries.h"
 
 static int mysql_callback_state;
@@ -260,7 +261,7 @@ static bool mysql_query(const class_instance<C$mysqli> &db, const string &query)
   field_names_ptr = &db->field_names;
 
   mysql_callback_state = 0;
-  db_run_query(db->connection_id, real_query.c_str(), len, DB_TIMEOUT_MS, mysql_query_callback);
+  db_run_query(db->connection_id, real_query.c_str(), len, fork_deadline_timeout_ms(DB_TIMEOUT_MS), mysql_query_callback);
   if (mysql_callback_state != 5 || !query_id) {
     return false;
   }
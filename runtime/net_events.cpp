@@ -9,6 +9,7 @@
 #include "runtime/allocator.h"
 #include "runtime/job-workers/job-interface.h"
 #include "runtime/rpc.h"
+#include "runtime/udp.h"
 #include "server/php-queries.h"
 
 int timeout_convert_to_ms(double timeout) {
@@ -168,6 +169,8 @@ int wait_net(int timeout_ms) {
   double begin_time = get_precise_now();
   double expire_event_time = 0.0;
 //  fprintf (stderr, "wait_net_begin\n");
+  // the forks are switched here, the queued datagrams shouldn't wait for the other forks
+  flush_udp_batch();
   int finished_events = process_net_events();
   if (finished_events) {
     timeout_ms = 0;
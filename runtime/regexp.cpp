@@ -10,6 +10,7 @@
 #include "common/containers/final_action.h"
 
 #include "runtime/critical_section.h"
+#include "runtime/cycle-attribution.h"
 
 int64_t preg_replace_count_dummy;
 
@@ -460,7 +461,7 @@ void regexp::init(const char *regexp_string, int64_t regexp_len, const char *fun
 
   can_use_RE2 = can_use_RE2 && is_valid_RE2_regexp(static_SB.c_str(), static_SB.size(), is_utf8, function, file);
 
-  if (is_utf8 && !mb_UTF8_check(static_SB.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(static_SB.c_str(), static_SB.size())) {
     pattern_compilation_warning(function, file, "Regexp \"%s\" contains not UTF-8 symbols", static_SB.c_str());
     clean();
     return;
@@ -588,6 +589,7 @@ regexp::~regexp() {
 int64_t regexp::pcre_last_error;
 
 int64_t regexp::exec(const string &subject, int64_t offset, bool second_try) const {
+  CycleAttributionScope cycle_attribution{CycleSubsystem::regexp};
   if (RE2_regexp && !second_try) {
     {
       dl::CriticalSectionGuard critical_section;
@@ -645,7 +647,7 @@ Optional<int64_t> regexp::match(const string &subject, bool all_matches __attrib
     return false;
   }
 
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return false;
   }
@@ -691,7 +693,7 @@ Optional<int64_t> regexp::match(const string &subject, mixed &matches, bool all_
     return false;
   }
 
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     matches = array<mixed>();
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return false;
@@ -787,7 +789,7 @@ Optional<int64_t> regexp::match(const string &subject, mixed &matches, int64_t f
     return false;
   }
 
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     matches = array<mixed>();
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return false;
@@ -923,7 +925,7 @@ Optional<array<mixed>> regexp::split(const string &subject, int64_t limit, int64
     return false;
   }
 
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return false;
   }
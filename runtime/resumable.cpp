@@ -67,6 +67,14 @@ struct forked_resumable_info : resumable_info {
   // x < 0 - (-id) of next finished function in the same queue or -2 if none
   int64_t queue_id;
   double running_time;
+  // 0 - forked from the main thread
+  int64_t parent_fork_id;
+  int64_t priority;
+  // 0 - no deadline
+  double deadline;
+  bool abandoned;
+  double start_time;
+  double finish_time;
 };
 
 struct started_resumable_info : resumable_info {
@@ -114,6 +122,9 @@ static uint32_t yielded_resumables_l;
 static uint32_t yielded_resumables_r;
 static uint32_t yielded_resumables_size;
 
+// is set, if some fork of the script has a priority or a deadline, otherwise the scheduler doesn't look at them
+static bool fork_scheduling_used;
+
 static inline bool is_forked_resumable_id(int64_t resumable_id) {
   return first_forked_resumable_id <= resumable_id && resumable_id < current_forked_resumable_id;
 }
@@ -201,6 +212,19 @@ int64_t register_forked_resumable(Resumable *resumable) {
   res->running_time = 0;
   res->name = resumable ? typeid(*resumable).name() : "(null)";
 
+  // the priority and the deadline are inherited from the forking fork
+  res->parent_fork_id = f$get_running_fork_id();
+  res->priority = 0;
+  res->deadline = 0;
+  if (res->parent_fork_id) {
+    const forked_resumable_info *parent = get_forked_resumable_info(res->parent_fork_id);
+    res->priority = parent->priority;
+    res->deadline = parent->deadline;
+  }
+  res->abandoned = false;
+  res->start_time = get_precise_now();
+  res->finish_time = 0;
+
   return res_id;
 }
 
@@ -239,7 +263,8 @@ Optional<array<mixed>> f$get_fork_stat(int64_t fork_id) {
   if (!info) {
     return false;
   }
-  if (info->queue_id == -1 && info->output.tag == 0) {
+  // an abandoned fork finishes without a result, but its stat is still available
+  if (info->queue_id == -1 && info->output.tag == 0 && !info->abandoned) {
     return false;
   }
 
@@ -258,9 +283,127 @@ Optional<array<mixed>> f$get_fork_stat(int64_t fork_id) {
     running_time += get_precise_now();
   }
   result.set_value(string("work_time"), running_time);
+  const double finish_time = info->queue_id < 0 ? info->finish_time : get_precise_now();
+  result.set_value(string("wall_time"), finish_time - info->start_time);
+  result.set_value(string("priority"), info->priority);
+  result.set_value(string("deadline"), info->deadline);
+  result.set_value(string("abandoned"), info->abandoned);
   return result;
 }
 
+static bool is_fork_descendant(int64_t fork_id, int64_t ancestor_id) noexcept {
+  while (fork_id > ancestor_id && fork_id >= first_array_forked_resumable_id) {
+    fork_id = get_forked_resumable_info(fork_id)->parent_fork_id;
+  }
+  return fork_id == ancestor_id;
+}
+
+static int32_t fork_deadline_wakeup_id = -1;
+// one timer for all forks, it is armed at the earliest deadline of the unfinished forks:
+// the deadline inherited by the forks is kept after the fork it was set for has finished
+static event_timer *fork_deadline_timer;
+
+static void arm_fork_deadline_timer(double deadline) noexcept {
+  if (fork_deadline_timer) {
+    remove_event_timer(fork_deadline_timer);
+  }
+  fork_deadline_timer = allocate_event_timer(deadline, fork_deadline_wakeup_id, 0);
+}
+
+// abandons all unfinished forks with the exceeded deadline, their net queries are cancelled
+static void process_fork_deadline(event_timer *timer) {
+  php_assert(timer == fork_deadline_timer);
+  remove_event_timer(timer);
+  fork_deadline_timer = nullptr;
+
+  update_precise_now();
+  double next_deadline = 0;
+  for (int64_t id = first_array_forked_resumable_id; id < current_forked_resumable_id; ++id) {
+    // can be reallocated by the abandoned resumables
+    forked_resumable_info *info = get_forked_resumable_info(id);
+    if (info->queue_id < 0 || info->abandoned || info->deadline == 0) {
+      continue;
+    }
+    if (info->deadline <= get_precise_now()) {
+      tvkprintf(resumable, 1, "Abandon fork %" PRIi64 " with deadline %.6lf\n", id, info->deadline);
+      info->abandoned = true;
+      if (info->continuation) {
+        info->continuation->abandon();
+      }
+    } else if (next_deadline == 0 || info->deadline < next_deadline) {
+      next_deadline = info->deadline;
+    }
+  }
+
+  if (next_deadline > 0 && (!fork_deadline_timer || next_deadline < fork_deadline_timer->wakeup_time)) {
+    arm_fork_deadline_timer(next_deadline);
+  }
+}
+
+bool f$set_fork_deadline(int64_t fork_id, double timeout) {
+  if (!is_forked_resumable_id(fork_id)) {
+    php_warning("Wrong fork id %" PRIi64 " in function set_fork_deadline", fork_id);
+    return false;
+  }
+  if (timeout <= 0) {
+    php_warning("Non-positive timeout %f in function set_fork_deadline", timeout);
+    return false;
+  }
+  forked_resumable_info *info = get_forked_resumable_info(fork_id);
+  if (info->queue_id < 0) {
+    return false;
+  }
+
+  update_precise_now();
+  const double deadline = get_precise_now() + std::min(timeout, static_cast<double>(MAX_TIMEOUT));
+  info->deadline = deadline;
+  // the already started forks of this fork can't outlive it
+  for (int64_t id = std::max(fork_id + 1, first_array_forked_resumable_id); id < current_forked_resumable_id; ++id) {
+    forked_resumable_info *son = get_forked_resumable_info(id);
+    if (son->queue_id >= 0 && (son->deadline == 0 || son->deadline > deadline) && is_fork_descendant(id, fork_id)) {
+      son->deadline = deadline;
+    }
+  }
+  if (!fork_deadline_timer || deadline < fork_deadline_timer->wakeup_time) {
+    arm_fork_deadline_timer(deadline);
+  }
+  fork_scheduling_used = true;
+  return true;
+}
+
+bool f$set_fork_priority(int64_t fork_id, int64_t priority) {
+  if (!is_forked_resumable_id(fork_id)) {
+    php_warning("Wrong fork id %" PRIi64 " in function set_fork_priority", fork_id);
+    return false;
+  }
+  forked_resumable_info *info = get_forked_resumable_info(fork_id);
+  if (info->queue_id < 0) {
+    return false;
+  }
+
+  info->priority = priority;
+  fork_scheduling_used = true;
+  return true;
+}
+
+double fork_deadline_timeout(double timeout) {
+  const int64_t fork_id = f$get_running_fork_id();
+  if (!fork_id) {
+    return timeout;
+  }
+  const double deadline = get_forked_resumable_info(fork_id)->deadline;
+  if (deadline == 0) {
+    return timeout;
+  }
+  update_precise_now();
+  return std::min(timeout, deadline - get_precise_now());
+}
+
+int32_t fork_deadline_timeout_ms(int32_t timeout_ms) {
+  const double timeout = fork_deadline_timeout(timeout_ms * 0.001);
+  return timeout < timeout_ms * 0.001 ? timeout_convert_to_ms(timeout) : timeout_ms;
+}
+
 static int64_t register_started_resumable(Resumable *resumable) noexcept {
   int64_t res_id;
   bool is_new = false;
@@ -344,6 +487,7 @@ static void free_resumable_continuation(resumable_info *res) noexcept {
 static void finish_forked_resumable(int64_t resumable_id) noexcept {
   forked_resumable_info *res = get_forked_resumable_info(resumable_id);
   free_resumable_continuation(res);
+  res->finish_time = get_precise_now();
 
   if (res->queue_id > 100000000) {
     php_assert(is_started_resumable_id(res->queue_id));
@@ -359,6 +503,19 @@ static void finish_forked_resumable(int64_t resumable_id) noexcept {
   php_assert(get_forked_resumable_info(resumable_id)->queue_id < 0);
 }
 
+static bool is_abandoned_fork(int64_t fork_id) noexcept {
+  return fork_id != 0 && get_forked_resumable_info(fork_id)->abandoned;
+}
+
+// the result waited by the code of an abandoned fork is destroyed without being loaded by it
+static void drop_storage(Storage *storage) noexcept {
+  if (storage->tag == Storage::tagger<thrown_exception>::get_tag()) {
+    storage->load<thrown_exception>();
+  } else if (storage->tag != 0) {
+    storage->load_as<void>();
+  }
+}
+
 static void finish_started_resumable(int64_t resumable_id) {
   started_resumable_info *res = get_started_resumable_info(resumable_id);
   free_resumable_continuation(res);
@@ -436,10 +593,43 @@ static void resumable_add_finished(int64_t resumable_id) {
   finished_resumables[finished_resumables_count++] = resumable_id;
 }
 
+static bool is_scheduled_before(int64_t lhs_fork_id, int64_t rhs_fork_id) {
+  const forked_resumable_info *lhs = lhs_fork_id ? get_forked_resumable_info(lhs_fork_id) : nullptr;
+  const forked_resumable_info *rhs = rhs_fork_id ? get_forked_resumable_info(rhs_fork_id) : nullptr;
+  const int64_t lhs_priority = lhs ? lhs->priority : 0;
+  const int64_t rhs_priority = rhs ? rhs->priority : 0;
+  if (lhs_priority != rhs_priority) {
+    return lhs_priority > rhs_priority;
+  }
+  const double lhs_deadline = lhs ? lhs->deadline : 0;
+  const double rhs_deadline = rhs ? rhs->deadline : 0;
+  return lhs_deadline != 0 && (rhs_deadline == 0 || lhs_deadline < rhs_deadline);
+}
+
+// the finished resumables of the forks with the higher priority and then with the earlier deadline are processed first,
+// the rest are processed in LIFO order
+static int64_t finished_resumables_pop() {
+  uint32_t chosen = finished_resumables_count - 1;
+  if (fork_scheduling_used) {
+    int64_t chosen_fork_id = get_started_resumable_info(finished_resumables[chosen])->fork_id;
+    for (uint32_t i = chosen; i-- > 0;) {
+      const int64_t fork_id = get_started_resumable_info(finished_resumables[i])->fork_id;
+      if (is_scheduled_before(fork_id, chosen_fork_id)) {
+        chosen = i;
+        chosen_fork_id = fork_id;
+      }
+    }
+  }
+  const int64_t resumable_id = finished_resumables[chosen];
+  memmove(finished_resumables + chosen, finished_resumables + chosen + 1, sizeof(int64_t) * (finished_resumables_count - chosen - 1));
+  finished_resumables_count--;
+  return resumable_id;
+}
+
 static void resumable_get_finished(int64_t *resumable_id, bool *is_yielded) {
   php_assert(resumable_has_finished());
   if (finished_resumables_count) {
-    *resumable_id = finished_resumables[--finished_resumables_count];
+    *resumable_id = finished_resumables_pop();
     *is_yielded = false;
   } else {
     *resumable_id = yielded_resumables_pop();
@@ -574,7 +764,12 @@ void run_scheduler(double dead_line_time) {
       php_assert(parent->continuation != nullptr);
       php_assert(parent->parent_id != -2);
       parent->son = 0;
-      if (parent->continuation->resume(parent_id, &res->output)) {
+      // the code of an abandoned fork isn't resumed anymore: its resumables finish without a result one by one
+      const bool abandoned = is_abandoned_fork(parent->fork_id);
+      if (abandoned) {
+        drop_storage(&res->output);
+      }
+      if (abandoned || parent->continuation->resume(parent_id, &res->output)) {
         finish_started_resumable(parent_id);
         resumable_add_finished(parent_id);
         left_resumables++;
@@ -590,7 +785,11 @@ void run_scheduler(double dead_line_time) {
       php_assert(parent->continuation != nullptr);
       php_assert(parent->queue_id >= 0);
       parent->son = 0;
-      if (parent->continuation->resume(parent_id, &res->output)) {
+      const bool abandoned = parent->abandoned;
+      if (abandoned) {
+        drop_storage(&res->output);
+      }
+      if (abandoned || parent->continuation->resume(parent_id, &res->output)) {
         finish_forked_resumable(parent_id);
       }
     }
@@ -733,11 +932,17 @@ private:
 
     forked_resumable_info *info = get_forked_resumable_info(child_id_);
 
-    if (info->queue_id < 0) {
+    if (info->queue_id < 0 && !info->abandoned) {
       output_->save<bool>(true);
     } else {
-      php_assert(input_ == nullptr);
-      info->queue_id = 0;
+      if (info->queue_id >= 0) {
+        php_assert(input_ == nullptr);
+        info->queue_id = 0;
+      }
+      // the abandoned fork finishes without a result
+      if (info->abandoned) {
+        last_wait_error = "Fork deadline exceeded";
+      }
       output_->save<bool>(false);
     }
 
@@ -827,9 +1032,23 @@ bool wait_without_result(int64_t resumable_id, double timeout) {
     return false;
   }
 
+  // the result of the abandoned fork is not waited
+  if (resumable->deadline > 0) {
+    update_precise_now();
+    if (resumable->abandoned || resumable->deadline <= get_precise_now()) {
+      last_wait_error = "Fork deadline exceeded";
+      return false;
+    }
+    if (resumable->deadline < timeout) {
+      timeout = resumable->deadline;
+      has_timeout = true;
+    }
+  }
+
   if (in_main_thread()) {
-    if (!wait_forked_resumable(resumable_id, timeout)) {
-      last_wait_error = "Timeout in wait";
+    // the abandoned fork can also finish during the wait, but without a result
+    if (!wait_forked_resumable(resumable_id, timeout) || get_forked_resumable_info(resumable_id)->abandoned) {
+      last_wait_error = get_forked_resumable_info(resumable_id)->abandoned ? "Fork deadline exceeded" : "Timeout in wait";
       return false;
     }
 
@@ -1245,6 +1464,7 @@ void global_init_resumable_lib() {
   wait_timeout_wakeup_id = register_wakeup_callback(&process_wait_timeout);
   wait_queue_timeout_wakeup_id = register_wakeup_callback(&process_wait_queue_timeout);
   yield_wakeup_id = register_wakeup_callback(&yielded_resumable_timeout);
+  fork_deadline_wakeup_id = register_wakeup_callback(&process_fork_deadline);
 }
 
 void init_resumable_lib() {
@@ -1287,9 +1507,15 @@ void init_resumable_lib() {
   wait_queues = static_cast<wait_queue *>(dl::allocate(sizeof(wait_queue) * wait_queues_size));
   wait_next_queue_id = 0;
   first_free_queue_id = 0;
+  fork_scheduling_used = false;
+  fork_deadline_timer = nullptr;
   new(&gotten_forked_resumable_info.output) Storage;
   gotten_forked_resumable_info.queue_id = -1;
   gotten_forked_resumable_info.continuation = nullptr;
+  gotten_forked_resumable_info.parent_fork_id = 0;
+  gotten_forked_resumable_info.priority = 0;
+  gotten_forked_resumable_info.deadline = 0;
+  gotten_forked_resumable_info.abandoned = false;
 }
 
 int32_t get_resumable_stack(void **buffer, int32_t limit) {
@@ -61,6 +61,10 @@ public:
   bool resume(int64_t resumable_id, Storage *input);
   void *get_stack_ptr() { return pos__; }
 
+  // is called for the unfinished forks, when their deadline is exceeded; the net queries cancel themselves here,
+  // the other resumables aren't interrupted, but the code of the abandoned fork isn't resumed after they finish
+  virtual void abandon() noexcept {}
+
   static void update_output();
 };
 
@@ -112,6 +116,13 @@ Optional<int64_t> f$wait_queue_next_synchronously(int64_t queue_id);
 int64_t f$get_running_fork_id();
 Optional<array<mixed>> f$get_fork_stat(int64_t fork_id);
 
+bool f$set_fork_deadline(int64_t fork_id, double timeout);
+bool f$set_fork_priority(int64_t fork_id, int64_t priority);
+
+// the timeouts of the net queries are clamped by the deadline of the running fork
+double fork_deadline_timeout(double timeout);
+int32_t fork_deadline_timeout_ms(int32_t timeout_ms);
+
 template<typename T>
 class wait_result_resumable final : public Resumable {
 public:
@@ -4,12 +4,15 @@
 
 #include "runtime/rpc.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdarg>
 
 #include "common/rpc-error-codes.h"
 #include "common/tl/constants/common.h"
 
 #include "runtime/critical_section.h"
+#include "runtime/cycle-attribution.h"
 #include "runtime/exception.h"
 #include "runtime/memcache.h"
 #include "runtime/misc.h"
@@ -239,6 +242,21 @@ void f$fetch_raw_vector_double(array<double> &out, int64_t n_elems) {
   rpc_data += rpc_data_buf_offset;
 }
 
+void fetch_raw_vector_int(array<int64_t> &out, int64_t n_elems) {
+  TRY_CALL_VOID(void, (check_rpc_data_len(n_elems)));
+  for (int64_t i = 0; i < n_elems; ++i) {
+    out.push_back(rpc_data[i]);
+  }
+  rpc_data += n_elems;
+}
+
+void fetch_raw_vector_long(array<int64_t> &out, int64_t n_elems) {
+  int64_t rpc_data_buf_offset = static_cast<int64_t>(sizeof(int64_t) * n_elems / 4);
+  TRY_CALL_VOID(void, (check_rpc_data_len(rpc_data_buf_offset)));
+  out.memcpy_vector(n_elems, rpc_data);
+  rpc_data += rpc_data_buf_offset;
+}
+
 static inline const char *f$fetch_string_raw(int *string_len) {
   TRY_CALL_VOID_(check_rpc_data_len(1), return nullptr);
   const char *str = reinterpret_cast <const char *> (rpc_data);
@@ -398,6 +416,32 @@ void f$store_raw_vector_double(const array<double> &vector) {
                   sizeof(double) * vector.count());
 }
 
+bool store_raw_vector_int(const array<int64_t> &vector) {
+  const int64_t *values = vector.get_const_vector_pointer();
+  const int64_t n = vector.count();
+  if (std::any_of(values, values + n, is_int32_overflow)) {
+    return false;
+  }
+
+  std::array<int32_t, 1024> chunk;
+  for (int64_t i = 0; i < n;) {
+    const int64_t chunk_size = std::min(n - i, static_cast<int64_t>(chunk.size()));
+    std::copy(values + i, values + i + chunk_size, chunk.begin());
+    data_buf.append(reinterpret_cast<const char *>(chunk.data()), sizeof(int32_t) * chunk_size);
+    i += chunk_size;
+  }
+  return true;
+}
+
+void store_raw_vector_long(const array<int64_t> &vector) {
+  data_buf.append(reinterpret_cast<const char *>(vector.get_const_vector_pointer()),
+                  sizeof(int64_t) * vector.count());
+}
+
+string rpc_get_stored_data() {
+  return string(data_buf.c_str() + data_buf_header_size, static_cast<string::size_type>(data_buf.size() - data_buf_header_size));
+}
+
 bool store_header(long long cluster_id, int64_t flags) {
   if (flags) {
     store_int(TL_RPC_DEST_ACTOR_FLAGS);
@@ -654,6 +698,11 @@ protected:
   }
 
 public:
+  void abandon() noexcept final {
+    // the late answer will be dropped in process_rpc_answer
+    process_rpc_error(request_id, TL_ERROR_QUERY_TIMEOUT, "Fork deadline exceeded in KPHP runtime");
+  }
+
   rpc_resumable(int request_id, int port, long long actor_id) :
     request_id(request_id),
     port(port),
@@ -684,6 +733,7 @@ int64_t rpc_send(const class_instance<C$RpcConnection> &conn, double timeout, bo
   if (timeout <= 0 || timeout > MAX_TIMEOUT) {
     timeout = conn.get()->timeout_ms * 0.001;
   }
+  timeout = std::max(fork_deadline_timeout(timeout), 0.001);
 
   store_int(-1); // reserve for crc32
   php_assert (data_buf.size() % sizeof(int) == 0);
@@ -704,7 +754,7 @@ int64_t rpc_send(const class_instance<C$RpcConnection> &conn, double timeout, bo
   void *p = dl::allocate(request_size);
   memcpy(p, data_buf.c_str() + reserved, request_size);
 
-  slot_id_t result = rpc_send_query(conn.get()->host_num, (char *)p, (int)request_size, timeout_convert_to_ms(timeout));
+  slot_id_t result = rpc_send_query(conn.get()->host_num, (char *)p, (int)request_size, timeout_convert_to_ms(timeout), ignore_answer);
   if (result <= 0) {
     return -1;
   }
@@ -1080,6 +1130,7 @@ class_instance<RpcTlQuery> store_function(const mixed &tl_object) {
     CurrentProcessingQuery::get().raise_storing_error("Not an array passed to function rpc_tl_query");
     return {};
   }
+  CycleAttributionScope cycle_attribution{CycleSubsystem::tl};
   string fun_name = tl_arr_get(tl_object, tl_str_underscore, 0).to_string();
   if (!tl_storers_ht.has_key(fun_name)) {
     CurrentProcessingQuery::get().raise_storing_error("Function \"%s\" not found in tl-scheme", fun_name.c_str());
@@ -1101,6 +1152,7 @@ array<mixed> fetch_function(const class_instance<RpcTlQuery> &rpc_query) {
     return new_tl_object;       // this object carries an error (see tl_fetch_error())
   }
   php_assert(!rpc_query.is_null());
+  CycleAttributionScope cycle_attribution{CycleSubsystem::tl};
   CurrentProcessingQuery::get().set_current_tl_function(rpc_query);
   auto stored_fetcher = rpc_query.get()->result_fetcher->extract_untyped_fetcher();
   php_assert(stored_fetcher);
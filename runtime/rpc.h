@@ -74,6 +74,8 @@ bool f$fetch_eof();
 bool f$fetch_end();
 
 void f$fetch_raw_vector_double(array<double> &out, int64_t n_elems);
+void fetch_raw_vector_int(array<int64_t> &out, int64_t n_elems); // int32 elements are widened
+void fetch_raw_vector_long(array<int64_t> &out, int64_t n_elems);
 
 void estimate_and_flush_overflow(size_t &bytes_sent);
 
@@ -120,6 +122,9 @@ bool f$store_error(int64_t error_code, const string &error_text);
 bool f$store_raw(const string &data);
 
 void f$store_raw_vector_double(const array<double> &vector);
+bool store_raw_vector_int(const array<int64_t> &vector); // nothing is stored if any element doesn't fit into int32
+void store_raw_vector_long(const array<int64_t> &vector);
+string rpc_get_stored_data(); // the data stored since the last rpc_clean(), without the reserved header
 
 bool f$set_fail_rpc_on_int32_overflow(bool fail_rpc); // TODO: remove when all RPC errors will be fixed
 
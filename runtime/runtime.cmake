@@ -2,6 +2,7 @@ prepend(KPHP_RUNTIME_MEMORY_RESOURCE_SOURCES memory_resource/
         dealer.cpp
         details/memory_chunk_tree.cpp
         details/memory_ordered_chunk_list.cpp
+        global_init_resource.cpp
         heap_resource.cpp
         memory_resource.cpp
         monotonic_buffer_resource.cpp
@@ -24,6 +25,7 @@ prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         confdata-global-manager.cpp
         confdata-keys.cpp
         critical_section.cpp
+        cycle-attribution.cpp
         curl.cpp
         datetime.cpp
         exception.cpp
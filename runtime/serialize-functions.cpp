@@ -254,5 +254,6 @@ mixed unserialize_raw(const char *v, int32_t v_len) noexcept {
 }
 
 mixed f$unserialize(const string &v) noexcept {
+  CycleAttributionScope cycle_attribution{CycleSubsystem::serialization};
   return unserialize_raw(v.c_str(), v.size());
 }
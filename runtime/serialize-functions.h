@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "runtime/cycle-attribution.h"
 #include "runtime/kphp_core.h"
 
 namespace impl_ {
@@ -59,6 +60,7 @@ void PhpSerializer::serialize(const Optional<T> &opt) noexcept {
 
 template<class T>
 string f$serialize(const T &v) noexcept {
+  CycleAttributionScope cycle_attribution{CycleSubsystem::serialization};
   static_SB.clean();
   impl_::PhpSerializer::serialize(v);
   return static_SB.str();
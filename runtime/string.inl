@@ -58,6 +58,7 @@ char *string::string_inner::reserve(size_type requested_capacity) {
   size_type old_size = (size_type)(sizeof(string_inner) + (capacity + 1));
   size_type new_size = (size_type)(sizeof(string_inner) + (new_cap + 1));
 
+  drop_mb_index(ref_data());
   string_inner *p = (string_inner *)dl::reallocate((void *)this, new_size, old_size);
   p->capacity = new_cap;
   return p->ref_data();
@@ -74,6 +75,7 @@ void string::string_inner::dispose() {
 }
 
 void string::string_inner::destroy() {
+  drop_mb_index(ref_data());
   dl::deallocate(this, get_memory_usage());
 }
 
@@ -100,6 +102,12 @@ char *string::string_inner::clone(size_type requested_cap) {
 }
 
 
+void string::drop_mb_index(const char *data) noexcept {
+  if (unlikely(data == mb_indexed_data)) {
+    mb_indexed_data = nullptr;
+  }
+}
+
 string::string_inner *string::inner() const {
   return (string::string_inner *)p - 1;
 }
@@ -114,8 +122,11 @@ void string::set_size(size_type new_size) {
 
     inner()->dispose();
     p = r->ref_data();
-  } else if (new_size > capacity()) {
-    p = inner()->reserve(new_size);
+  } else {
+    drop_mb_index(p);
+    if (new_size > capacity()) {
+      p = inner()->reserve(new_size);
+    }
   }
   inner()->set_length_and_sharable(new_size);
 }
@@ -296,6 +307,8 @@ void string::shrink(size_type n) {
 
       inner()->dispose();
       p = r->ref_data();
+    } else {
+      drop_mb_index(p);
     }
     inner()->set_length_and_sharable(n);
   }
@@ -308,6 +321,9 @@ string::size_type string::capacity() const {
 void string::make_not_shared() {
   if (inner()->is_shared()) {
     force_reserve(size());
+  } else {
+    // the data is going to be modified in place
+    drop_mb_index(p);
   }
 }
 
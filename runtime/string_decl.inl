@@ -184,6 +184,11 @@ public:
 
   inline size_type estimate_memory_usage() const;
 
+  // The data of the string, which char offsets are indexed by the mb_ functions (see mbstring.cpp).
+  // The index doesn't reference the string, so it is dropped when the data is modified in place or freed.
+  static const char *mb_indexed_data;
+  inline static void drop_mb_index(const char *data) noexcept;
+
   inline static constexpr size_t inner_sizeof() noexcept { return sizeof(string_inner); }
   inline static string make_const_string_on_memory(const char *str, size_type len, void *memory, size_t memory_size);
 
@@ -8,6 +8,7 @@
 #include <sys/types.h>
 
 #include "common/macos-ports.h"
+#include "common/simd-string.h"
 #include "common/unicode/unicode-utils.h"
 
 #include "runtime/interface.h"
@@ -98,24 +99,23 @@ string f$addcslashes(const string &str, const string &what) {
 }
 
 string f$addslashes(const string &str) {
-  int len = str.size();
+  static constexpr char special_chars[] = {'\0', '\'', '\"', '\\'};
 
-  static_SB.clean().reserve(2 * len);
-  for (int i = 0; i < len; i++) {
-    switch (str[i]) {
-      case '\0':
-        static_SB.append_char('\\');
-        static_SB.append_char('0');
-        break;
-      case '\'':
-      case '\"':
-      case '\\':
-        static_SB.append_char('\\');
-        /* fallthrough */
-      default:
-        static_SB.append_char(str[i]);
-    }
+  const char *s = str.c_str();
+  const char *end = s + str.size();
+  const char *special = simd_find_first_of(s, end - s, special_chars, sizeof(special_chars));
+  if (special == nullptr) {
+    return str;
   }
+
+  static_SB.clean().reserve(2 * str.size());
+  do {
+    static_SB.append_unsafe(s, static_cast<int>(special - s));
+    static_SB.append_char('\\');
+    static_SB.append_char(*special ? *special : '0');
+    s = special + 1;
+  } while ((special = simd_find_first_of(s, end - s, special_chars, sizeof(special_chars))));
+  static_SB.append_unsafe(s, static_cast<int>(end - s));
   return static_SB.str();
 }
 
@@ -463,58 +463,48 @@ string f$htmlspecialchars(const string &str, int64_t flags) {
     php_critical_error ("unsupported parameter flags = %" PRIi64 " in function htmlspecialchars", flags);
   }
 
-  const string::size_type len = str.size();
-  static_SB.clean().reserve(6 * len);
+  // the quotes are searched only if they are going to be replaced
+  static constexpr char special_chars[] = {'&', '<', '>', '"', '\''};
+  size_t special_chars_count = 3;
+  if (!(flags & ENT_NOQUOTES)) {
+    special_chars_count++;
+    if (flags & ENT_QUOTES) {
+      special_chars_count++;
+    }
+  }
 
-  for (string::size_type i = 0; i < len; i++) {
-    switch (str[i]) {
+  const char *s = str.c_str();
+  const char *end = s + str.size();
+  const char *special = simd_find_first_of(s, end - s, special_chars, special_chars_count);
+  if (special == nullptr) {
+    return str;
+  }
+
+  static_SB.clean().reserve(6 * str.size());
+  do {
+    static_SB.append_unsafe(s, static_cast<int>(special - s));
+    switch (*special) {
       case '&':
-        static_SB.append_char('&');
-        static_SB.append_char('a');
-        static_SB.append_char('m');
-        static_SB.append_char('p');
-        static_SB.append_char(';');
+        static_SB.append_unsafe("&amp;", 5);
         break;
       case '"':
-        if (!(flags & ENT_NOQUOTES)) {
-          static_SB.append_char('&');
-          static_SB.append_char('q');
-          static_SB.append_char('u');
-          static_SB.append_char('o');
-          static_SB.append_char('t');
-          static_SB.append_char(';');
-        } else {
-          static_SB.append_char('"');
-        }
+        static_SB.append_unsafe("&quot;", 6);
         break;
       case '\'':
-        if (flags & ENT_QUOTES) {
-          static_SB.append_char('&');
-          static_SB.append_char('#');
-          static_SB.append_char('0');
-          static_SB.append_char('3');
-          static_SB.append_char('9');
-          static_SB.append_char(';');
-        } else {
-          static_SB.append_char('\'');
-        }
+        static_SB.append_unsafe("&#039;", 6);
         break;
       case '<':
-        static_SB.append_char('&');
-        static_SB.append_char('l');
-        static_SB.append_char('t');
-        static_SB.append_char(';');
+        static_SB.append_unsafe("&lt;", 4);
         break;
       case '>':
-        static_SB.append_char('&');
-        static_SB.append_char('g');
-        static_SB.append_char('t');
-        static_SB.append_char(';');
+        static_SB.append_unsafe("&gt;", 4);
         break;
       default:
-        static_SB.append_char(str[i]);
+        php_assert(false);
     }
-  }
+    s = special + 1;
+  } while ((special = simd_find_first_of(s, end - s, special_chars, special_chars_count)));
+  static_SB.append_unsafe(s, static_cast<int>(end - s));
 
   return static_SB.str();
 }
@@ -1754,7 +1744,7 @@ Optional<int64_t> f$strpos(const string &haystack, const string &needle, int64_t
     return s - haystack.c_str();
   }
 
-  const char *s = static_cast <const char *> (memmem(haystack.c_str() + offset, haystack.size() - offset, needle.c_str(), needle.size()));
+  const char *s = simd_memmem(haystack.c_str() + offset, haystack.size() - offset, needle.c_str(), needle.size());
   if (s == nullptr) {
     return false;
   }
@@ -1836,7 +1826,7 @@ Optional<string> f$strstr(const string &haystack, const string &needle, bool bef
     return false;
   }
 
-  const char *s = static_cast <const char *> (memmem(haystack.c_str(), haystack.size(), needle.c_str(), needle.size()));
+  const char *s = simd_memmem(haystack.c_str(), haystack.size(), needle.c_str(), needle.size());
   if (s == nullptr) {
     return false;
   }
@@ -1849,24 +1839,14 @@ Optional<string> f$strstr(const string &haystack, const string &needle, bool bef
 }
 
 string f$strtolower(const string &str) {
-  int n = str.size();
-
-  string res(n, false);
-  for (int i = 0; i < n; i++) {
-    res[i] = (char)tolower(str[i]);
-  }
-
+  string res(str.size(), false);
+  simd_convert_case(res.buffer(), str.c_str(), str.size(), tolower, 'A', 'Z');
   return res;
 }
 
 string f$strtoupper(const string &str) {
-  int n = str.size();
-
-  string res(n, false);
-  for (int i = 0; i < n; i++) {
-    res[i] = (char)toupper(str[i]);
-  }
-
+  string res(str.size(), false);
+  simd_convert_case(res.buffer(), str.c_str(), str.size(), toupper, 'a', 'z');
   return res;
 }
 
@@ -1999,7 +1979,7 @@ void str_replace_inplace(const string &search, const string &replace, string &su
   char *output = subject.buffer();
   bool length_no_change = search.size() == replace.size();
   while (true) {
-    const char *pos = static_cast <const char *> (memmem(piece, piece_end - piece, search.c_str(), search.size()));
+    const char *pos = simd_memmem(piece, piece_end - piece, search.c_str(), search.size());
     if (pos == nullptr) {
       if (count == 0) {
         return;
@@ -2039,7 +2019,7 @@ string str_replace(const string &search, const string &replace, const string &su
   const char *piece = subject.c_str(), *piece_end = subject.c_str() + subject.size();
   string result;
   while (true) {
-    const char *pos = static_cast <const char *> (memmem(piece, piece_end - piece, search.c_str(), search.size()));
+    const char *pos = simd_memmem(piece, piece_end - piece, search.c_str(), search.size());
     if (pos == nullptr) {
       if (count == 0) {
         return subject;
@@ -2197,7 +2177,7 @@ int64_t f$substr_count(const string &haystack, const string &needle, int64_t off
     return end - s;
   }
   do {
-    s = static_cast <const char *> (memmem(static_cast <const void *> (s), (size_t)(end - s), static_cast <const void *> (needle.c_str()), (size_t)needle.size()));
+    s = simd_memmem(s, end - s, needle.c_str(), needle.size());
     if (s == nullptr) {
       return ans;
     }
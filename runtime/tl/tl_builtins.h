@@ -76,26 +76,6 @@ inline void fetch_magic_if_not_bare(unsigned int inner_magic, const char *error_
   }
 }
 
-template<class T>
-inline void fetch_raw_vector_T(array<T> &out __attribute__ ((unused)), int64_t n_elems __attribute__ ((unused))) {
-  php_assert(0 && "never called in runtime");
-}
-
-template<>
-inline void fetch_raw_vector_T<double>(array<double> &out, int64_t n_elems) {
-  f$fetch_raw_vector_double(out, n_elems);
-}
-
-template<class T>
-inline void store_raw_vector_T(const array<T> &v __attribute__ ((unused))) {
-  php_assert(0 && "never called in runtime");
-}
-
-template<>
-inline void store_raw_vector_T<double>(const array<double> &v) {
-  f$store_raw_vector_double(v);
-}
-
 // Wrap into Optional that TL types which PhpType is:
 //  1. int, double, string, bool
 //  2. array<T>
@@ -317,6 +297,66 @@ struct t_True {
   }
 };
 
+// The fixed-width primitive vectors are (de)serialized in bulk directly from/to the array vector storage,
+// without the per element bounds and exception checks
+template<typename T>
+struct tl_raw_vector {
+  static constexpr bool is_supported = false;
+
+  template<typename PhpType>
+  static void fetch(PhpType &out __attribute__ ((unused)), int64_t n_elems __attribute__ ((unused))) {
+    php_assert(0 && "never called in runtime");
+  }
+
+  template<typename PhpType>
+  static bool store(const PhpType &v __attribute__ ((unused))) {
+    php_assert(0 && "never called in runtime");
+    return false;
+  }
+};
+
+template<>
+struct tl_raw_vector<t_Int> {
+  static constexpr bool is_supported = true;
+
+  static void fetch(array<int64_t> &out, int64_t n_elems) {
+    fetch_raw_vector_int(out, n_elems);
+  }
+
+  // int32 overflow is handled by the per element storing
+  static bool store(const array<int64_t> &v) {
+    return store_raw_vector_int(v);
+  }
+};
+
+template<>
+struct tl_raw_vector<t_Long> {
+  static constexpr bool is_supported = true;
+
+  static void fetch(array<int64_t> &out, int64_t n_elems) {
+    fetch_raw_vector_long(out, n_elems);
+  }
+
+  static bool store(const array<int64_t> &v) {
+    store_raw_vector_long(v);
+    return true;
+  }
+};
+
+template<>
+struct tl_raw_vector<t_Double> {
+  static constexpr bool is_supported = true;
+
+  static void fetch(array<double> &out, int64_t n_elems) {
+    f$fetch_raw_vector_double(out, n_elems);
+  }
+
+  static bool store(const array<double> &v) {
+    f$store_raw_vector_double(v);
+    return true;
+  }
+};
+
 template<typename T, unsigned int inner_magic>
 struct t_Vector {
   T elem_state;
@@ -366,8 +406,7 @@ struct t_Vector {
     int64_t n = v.count();
     f$store_int(n);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0 && v.is_vector()) {
-      store_raw_vector_T<typename T::PhpType>(v);
+    if (tl_raw_vector<T>::is_supported && inner_magic == 0 && v.is_vector() && tl_raw_vector<T>::store(v)) {
       return;
     }
 
@@ -390,8 +429,8 @@ struct t_Vector {
     }
     out.reserve(n, 0, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, n);
+    if (tl_raw_vector<T>::is_supported && inner_magic == 0) {
+      tl_raw_vector<T>::fetch(out, n);
       return;
     }
 
@@ -605,8 +644,7 @@ struct t_Tuple {
   using PhpType = array<typename T::PhpType>;
 
   void typed_store(const PhpType &v) {
-    if (std::is_same<T, t_Double>{} && inner_magic == 0 && v.is_vector() && v.count() == size) {
-      store_raw_vector_T<typename T::PhpType>(v);
+    if (tl_raw_vector<T>::is_supported && inner_magic == 0 && v.is_vector() && v.count() == size && tl_raw_vector<T>::store(v)) {
       return;
     }
 
@@ -624,8 +662,8 @@ struct t_Tuple {
     CHECK_EXCEPTION(return);
     out.reserve(size, 0, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, size);
+    if (tl_raw_vector<T>::is_supported && inner_magic == 0) {
+      tl_raw_vector<T>::fetch(out, size);
       return;
     }
 
@@ -678,8 +716,7 @@ struct tl_array {
   using PhpType = array<typename T::PhpType>;
 
   void typed_store(const PhpType &v) {
-    if (std::is_same<T, t_Double>{} && inner_magic == 0 && v.is_vector() && v.count() == size) {
-      store_raw_vector_T<typename T::PhpType>(v);
+    if (tl_raw_vector<T>::is_supported && inner_magic == 0 && v.is_vector() && v.count() == size && tl_raw_vector<T>::store(v)) {
       return;
     }
 
@@ -697,8 +734,8 @@ struct tl_array {
     CHECK_EXCEPTION(return);
     out.reserve(size, 0, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, size);
+    if (tl_raw_vector<T>::is_supported && inner_magic == 0) {
+      tl_raw_vector<T>::fetch(out, size);
       return;
     }
 
@@ -7,6 +7,7 @@
 #include "common/containers/final_action.h"
 #include "common/rpc-error-codes.h"
 
+#include "runtime/cycle-attribution.h"
 #include "runtime/resumable.h"
 #include "runtime/rpc.h"
 #include "runtime/tl/rpc_server.h"
@@ -14,6 +15,7 @@
 namespace {
 class_instance<C$VK$TL$RpcResponse> fetch_result(std::unique_ptr<RpcRequestResult> result_fetcher, const RpcErrorFactory &error_factory) {
   php_assert(result_fetcher && !result_fetcher->empty());
+  CycleAttributionScope cycle_attribution{CycleSubsystem::tl};
 
   auto rpc_error = error_factory.fetch_error_if_possible();
   if (!rpc_error.is_null()) {
@@ -149,7 +151,11 @@ int64_t typed_rpc_tl_query_impl(const class_instance<C$RpcConnection> &connectio
     return 0;
   }
 
-  std::unique_ptr<RpcRequestResult> stored_fetcher = req.store_request();
+  std::unique_ptr<RpcRequestResult> stored_fetcher;
+  {
+    CycleAttributionScope cycle_attribution{CycleSubsystem::tl};
+    stored_fetcher = req.store_request();
+  }
   if (!stored_fetcher) {
     return 0;
   }
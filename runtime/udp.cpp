@@ -4,9 +4,12 @@
 
 #include "runtime/udp.h"
 
+#include <algorithm>
 #include <cerrno>
+#include <memory>
 #include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include "common/resolver.h"
 
@@ -23,6 +26,96 @@ static char opened_udp_sockets_storage[sizeof(array<int>)];
 static array<int> *opened_udp_sockets = reinterpret_cast <array<int> *> (opened_udp_sockets_storage);
 static long long opened_udp_sockets_last_query_num = -1;
 
+namespace {
+
+// The small datagrams written into the udp streams are queued and sent together by sendmmsg,
+// the queue is flushed when it's full, when the script starts waiting for the network and at the script end
+struct udp_batched_message {
+  int fd;
+  uint32_t offset;
+  uint32_t len;
+};
+
+int udp_batch_max_messages = 0;
+int udp_batch_max_bytes = 64 * 1024;
+
+std::unique_ptr<char[]> udp_batch_buffer;
+std::unique_ptr<udp_batched_message[]> udp_batch_messages;
+std::unique_ptr<mmsghdr[]> udp_batch_headers;
+std::unique_ptr<iovec[]> udp_batch_iovecs;
+int udp_batch_messages_n = 0;
+size_t udp_batch_bytes = 0;
+
+udp_batching_stats udp_stats;
+
+bool udp_batching_enabled() noexcept {
+  return udp_batch_buffer != nullptr;
+}
+
+// sends the queued messages of the first socket in the queue and removes them from the queue
+void flush_udp_batch_of_first_socket() noexcept {
+  const int fd = udp_batch_messages[0].fd;
+  int headers_n = 0;
+  int left_n = 0;
+  for (int i = 0; i < udp_batch_messages_n; ++i) {
+    const udp_batched_message &message = udp_batch_messages[i];
+    if (message.fd != fd) {
+      udp_batch_messages[left_n++] = message;
+      continue;
+    }
+    udp_batch_iovecs[headers_n].iov_base = udp_batch_buffer.get() + message.offset;
+    udp_batch_iovecs[headers_n].iov_len = message.len;
+    memset(&udp_batch_headers[headers_n], 0, sizeof(mmsghdr));
+    udp_batch_headers[headers_n].msg_hdr.msg_iov = &udp_batch_iovecs[headers_n];
+    udp_batch_headers[headers_n].msg_hdr.msg_iovlen = 1;
+    ++headers_n;
+  }
+  udp_batch_messages_n = left_n;
+
+  int sent_n = 0;
+  while (sent_n < headers_n) {
+    const int res = sendmmsg(fd, &udp_batch_headers[sent_n], static_cast<unsigned>(headers_n - sent_n), 0);
+    if (res == -1 && errno == EINTR) {
+      continue;
+    }
+    ++udp_stats.batches_sent;
+    if (res == -1) {
+      // the first message can't be sent, the others are tried once more
+      ++udp_stats.messages_dropped;
+      ++sent_n;
+      continue;
+    }
+    udp_stats.messages_sent += res;
+    sent_n += res;
+  }
+}
+
+} // namespace
+
+void set_udp_batch_max_messages(int max_messages) noexcept {
+  udp_batch_max_messages = std::min(max_messages, UIO_MAXIOV);
+}
+
+void set_udp_batch_max_bytes(int max_bytes) noexcept {
+  udp_batch_max_bytes = max_bytes;
+}
+
+void flush_udp_batch() noexcept {
+  if (!udp_batch_messages_n) {
+    return;
+  }
+  dl::enter_critical_section();//OK
+  while (udp_batch_messages_n) {
+    flush_udp_batch_of_first_socket();
+  }
+  udp_batch_bytes = 0;
+  dl::leave_critical_section();
+}
+
+const udp_batching_stats &get_udp_batching_stats() noexcept {
+  return udp_stats;
+}
+
 static Stream udp_stream_socket_client(const string &url, int64_t &error_number, string &error_description, double timeout,
                                        int64_t flags __attribute__((unused)), const mixed &options __attribute__((unused))) {
 #define RETURN                                          \
@@ -165,13 +258,30 @@ static Optional<int64_t> udp_fwrite(const Stream &stream, const string &data) {
   if (data_len == 0) {
     return 0;
   }
+  if (udp_batching_enabled() && data_len <= static_cast<size_t>(udp_batch_max_bytes)) {
+    if (udp_batch_bytes + data_len > static_cast<size_t>(udp_batch_max_bytes)) {
+      flush_udp_batch();
+    }
+    memcpy(udp_batch_buffer.get() + udp_batch_bytes, data_ptr, data_len);
+    udp_batch_messages[udp_batch_messages_n++] = udp_batched_message{sock_fd, static_cast<uint32_t>(udp_batch_bytes), static_cast<uint32_t>(data_len)};
+    udp_batch_bytes += data_len;
+    ++udp_stats.messages_batched;
+    if (udp_batch_messages_n == udp_batch_max_messages) {
+      flush_udp_batch();
+    }
+    return static_cast<int64_t>(data_len);
+  }
+  // keep the order of the messages
+  flush_udp_batch();
   dl::enter_critical_section(); // OK
   ssize_t res = send(sock_fd, data_ptr, data_len, 0);
   dl::leave_critical_section();
   if (res == -1) {
+    ++udp_stats.messages_dropped;
     php_warning("An error occurred while sending UPD-package");
     return false;
   }
+  ++udp_stats.messages_sent;
   return res;
 }
 
@@ -182,6 +292,7 @@ static bool udp_fclose(const Stream &stream) {
     return false;
   }
 
+  flush_udp_batch();
   dl::enter_critical_section();
   int result = close(opened_udp_sockets->get_value(stream_key));
   opened_udp_sockets->unset(stream_key);
@@ -214,9 +325,17 @@ void global_init_udp_lib() {
   udp_stream_functions.get_fd = udp_get_fd;
 
   register_stream_functions(&udp_stream_functions, false);
+
+  if (udp_batch_max_messages > 0 && udp_batch_max_bytes > 0 && !udp_batching_enabled()) {
+    udp_batch_buffer.reset(new char[udp_batch_max_bytes]);
+    udp_batch_messages.reset(new udp_batched_message[udp_batch_max_messages]);
+    udp_batch_headers.reset(new mmsghdr[udp_batch_max_messages]);
+    udp_batch_iovecs.reset(new iovec[udp_batch_max_messages]);
+  }
 }
 
 void free_udp_lib() {
+  flush_udp_batch();
   dl::enter_critical_section();//OK
   if (dl::query_num == opened_udp_sockets_last_query_num) {
     const array<int> *const_opened_udp_sockets = opened_udp_sockets;
@@ -6,6 +6,24 @@
 
 #include "runtime/kphp_core.h"
 
+struct udp_batching_stats {
+  int64_t messages_sent{0};
+  // the messages, which were queued instead of being sent immediately
+  int64_t messages_batched{0};
+  int64_t messages_dropped{0};
+  // the number of sendmmsg calls
+  int64_t batches_sent{0};
+};
+
+// max_messages == 0 disables the batching: each fwrite into an udp stream is sent immediately
+void set_udp_batch_max_messages(int max_messages) noexcept;
+void set_udp_batch_max_bytes(int max_bytes) noexcept;
+
+// sends all queued udp messages, it is called before waiting for the network and at the script end
+void flush_udp_batch() noexcept;
+
+const udp_batching_stats &get_udp_batching_stats() noexcept;
+
 void global_init_udp_lib();
 
 void free_udp_lib();
@@ -0,0 +1,118 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/allocation-profiler.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <cstring>
+#include <unistd.h>
+
+#include "common/fast-backtrace.h"
+#include "common/kprintf.h"
+
+#include "runtime/allocator.h"
+
+bool AllocationProfiler::set_log_prefix(const char *log_prefix) noexcept {
+  const size_t log_prefix_len = strlen(log_prefix);
+  // reserve 128 bytes for pid + timestamp + suffix
+  if (!log_prefix_len || log_prefix_len + 128 > PATH_MAX) {
+    return false;
+  }
+  log_prefix_.assign(log_prefix, log_prefix_len);
+  return true;
+}
+
+bool AllocationProfiler::set_sampling_period(int64_t sampling_period) noexcept {
+  if (sampling_period < 1024 || sampling_period > (1 << 30)) {
+    return false;
+  }
+  sampling_period_ = static_cast<size_t>(sampling_period);
+  return true;
+}
+
+void AllocationProfiler::request_toggle() noexcept {
+  toggle_requested_ = 1;
+}
+
+void AllocationProfiler::record_sample(size_t sampled_bytes) {
+  // the script allocator mustn't be used here, it is called from the inside
+  auto &self = vk::singleton<AllocationProfiler>::get();
+  if (self.samples_count_ >= max_samples) {
+    ++self.samples_dropped_;
+    return;
+  }
+  Sample &sample = self.samples_[self.samples_count_++];
+  sample.sampled_bytes = sampled_bytes;
+  sample.depth = fast_backtrace(sample.frames.data(), max_stack_depth);
+}
+
+void AllocationProfiler::start() noexcept {
+  samples_count_ = 0;
+  samples_dropped_ = 0;
+  sites_.clear();
+  enabled_ = true;
+  dl::set_script_allocation_sampler(record_sample, sampling_period_);
+  kprintf("Allocation profiler is started with %zu bytes sampling period\n", sampling_period_);
+}
+
+void AllocationProfiler::stop() noexcept {
+  dl::set_script_allocation_sampler(nullptr, 0);
+  enabled_ = false;
+  fold_samples(sites_);
+  dump_sites(sites_, "heap");
+  kprintf("Allocation profiler is stopped, %" PRIu64 " samples are dropped\n", samples_dropped_);
+  sites_.clear();
+  stack_folder_.clear_cache();
+}
+
+void AllocationProfiler::fold_samples(Sites &sites) noexcept {
+  for (int sample_id = 0; sample_id < samples_count_; ++sample_id) {
+    const Sample &sample = samples_[sample_id];
+    sites[stack_folder_.fold(sample.frames.data(), sample.depth)] += sample.sampled_bytes;
+  }
+  samples_count_ = 0;
+}
+
+void AllocationProfiler::dump_sites(const Sites &sites, const char *suffix) noexcept {
+  char log_path[PATH_MAX];
+  snprintf(log_path, sizeof(log_path), "%s.%d.%" PRIu64 ".%s", log_prefix_.c_str(), getpid(),
+           static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch() / std::chrono::seconds{1}), suffix);
+  FILE *log = fopen(log_path, "w");
+  if (!log) {
+    kprintf("Can't open allocation profiler log '%s': %s\n", log_path, strerror(errno));
+    return;
+  }
+  // the folded stacks format, weighted by the sampled bytes
+  for (const auto &site : sites) {
+    fprintf(log, "%s %" PRIu64 "\n", site.first.c_str(), site.second);
+  }
+  fclose(log);
+  kprintf("Allocation profiler dumped %zu allocation sites to '%s'\n", sites.size(), log_path);
+}
+
+void AllocationProfiler::on_script_finished(bool memory_limit_exceeded) noexcept {
+  if (enabled_) {
+    if (memory_limit_exceeded) {
+      Sites script_sites;
+      fold_samples(script_sites);
+      dump_sites(script_sites, "memory_limit.heap");
+      for (const auto &site : script_sites) {
+        sites_[site.first] += site.second;
+      }
+    } else {
+      fold_samples(sites_);
+    }
+  }
+
+  if (toggle_requested_) {
+    toggle_requested_ = 0;
+    if (enabled_) {
+      stop();
+    } else if (is_available()) {
+      start();
+    }
+  }
+}
@@ -0,0 +1,74 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <csignal>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+#include "server/php-stack-folder.h"
+
+// The allocation profiler, that can be enabled in the running worker without the script recompilation.
+// It is toggled by SIGALLOCATIONPROFILER (the master sends it on 'allocation_profiler_toggle<pid>' memcache get).
+// While enabled, every N-th byte allocated by the script is sampled with its stack, the samples are folded into php function stacks
+// after each script. The script allocations are dumped to '<log prefix>.<pid>.<timestamp>.memory_limit.heap' if the script exceeds
+// the memory limit, all the allocations are dumped to '<log prefix>.<pid>.<timestamp>.heap' when the profiler is disabled.
+class AllocationProfiler : vk::not_copyable {
+public:
+  friend class vk::singleton<AllocationProfiler>;
+
+  bool set_log_prefix(const char *log_prefix) noexcept;
+  bool set_sampling_period(int64_t sampling_period) noexcept;
+
+  bool is_available() const noexcept {
+    return !log_prefix_.empty();
+  }
+
+  // ATTENTION: this function is used in signal handlers, therefore it is expected to be safe for them
+  void request_toggle() noexcept;
+
+  // should be called after the script is finished, but before its memory is freed
+  void on_script_finished(bool memory_limit_exceeded) noexcept;
+
+private:
+  AllocationProfiler() = default;
+
+  static void record_sample(size_t sampled_bytes);
+
+  void start() noexcept;
+  void stop() noexcept;
+
+  // folded stack -> sampled bytes
+  using Sites = std::unordered_map<std::string, uint64_t>;
+
+  void fold_samples(Sites &sites) noexcept;
+  void dump_sites(const Sites &sites, const char *suffix) noexcept;
+
+  static constexpr int max_stack_depth = 64;
+  static constexpr int max_samples = 2048;
+
+  struct Sample {
+    size_t sampled_bytes{0};
+    int depth{0};
+    std::array<void *, max_stack_depth> frames;
+  };
+
+  std::string log_prefix_;
+  size_t sampling_period_{512 * 1024};
+  bool enabled_{false};
+
+  volatile sig_atomic_t toggle_requested_{0};
+  int samples_count_{0};
+  uint64_t samples_dropped_{0};
+  std::array<Sample, max_samples> samples_;
+
+  PhpStackFolder stack_folder_;
+  Sites sites_;
+};
@@ -2,6 +2,7 @@
 // Copyright (c) 2020 LLC «V Kontakte»
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 
+#include <algorithm>
 #include <new>
 #include <sys/mman.h>
 
@@ -9,6 +10,32 @@
 
 namespace job_workers {
 
+void LatencySamples::add(double latency) noexcept {
+  const size_t sample = counter_.fetch_add(1, std::memory_order_relaxed) % SAMPLES;
+  // zero means the empty sample
+  samples_[sample].store(std::max(latency, 1e-9), std::memory_order_relaxed);
+}
+
+std::array<double, 3> LatencySamples::calc_50_95_99_percentiles() const noexcept {
+  std::array<double, SAMPLES> samples{};
+  size_t size = 0;
+  for (const auto &sample : samples_) {
+    if (const double latency = sample.load(std::memory_order_relaxed)) {
+      samples[size++] = latency;
+    }
+  }
+  std::array<double, 3> result{};
+  if (size == 0) {
+    return result;
+  }
+  const size_t percentiles[] = {50, 95, 99};
+  for (size_t i = 0; i < result.size(); ++i) {
+    std::nth_element(samples.begin(), samples.begin() + percentiles[i] * size / 100, samples.begin() + size);
+    result[i] = samples[percentiles[i] * size / 100];
+  }
+  return result;
+}
+
 JobStats &JobStats::make() {
   void *shared_mem = mmap(nullptr, sizeof(JobStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
   auto *ctx = new (shared_mem) JobStats{};
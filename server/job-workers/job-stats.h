@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <cstddef>
 
@@ -11,6 +12,21 @@
 
 namespace job_workers {
 
+// the latency samples are collected by all the processes, the master calculates the percentiles
+class LatencySamples : vk::not_copyable {
+public:
+  void add(double latency) noexcept;
+
+  // 0 - 50 percentile, 1 - 95 percentile, 2 - 99 percentile
+  std::array<double, 3> calc_50_95_99_percentiles() const noexcept;
+
+private:
+  static constexpr size_t SAMPLES{1024};
+
+  std::atomic<size_t> counter_{0};
+  std::array<std::atomic<double>, SAMPLES> samples_{};
+};
+
 class JobStats : vk::not_copyable {
 public:
   std::atomic<int> job_queue_size{0};
@@ -22,11 +38,18 @@ public:
   std::atomic<size_t> errors_pipe_server_read{0};
   std::atomic<size_t> errors_pipe_client_write{0};
   std::atomic<size_t> errors_pipe_client_read{0};
+  std::atomic<size_t> errors_queue_server_push{0};
+  std::atomic<size_t> errors_queue_client_push{0};
 
   std::atomic<size_t> job_worker_skip_job_due_another_is_running{0};
   std::atomic<size_t> job_worker_skip_job_due_overload{0};
   std::atomic<size_t> job_worker_skip_job_due_steal{0};
 
+  // from the job is put to the queue by the client till it is started by the job worker
+  LatencySamples job_wait_time;
+  // from the job result is put to the queue by the job worker till it is got by the client
+  LatencySamples job_result_wait_time;
+
   // must be called from master process on global init
   static JobStats &get();
 
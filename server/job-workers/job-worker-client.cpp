@@ -6,6 +6,7 @@
 #include <unistd.h>
 
 #include "common/kprintf.h"
+#include "common/precise-time.h"
 
 #include "net/net-events.h"
 #include "net/net-reactor.h"
@@ -35,23 +36,22 @@ int JobWorkerClient::read_job_results(int fd, void *data __attribute__((unused))
     return 0;
   }
 
-  PipeJobReader::ReadStatus status{};
-
-  do {
-    JobSharedMessage *job_result = nullptr;
-    status = job_worker_client.job_reader.read_job_result(job_result);
-    if (status == PipeJobReader::READ_FAIL) {
-      JobStats::get().errors_pipe_client_read++;
-      return -1;
-    }
-    if (status == PipeJobReader::READ_OK) {
-      tvkprintf(job_workers, 2, "got job result: ready_job_id = %d, job_result_memory_ptr = %p\n", job_result->job_id, job_result);
-      if (create_job_worker_answer_event(job_result) <= 0) {
-        // TODO ERROR?
-        vk::singleton<SharedMemoryManager>::get().release_shared_message(job_result);
-      }
+  if (job_worker_client.job_reader.read_wakeups() == PipeJobReader::READ_FAIL) {
+    JobStats::get().errors_pipe_client_read++;
+    return -1;
+  }
+  // all the results are taken after the wakeups are read, the next wakeup is written only after this
+  auto &result_queue = *vk::singleton<JobWorkersContext>::get().result_queues[job_worker_client.job_result_fd_idx];
+  result_queue.on_wakeup();
+
+  while (JobSharedMessage *job_result = result_queue.pop()) {
+    tvkprintf(job_workers, 2, "got job result: ready_job_id = %d, job_result_memory_ptr = %p\n", job_result->job_id, job_result);
+    JobStats::get().job_result_wait_time.add(get_utime_monotonic() - job_result->queued_time);
+    if (create_job_worker_answer_event(job_result) <= 0) {
+      // TODO ERROR?
+      vk::singleton<SharedMemoryManager>::get().release_shared_message(job_result);
     }
-  } while (status != PipeJobReader::READ_BLOCK);
+  }
 
   return 0;
 }
@@ -93,11 +93,18 @@ int JobWorkerClient::send_job(JobSharedMessage *job_request) {
 
   job_request->job_id = job_id;
   job_request->job_result_fd_idx = job_result_fd_idx;
-  bool success = job_writer.write_job(job_request, write_job_fd);
-  if (!success) {
-    JobStats::get().errors_pipe_client_write++;
+  job_request->queued_time = get_utime_monotonic();
+  auto &job_queue = *vk::singleton<JobWorkersContext>::get().job_queue;
+  if (!job_queue.push(job_request)) {
+    JobStats::get().errors_queue_client_push++;
     return -1;
   }
+  // the job workers are woken up once for all the jobs pushed since the last wakeup
+  if (job_queue.request_wakeup() && !job_writer.write_wakeup(write_job_fd)) {
+    JobStats::get().errors_pipe_client_write++;
+    // the next job will try to wake up the job workers again
+    job_queue.on_wakeup();
+  }
 
   JobStats::get().job_queue_size++;
   JobStats::get().jobs_sent++;
@@ -7,6 +7,7 @@
 
 #include "common/kprintf.h"
 #include "common/pipe-utils.h"
+#include "common/precise-time.h"
 #include "common/timer.h"
 
 #include "net/net-events.h"
@@ -121,20 +122,27 @@ int JobWorkerServer::job_parse_execute(connection *c) {
     return 0;
   }
 
-  JobSharedMessage *job = nullptr;
-  PipeJobReader::ReadStatus status = job_reader.read_job(job);
+  if (job_reader.read_wakeups() == PipeJobReader::READ_FAIL) {
+    JobStats::get().errors_pipe_server_read++;
+    return -1;
+  }
+  // the job is taken after the wakeups are read, the next wakeup is written only after this
+  auto &job_queue = *vk::singleton<JobWorkersContext>::get().job_queue;
+  job_queue.on_wakeup();
 
-  if (status == PipeJobReader::READ_BLOCK) {
-    assert(errno == EWOULDBLOCK);
-    // another job worker has already taken the job (all job workers are readers for this fd)
-    // or there are no more jobs in pipe
+  JobSharedMessage *job = job_queue.pop();
+  if (!job) {
+    // another job worker has already taken the job or there are no more jobs in the queue
     has_delayed_jobs = false;
     JobStats::get().job_worker_skip_job_due_steal++;
     return 0;
-  } else if (status == PipeJobReader::READ_FAIL) {
-    JobStats::get().errors_pipe_server_read++;
-    return -1;
   }
+  // the rest of the jobs are left for other job workers
+  if (!job_queue.empty() && job_queue.request_wakeup() && !job_writer.write_wakeup(write_job_fd)) {
+    JobStats::get().errors_pipe_server_write++;
+    job_queue.on_wakeup();
+  }
+  JobStats::get().job_wait_time.add(get_utime_monotonic() - job->queued_time);
 
   JobStats::get().job_queue_size--;
   running_job = job;
@@ -159,8 +167,7 @@ void JobWorkerServer::init() {
   assert(job_workers_ctx.pipes_inited);
 
   read_job_fd = job_workers_ctx.job_pipe[0];
-  close(job_workers_ctx.job_pipe[1]); // this endpoint is for HTTP worker to write job
-  clear_event(job_workers_ctx.job_pipe[1]);
+  write_job_fd = job_workers_ctx.job_pipe[1]; // the job worker wakes up others, if there are more jobs
   for (auto &result_pipe : job_workers_ctx.result_pipes) {
     close(result_pipe[0]); // this endpoint is for HTTP worker to read job result
     clear_event(result_pipe[0]);
@@ -195,11 +202,17 @@ const char *JobWorkerServer::send_job_reply(JobSharedMessage *job_response) noex
     return "The reply has been already sent";
   }
 
-  int write_job_result_fd = vk::singleton<JobWorkersContext>::get().result_pipes.at(running_job->job_result_fd_idx)[1];
+  const auto &job_workers_ctx = vk::singleton<JobWorkersContext>::get();
+  auto &result_queue = *job_workers_ctx.result_queues.at(running_job->job_result_fd_idx);
   job_response->job_id = running_job->job_id;
-  if (!job_writer.write_job_result(job_response, write_job_result_fd)) {
+  job_response->queued_time = get_utime_monotonic();
+  if (!result_queue.push(job_response)) {
+    JobStats::get().errors_queue_server_push++;
+    return "Can't push job reply to the queue";
+  }
+  if (result_queue.request_wakeup() && !job_writer.write_wakeup(job_workers_ctx.result_pipes[running_job->job_result_fd_idx][1])) {
     JobStats::get().errors_pipe_server_write++;
-    return "Can't write job reply to the pipe";
+    result_queue.on_wakeup();
   }
   JobStats::get().jobs_replied++;
   reply_was_sent = true;
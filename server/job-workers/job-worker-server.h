@@ -42,6 +42,7 @@ private:
   PipeJobReader job_reader;
   bool has_delayed_jobs{false};
   int read_job_fd{-1};
+  int write_job_fd{-1};
   connection *read_job_connection{nullptr};
   bool reply_was_sent{false};
 
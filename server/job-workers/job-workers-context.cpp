@@ -9,6 +9,7 @@
 #include <unistd.h>
 
 #include "common/macos-ports.h"
+#include "runtime/job-workers/shared-memory-manager.h"
 #include "server/job-workers/job-workers-context.h"
 
 DEFINE_VERBOSITY(job_workers);
@@ -38,6 +39,14 @@ void JobWorkersContext::master_init_pipes(int job_result_slots_num) {
     }
   }
 
+  // each message is in one queue at most, so the queues can't overflow
+  const size_t queue_capacity = vk::singleton<SharedMemoryManager>::get().get_total_slices_count();
+  job_queue = SharedJobQueue::make(queue_capacity);
+  result_queues.resize(job_result_slots_num);
+  for (auto &result_queue : result_queues) {
+    result_queue = SharedJobQueue::make(queue_capacity);
+  }
+
   pipes_inited = true;
 }
 
@@ -13,6 +13,7 @@
 #include "common/mixin/not_copyable.h"
 #include "common/smart_ptrs/singleton.h"
 #include "server/job-workers/job-worker-server.h"
+#include "server/job-workers/shared-job-queue.h"
 
 DECLARE_VERBOSITY(job_workers);
 
@@ -32,10 +33,14 @@ public:
   size_t dying_job_workers{0};
   size_t job_workers_num{0};
 
+  // the pipes wake up the consumers of the queues
   Pipe job_pipe{};
   std::vector<Pipe> result_pipes;
   bool pipes_inited{false};
 
+  SharedJobQueue *job_queue{nullptr};
+  std::vector<SharedJobQueue *> result_queues;
+
   void master_init_pipes(int job_result_slots_num);
 
 private:
@@ -33,47 +33,19 @@ bool PipeJobWriter::write_to_pipe(int write_fd, const char *description) {
   return true;
 }
 
-bool PipeJobWriter::write_job(JobSharedMessage *job, int write_fd) {
+bool PipeJobWriter::write_wakeup(int write_fd) {
   reset();
-  copy_to_buffer(job);
-  return write_to_pipe(write_fd, "writing job");
+  copy_to_buffer(uint8_t{1});
+  return write_to_pipe(write_fd, "writing wakeup");
 }
 
-bool PipeJobWriter::write_job_result(JobSharedMessage *job_result, int write_fd) {
-  reset();
-  copy_to_buffer(job_result);
-  return write_to_pipe(write_fd, "writing result of job");
-}
-
-PipeJobReader::ReadStatus PipeJobReader::read_job(JobSharedMessage *&job) {
-  reset();
-  ReadStatus status = read_from_pipe(sizeof(JobSharedMessage *), "read job");
-  if (status == READ_OK) {
-    extract_from_buffer(job);
-  }
-  return status;
-}
-
-PipeJobReader::ReadStatus PipeJobReader::read_job_result(JobSharedMessage *&job_result) {
-  reset();
-  ReadStatus status = read_from_pipe(sizeof(JobSharedMessage *), "read result of job");
-  if (status == READ_OK) {
-    extract_from_buffer(job_result);
-  }
-  return status;
-}
-
-PipeJobReader::ReadStatus PipeJobReader::read_from_pipe(size_t bytes_cnt, const char *description) {
-  ssize_t read_bytes = read(read_fd, buf, bytes_cnt);
+PipeJobReader::ReadStatus PipeJobReader::read_wakeups() {
+  ssize_t read_bytes = read(read_fd, buf, sizeof(buf));
   if (read_bytes == -1) {
     if (errno == EWOULDBLOCK) {
       return READ_BLOCK;
     }
-    kprintf("Couldn't %s: %s\n", description, strerror(errno));
-    return READ_FAIL;
-  }
-  if (read_bytes != bytes_cnt) {
-    kprintf("Couldn't %s. Got %zd bytes, but expected %zd. Probably some jobs are written not atomically\n", description, bytes_cnt, read_bytes);
+    kprintf("Couldn't read wakeups: %s\n", strerror(errno));
     return READ_FAIL;
   }
   return READ_OK;
@@ -10,8 +10,6 @@
 
 namespace job_workers {
 
-struct JobSharedMessage;
-
 class PipeIO {
 public:
   void reset() {
@@ -36,10 +34,10 @@ protected:
   }
 };
 
+// the jobs and the job results are passed through the shared queues, the pipes only wake up the consumers
 class PipeJobWriter : public PipeIO {
 public:
-  bool write_job(JobSharedMessage *job, int write_fd);
-  bool write_job_result(JobSharedMessage *job_result, int write_fd);
+  bool write_wakeup(int write_fd);
 
 private:
   bool write_to_pipe(int write_fd, const char *description);
@@ -58,12 +56,10 @@ public:
     READ_BLOCK
   };
 
-  ReadStatus read_job(JobSharedMessage *&job);
-  ReadStatus read_job_result(JobSharedMessage *&job_result);
+  // reads all the pending wakeups
+  ReadStatus read_wakeups();
 private:
   int read_fd{-1};
-
-  ReadStatus read_from_pipe(size_t bytes_cnt, const char *description);
 };
 
 } // namespace job_workers
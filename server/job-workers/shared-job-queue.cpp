@@ -0,0 +1,85 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+
+#include "server/job-workers/shared-job-queue.h"
+
+namespace job_workers {
+
+SharedJobQueue *SharedJobQueue::make(size_t min_capacity) {
+  size_t capacity = 2;
+  while (capacity < min_capacity) {
+    capacity *= 2;
+  }
+  constexpr size_t header_size = (sizeof(SharedJobQueue) + 63) & -64;
+  void *shared_mem = mmap(nullptr, header_size + sizeof(Cell) * capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  assert(shared_mem != MAP_FAILED);
+  auto *cells = reinterpret_cast<Cell *>(static_cast<uint8_t *>(shared_mem) + header_size);
+  return new(shared_mem) SharedJobQueue{cells, capacity};
+}
+
+SharedJobQueue::SharedJobQueue(Cell *cells, size_t capacity) noexcept:
+  cells_(cells),
+  mask_(capacity - 1) {
+  for (size_t i = 0; i < capacity; ++i) {
+    new(&cells_[i].sequence) std::atomic<size_t>{i};
+    cells_[i].job = nullptr;
+  }
+}
+
+// The cell sequence tells the state of the cell for the position pos:
+//  pos - the cell is free for the producer,
+//  pos + 1 - the cell is filled for the consumer,
+//  pos + capacity - the cell is free for the producer of the next round.
+bool SharedJobQueue::push(JobSharedMessage *job) noexcept {
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Cell *cell = nullptr;
+  while (true) {
+    cell = &cells_[pos & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // the queue is full
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->job = job;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+JobSharedMessage *SharedJobQueue::pop() noexcept {
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  Cell *cell = nullptr;
+  while (true) {
+    cell = &cells_[pos & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // the queue is empty
+      return nullptr;
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  JobSharedMessage *job = cell->job;
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  return job;
+}
+
+} // namespace job_workers
@@ -0,0 +1,61 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "common/mixin/not_copyable.h"
+
+namespace job_workers {
+
+struct JobSharedMessage;
+
+/**
+ * Bounded lock-free multi-producer/multi-consumer queue of the jobs (or job results) in the shared memory.
+ * The pipes are used only for waking up the consumers: a producer writes to the pipe only if there is no pending wakeup.
+ */
+class SharedJobQueue : vk::not_copyable {
+public:
+  // must be called from master process before the workers are forked
+  static SharedJobQueue *make(size_t min_capacity);
+
+  bool push(JobSharedMessage *job) noexcept;
+  JobSharedMessage *pop() noexcept;
+
+  bool empty() const noexcept {
+    return enqueue_pos_.load(std::memory_order_acquire) == dequeue_pos_.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const noexcept {
+    return mask_ + 1;
+  }
+
+  // must be called after a push, returns true if the producer has to write a wakeup to the pipe
+  bool request_wakeup() noexcept {
+    return !wakeup_pending_.exchange(true);
+  }
+
+  // must be called by a consumer after the wakeups are read from the pipe and before the pops
+  void on_wakeup() noexcept {
+    wakeup_pending_.store(false);
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    JobSharedMessage *job;
+  };
+
+  SharedJobQueue(Cell *cells, size_t capacity) noexcept;
+
+  Cell *cells_{nullptr};
+  size_t mask_{0};
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) std::atomic<size_t> dequeue_pos_{0};
+  alignas(64) std::atomic<bool> wakeup_pending_{false};
+};
+
+} // namespace job_workers
@@ -202,6 +202,15 @@ void JsonLogger::set_env(vk::string_view env) noexcept {
 }
 
 void JsonLogger::write_log(vk::string_view message, int type, int64_t created_at, void *const *trace, int64_t trace_size, bool uncaught) noexcept {
+  write_log_impl(message, type, created_at, trace, trace_size, uncaught, {});
+}
+
+void JsonLogger::write_log_with_details(vk::string_view message, int type, int64_t created_at, vk::string_view details) noexcept {
+  write_log_impl(message, type, created_at, nullptr, 0, false, details);
+}
+
+void JsonLogger::write_log_impl(vk::string_view message, int type, int64_t created_at, void *const *trace, int64_t trace_size, bool uncaught,
+                                vk::string_view details) noexcept {
   if (json_log_fd_ <= 0) {
     return;
   }
@@ -233,6 +242,10 @@ void JsonLogger::write_log(vk::string_view message, int type, int64_t created_at
   }
   json_out_it->finish<']'>();
 
+  if (!details.empty()) {
+    json_out_it->append_key("details").start<'{'>().append_raw(details).finish<'}'>();
+  }
+
   json_out_it->append_key("msg").append_raw_string(message);
   json_out_it->finish_json_and_flush(json_log_fd_);
 }
@@ -31,12 +31,17 @@ public:
   void write_log(vk::string_view message, int type, int64_t created_at, void *const *trace, int64_t trace_size, bool uncaught) noexcept;
   void write_stack_overflow_log(int type, bool uncaught) noexcept;
   void write_script_timeout_log(int type, bool uncaught) noexcept;
+  // details is the raw content of a json object, which is written under the "details" key
+  void write_log_with_details(vk::string_view message, int type, int64_t created_at, vk::string_view details) noexcept;
 
   void reset_buffers() noexcept;
 
 private:
   JsonLogger() = default;
 
+  void write_log_impl(vk::string_view message, int type, int64_t created_at, void *const *trace, int64_t trace_size, bool uncaught,
+                      vk::string_view details) noexcept;
+
   int64_t release_version_{0};
   int json_log_fd_{-1};
 
@@ -73,6 +73,7 @@ int force_clear_sql_connection = 0;
 long long static_buffer_length_limit = -1;
 int use_madvise_dontneed = 0;
 long long memory_used_to_recreate_script = LLONG_MAX;
+double slow_request_json_log_time = 0;
 vk::optional<QueueTypesLeaseWorkerMode> cur_lease_mode;
 
 /***
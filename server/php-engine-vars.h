@@ -105,6 +105,8 @@ extern int force_clear_sql_connection;
 extern long long static_buffer_length_limit;
 extern int use_madvise_dontneed;
 extern long long memory_used_to_recreate_script;
+// the requests working longer are written into the json log with their cycle attribution, 0 means never
+extern double slow_request_json_log_time;
 extern vk::optional<QueueTypesLeaseWorkerMode> cur_lease_mode;
 
 #define RPC_PHP_IMMEDIATE_STATS 0x3d27a21b
@@ -121,10 +123,14 @@ extern vk::optional<QueueTypesLeaseWorkerMode> cur_lease_mode;
 #define SIGSTAT (SIGINFO)
 #define SIGPHPASSERT (SIGCONT)
 #define SIGSTACKOVERFLOW (SIGTSTP)
+#define SIGSAMPLINGPROFILER (SIGWINCH)
+#define SIGALLOCATIONPROFILER (SIGURG)
 #else
 #define SIGSTAT (SIGRTMIN)
 #define SIGPHPASSERT (SIGRTMIN + 1)
 #define SIGSTACKOVERFLOW (SIGRTMIN + 2)
+#define SIGSAMPLINGPROFILER (SIGRTMIN + 3)
+#define SIGALLOCATIONPROFILER (SIGRTMIN + 4)
 #endif
 
 #define MAX_WORKERS 999
@@ -53,10 +53,13 @@
 #include "net/net-tcp-rpc-client.h"
 #include "net/net-tcp-rpc-server.h"
 
+#include "runtime/cycle-attribution.h"
 #include "runtime/interface.h"
 #include "runtime/profiler.h"
 #include "runtime/job-workers/shared-memory-manager.h"
 #include "runtime/rpc.h"
+#include "runtime/udp.h"
+#include "server/allocation-profiler.h"
 #include "server/confdata-binlog-replay.h"
 #include "server/job-workers/job-worker-client.h"
 #include "server/job-workers/job-worker-server.h"
@@ -65,7 +68,9 @@
 #include "server/lease-config-parser.h"
 #include "server/php-engine-vars.h"
 #include "server/php-lease.h"
+#include "server/php-master-rpc-proxy.h"
 #include "server/php-master-warmup.h"
+#include "server/php-master-workers-scaler.h"
 #include "server/php-master.h"
 #include "server/php-mc-connections.h"
 #include "server/php-queries.h"
@@ -73,6 +78,7 @@
 #include "server/php-sql-connections.h"
 #include "server/php-worker-stats.h"
 #include "server/php-worker.h"
+#include "server/sampling-profiler.h"
 
 using job_workers::JobWorkersContext;
 using job_workers::JobWorkerClient;
@@ -134,6 +140,22 @@ conn_target_t rpc_ct = [] {
   return res;
 }();
 
+// The same as tcp_rpc_client_outbound, the distinct address only separates the proxied targets from the usual ones
+tcp_rpc_client_functions tcp_rpc_client_proxied = tcp_rpc_client_outbound;
+
+// Engines, which rpc queries are sent via the master (--rpc-proxy-via-master): the worker never connects to them
+conn_target_t rpc_proxied_ct = [] {
+  auto res = rpc_ct;
+  res.min_connections = 0;
+  res.max_connections = 0;
+  res.extra = (void *)&tcp_rpc_client_proxied;
+
+  return res;
+}();
+
+bool is_rpc_proxied_target(const conn_target_t *target) {
+  return target->extra == &tcp_rpc_client_proxied;
+}
 
 connection *get_target_connection(conn_target_t *S, int force_flag) {
   connection *c, *d = nullptr;
@@ -194,6 +216,14 @@ int get_target(const char *host, int port, conn_target_t *ct) {
   return get_target_impl(ct);
 }
 
+conn_target_t *get_rpc_proxy_master_target() {
+  static int master_target_id = -1;
+  if (master_target_id < 0) {
+    master_target_id = get_target_by_pid(INADDR_LOOPBACK, master_port, &rpc_ct);
+  }
+  return &Targets[master_target_id];
+}
+
 double fix_timeout(double timeout) {
   if (timeout < 0) {
     return 0;
@@ -274,6 +304,26 @@ command_t command_net_write_rpc_base = {
   .free = command_net_write_free
 };
 
+void command_net_write_run_rpc_proxy(command_t *base_command, void *data) {
+  auto *command = (command_net_write_t *)base_command;
+
+  slot_id_t slot_id = static_cast<slot_id_t>(command->extra);
+  assert (command->data != nullptr);
+  if (data == nullptr) { //send to /dev/null
+    vkprintf (3, "failed to send rpc request %d via master\n", slot_id);
+    on_net_event(create_rpc_error_event(slot_id, TL_ERROR_NO_CONNECTIONS, "Failed to send query to master, timeout expired", nullptr));
+  } else {
+    auto d = (connection *)data;
+    send_rpc_proxy_query(d, slot_id, (int *)command->data, command->len);
+    d->last_query_sent_time = precise_now;
+  }
+}
+
+command_t command_net_write_rpc_proxy_base = {
+  .run = command_net_write_run_rpc_proxy,
+  .free = command_net_write_free
+};
+
 
 command_t *create_command_net_writer(const char *data, int data_len, command_t *base, long long extra) {
   auto command = reinterpret_cast<command_net_write_t *>(malloc(sizeof(command_net_write_t)));
@@ -330,6 +380,23 @@ void send_rpc_query(connection *c, int op, long long id, int *q, int qsize) {
   TCP_RPCS_FUNC(c)->flush_packet(c);
 }
 
+void prepare_rpc_proxy_query(const conn_target_t *target, int *q, bool ignore_answer) {
+  const auto *endpoint = const_cast_sockaddr_storage_to_inet(&target->endpoint);
+  q[0] = RPC_PROXY_INVOKE_REQ;
+  q[1] = static_cast<int>(ntohl(endpoint->sin_addr.s_addr));
+  q[2] = ntohs(endpoint->sin_port) | (ignore_answer ? RPC_PROXY_FLAG_IGNORE_ANSWER : 0);
+}
+
+void send_rpc_proxy_query(connection *c, long long id, int *q, int qsize) {
+  // unlike send_rpc_query, the ints before the query id are the proxy header, and only the crc is skipped
+  *(long long *)(q + 3) = id;
+
+  vkprintf (4, "send_rpc_proxy_query: [len = %d] [rpc_id = <%lld>]\n", qsize, id);
+  tcp_rpc_conn_send_data(c, static_cast<int>(qsize - sizeof(int)), q);
+
+  TCP_RPCS_FUNC(c)->flush_packet(c);
+}
+
 void on_net_event(int event_status) {
   if (event_status == 0) {
     return;
@@ -1328,6 +1395,9 @@ void prepare_full_stats() {
 
   PhpWorkerStats::get_local().update_idle_time(epoll_total_idle_time(), get_uptime(),
                                                epoll_average_idle_time(), epoll_average_idle_quotient());
+  const auto &udp_stats = get_udp_batching_stats();
+  PhpWorkerStats::get_local().update_udp_stats(udp_stats.messages_sent, udp_stats.messages_batched,
+                                               udp_stats.messages_dropped, udp_stats.batches_sent);
   PhpWorkerStats::get_local().recalc_worker_percentiles();
   const int stats_size = PhpWorkerStats::get_local().write_into(s, s_left);
   s += stats_size;
@@ -2071,6 +2141,94 @@ int main_args_handler(int i) {
       vk::singleton<job_workers::SharedMemoryManager>::get().set_memory_limit(mbs * 1024 * 1024);
       return 0;
     }
+    case 2018: {
+      if (vk::singleton<SamplingProfiler>::get().set_log_prefix(optarg)) {
+        return 0;
+      }
+      kprintf("couldn't set sampling-profiler-log-prefix '%s'\n", optarg);
+      return -1;
+    }
+    case 2019: {
+      if (vk::singleton<SamplingProfiler>::get().set_frequency(atoi(optarg))) {
+        return 0;
+      }
+      kprintf("couldn't set sampling-profiler-frequency '%s', it is expected to be in [1, 1000] Hz\n", optarg);
+      return -1;
+    }
+    case 2020: {
+      if (vk::singleton<AllocationProfiler>::get().set_log_prefix(optarg)) {
+        return 0;
+      }
+      kprintf("couldn't set allocation-profiler-log-prefix '%s'\n", optarg);
+      return -1;
+    }
+    case 2021: {
+      if (vk::singleton<AllocationProfiler>::get().set_sampling_period(parse_memory_limit(optarg))) {
+        return 0;
+      }
+      kprintf("couldn't set allocation-profiler-sampling-period '%s', it is expected to be in [1k, 1g] bytes\n", optarg);
+      return -1;
+    }
+    case 2022: {
+      if (!*optarg) {
+        kprintf("--instance-cache-restart-dump-file option is empty\n");
+        return -1;
+      }
+      WarmUpContext::get().set_instance_cache_dump_file(optarg);
+      return 0;
+    }
+    case 2023: {
+      const int min_workers_n = atoi(optarg);
+      if (min_workers_n <= 0) {
+        kprintf("couldn't set min-workers-num '%s', it is expected to be positive\n", optarg);
+        return -1;
+      }
+      WorkersScaler::get().set_min_workers_n(std::min(min_workers_n, MAX_WORKERS));
+      return 0;
+    }
+    case 2024: {
+      const int max_messages = atoi(optarg);
+      if (max_messages < 0) {
+        kprintf("--udp-batch-messages has to be non negative\n");
+        return -1;
+      }
+      set_udp_batch_max_messages(max_messages);
+      return 0;
+    }
+    case 2025: {
+      const int64_t max_bytes = parse_memory_limit(optarg);
+      if (max_bytes <= 0 || max_bytes > (1 << 24)) {
+        kprintf("couldn't parse udp-batch-bytes argument, it has to be in (0, 16m]\n");
+        return -1;
+      }
+      set_udp_batch_max_bytes(static_cast<int>(max_bytes));
+      return 0;
+    }
+    case 2026: {
+      vk::singleton<CycleAttribution>::get().set_enabled(true);
+      return 0;
+    }
+    case 2027: {
+      slow_request_json_log_time = atof(optarg);
+      if (slow_request_json_log_time <= 0) {
+        kprintf("--cycle-attribution-slow-request-time has to be positive\n");
+        return -1;
+      }
+      vk::singleton<CycleAttribution>::get().set_enabled(true);
+      return 0;
+    }
+    case 2028: {
+      MasterRpcProxy::get().set_enabled(true);
+      return 0;
+    }
+    case 2029: {
+      double dump_timeout_sec = parse_double_option("--instance-cache-restart-dump-timeout", 0, 3600);
+      if (std::isnan(dump_timeout_sec)) {
+        return -1;
+      }
+      WarmUpContext::get().set_instance_cache_dump_max_time(std::chrono::duration<double>{dump_timeout_sec});
+      return 0;
+    }
     default:
       return -1;
   }
@@ -2140,6 +2298,18 @@ void parse_main_args(int argc, char *argv[]) {
   parse_option("warmup-timeout", required_argument, 2015, "the maximum time for the instance cache warm up in seconds");
   parse_option("job-workers-num", required_argument, 2016, "number of job workers to run");
   parse_option("job-workers-shared-memory-size", required_argument, 2017, "total size of shared memory in MBs used for job workers related communication");
+  parse_option("sampling-profiler-log-prefix", required_argument, 2018, "enable the sampling profiler, which can be toggled for a worker via master, and set its log path prefix");
+  parse_option("sampling-profiler-frequency", required_argument, 2019, "set the sampling profiler frequency in Hz (default: 99)");
+  parse_option("allocation-profiler-log-prefix", required_argument, 2020, "enable the script allocation profiler, which can be toggled for a worker via master, and set its log path prefix");
+  parse_option("allocation-profiler-sampling-period", required_argument, 2021, "set the allocation profiler sampling period in bytes, 'k', 'm' and 'g' suffixes are allowed (default: 512k)");
+  parse_option("instance-cache-restart-dump-file", required_argument, 2022, "pass the instance cache to the new server version through this file on the graceful restart");
+  parse_option("min-workers-num", required_argument, 2023, "scale the number of workers between min-workers-num and workers-num depending on the load and the host memory");
+  parse_option("udp-batch-messages", required_argument, 2024, "queue the datagrams written into udp streams and send them by sendmmsg in batches of at most this number (default: 0, no batching)");
+  parse_option("udp-batch-bytes", required_argument, 2025, "max total size of the queued datagrams, 'k' and 'm' suffixes are allowed (default: 64k)");
+  parse_option("cycle-attribution", no_argument, 2026, "count the cpu cycles spent in json, regexps, serialization, tl and instance cache per request");
+  parse_option("cycle-attribution-slow-request-time", required_argument, 2027, "write the requests working longer than this time in seconds into the json log with their cycle attribution, implies --cycle-attribution");
+  parse_option("rpc-proxy-via-master", no_argument, 2028, "send the rpc queries of workers via the master port, the master multiplexes them onto a few connections per backend");
+  parse_option("instance-cache-restart-dump-timeout", required_argument, 2029, "the maximum time in seconds the new master waits for the instance cache dump of the old one on the graceful restart, set it according to the instance cache size (default: 5)");
   parse_engine_options_long(argc, argv, main_args_handler);
   parse_main_args_till_option(argc, argv);
 }
@@ -2227,6 +2397,11 @@ int run_main(int argc, char **argv, php_mode mode) {
     setvbuf(stdout, nullptr, _IONBF, 0);
   }
 
+  if (MasterRpcProxy::get().is_enabled() && (run_once || master_port <= 0)) {
+    kprintf("--rpc-proxy-via-master requires the master port, rpc queries will be sent directly\n");
+    MasterRpcProxy::get().set_enabled(false);
+  }
+
   load_time = -dl_time();
 
   init_default();
@@ -39,10 +39,18 @@ struct conn_query_functions;
 extern conn_query_functions pending_cq_func;
 
 extern command_t command_net_write_rpc_base;
+extern command_t command_net_write_rpc_proxy_base;
 
 extern conn_target_t rpc_ct;
+extern conn_target_t rpc_proxied_ct;
 
 void send_rpc_query(connection *c, int op, long long id, int *q, int qsize) ubsan_supp("alignment");
+
+bool is_rpc_proxied_target(const conn_target_t *target);
+conn_target_t *get_rpc_proxy_master_target();
+// fills the proxy header of the query buffer prepared for send_rpc_query
+void prepare_rpc_proxy_query(const conn_target_t *target, int *q, bool ignore_answer);
+void send_rpc_proxy_query(connection *c, long long id, int *q, int qsize) ubsan_supp("alignment");
 void on_net_event(int event_status);
 void create_delayed_send_query(conn_target_t *t, command_t *command, double finish_time);
 
@@ -33,7 +33,10 @@ struct master_data_t {
 
   uint32_t instance_cache_elements_cached;
 
-  int reserved[50 - 1];
+  int ask_instance_cache_dump_generation;
+  int sent_instance_cache_dump_generation;
+
+  int reserved[50 - 3];
 };
 
 struct shared_data_t {
@@ -0,0 +1,295 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/php-master-rpc-proxy.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+
+#include "common/kprintf.h"
+#include "common/precise-time.h"
+#include "common/rpc-error-codes.h"
+#include "common/tl/constants/common.h"
+#include "net/net-sockaddr-storage.h"
+#include "net/net-tcp-rpc-client.h"
+#include "net/net-tcp-rpc-common.h"
+#include "net/net-tcp-rpc-server.h"
+#include "server/php-engine.h"
+
+namespace {
+
+// the rpc query timeouts of the workers are capped by 30 seconds too
+constexpr double PROXIED_QUERY_TIMEOUT_SEC = 30;
+
+int rpc_proxy_backend_execute(connection *c, int op, raw_message_t *raw) {
+  c->last_response_time = precise_now;
+  if (static_cast<unsigned int>(op) != TL_RPC_REQ_RESULT && static_cast<unsigned int>(op) != TL_RPC_REQ_ERROR) {
+    return 0;
+  }
+  return MasterRpcProxy::get().forward_answer(c, raw);
+}
+
+int rpc_proxy_backend_ready(connection *c) {
+  c->last_query_sent_time = precise_now;
+  c->last_response_time = precise_now;
+  MasterRpcProxy::get().on_backend_ready(c);
+  return 0;
+}
+
+int rpc_proxy_backend_close(connection *c, int who __attribute__((unused))) {
+  MasterRpcProxy::get().on_backend_closed(c);
+  return 0;
+}
+
+tcp_rpc_client_functions rpc_proxy_backend_methods = [] {
+  auto res = tcp_rpc_client_functions();
+  res.execute = rpc_proxy_backend_execute;
+  res.check_ready = default_tcp_rpc_client_check_ready;
+  // the queries of the same event loop iteration are written together
+  res.flush_packet = tcp_rpcc_flush_packet_later;
+  res.rpc_check_perm = tcp_rpcc_default_check_perm;
+  res.rpc_init_crypto = tcp_rpcc_init_crypto;
+  res.rpc_start_crypto = tcp_rpcc_start_crypto;
+  res.rpc_ready = rpc_proxy_backend_ready;
+  res.rpc_close = rpc_proxy_backend_close;
+
+  return res;
+}();
+
+conn_target_t rpc_proxy_backend_ct = [] {
+  auto res = conn_target_t();
+  res.min_connections = 2;
+  res.max_connections = 3;
+  res.type = &ct_tcp_rpc_client;
+  res.extra = (void *)&rpc_proxy_backend_methods;
+  res.reconnect_timeout = 1;
+
+  return res;
+}();
+
+uint64_t backend_key(uint32_t ip, uint16_t port) {
+  return (uint64_t{ip} << 16) | port;
+}
+
+uint64_t backend_key(const conn_target_t *target) {
+  const auto *endpoint = const_cast_sockaddr_storage_to_inet(&target->endpoint);
+  return backend_key(ntohl(endpoint->sin_addr.s_addr), ntohs(endpoint->sin_port));
+}
+
+} // namespace
+
+int MasterRpcProxy::forward_query(connection *worker_conn, raw_message_t *raw) noexcept {
+  int header[5];
+  if (!enabled_ || rwm_fetch_data(raw, header, sizeof(header)) != sizeof(header)) {
+    return 0;
+  }
+
+  const int64_t qid = ++last_qid_;
+  ProxiedQuery &query = queries_[qid];
+  query.backend = get_backend(static_cast<uint32_t>(header[1]), static_cast<uint16_t>(header[2]));
+  query.worker_fd = worker_conn->fd;
+  query.worker_generation = worker_conn->generation;
+  memcpy(&query.worker_qid, header + 3, sizeof(query.worker_qid));
+  query.ignore_answer = header[2] & RPC_PROXY_FLAG_IGNORE_ANSWER;
+  query.received_time = precise_now;
+  query.raw = *raw;
+
+  ++query.backend->queries;
+  query.backend->queue.push_back(qid);
+  send_queued(*query.backend);
+  return 1;
+}
+
+int MasterRpcProxy::forward_answer(connection *backend_conn __attribute__((unused)), raw_message_t *raw) noexcept {
+  int header[3];
+  if (rwm_fetch_data(raw, header, sizeof(header)) != sizeof(header)) {
+    return 0;
+  }
+  int64_t qid = 0;
+  memcpy(&qid, header + 1, sizeof(qid));
+  auto it = queries_.find(qid);
+  if (it == queries_.end() || it->second.backend_fd < 0) {
+    // the query has been expired already
+    return 0;
+  }
+
+  ProxiedQuery &query = it->second;
+  Backend &backend = *query.backend;
+  --backend.in_flight;
+  ++backend.answered;
+  backend.response_time_sum += precise_now - query.sent_time;
+  if (static_cast<unsigned int>(header[0]) == TL_RPC_REQ_ERROR) {
+    ++backend.errors;
+  }
+
+  int res = 0;
+  connection *worker_conn = &Connections[query.worker_fd];
+  if (worker_conn->generation == query.worker_generation) {
+    memcpy(header + 1, &query.worker_qid, sizeof(query.worker_qid));
+    rwm_push_data_front(raw, header, sizeof(header));
+    tcp_rpc_conn_send(worker_conn, raw, 0);
+    TCP_RPCS_FUNC(worker_conn)->flush_packet(worker_conn);
+    res = 1;
+  }
+  queries_.erase(it);
+  return res;
+}
+
+void MasterRpcProxy::on_backend_ready(connection *backend_conn) noexcept {
+  auto it = backends_.find(backend_key(backend_conn->target));
+  if (it != backends_.end()) {
+    send_queued(it->second);
+  }
+}
+
+void MasterRpcProxy::on_backend_closed(connection *backend_conn) noexcept {
+  for (auto it = queries_.begin(); it != queries_.end();) {
+    ProxiedQuery &query = it->second;
+    if (query.backend_fd != backend_conn->fd || query.backend_generation != backend_conn->generation) {
+      ++it;
+      continue;
+    }
+    --query.backend->in_flight;
+    answer_with_error(query, TL_ERROR_NO_CONNECTIONS, "Connection to the backend is closed in the rpc proxy of master");
+    it = queries_.erase(it);
+  }
+}
+
+void MasterRpcProxy::cron() noexcept {
+  for (auto it = queries_.begin(); it != queries_.end();) {
+    ProxiedQuery &query = it->second;
+    if (precise_now - query.received_time < PROXIED_QUERY_TIMEOUT_SEC) {
+      ++it;
+      continue;
+    }
+    if (query.backend_fd < 0) {
+      rwm_free(&query.raw);
+      answer_with_error(query, TL_ERROR_NO_CONNECTIONS, "Failed to send query, timeout expired in the rpc proxy of master");
+    } else {
+      --query.backend->in_flight;
+      answer_with_error(query, TL_ERROR_QUERY_TIMEOUT, "Query timeout in the rpc proxy of master");
+    }
+    it = queries_.erase(it);
+  }
+
+  for (auto &it : backends_) {
+    Backend &backend = it.second;
+    backend.queue.erase(std::remove_if(backend.queue.begin(), backend.queue.end(),
+                                       [this](int64_t qid) { return !queries_.count(qid); }),
+                        backend.queue.end());
+    send_queued(backend);
+
+    backend.last_queue_time_avg = backend.sent ? backend.queue_time_sum / static_cast<double>(backend.sent) : 0;
+    backend.last_queue_time_max = backend.queue_time_max;
+    backend.last_response_time_avg = backend.answered ? backend.response_time_sum / static_cast<double>(backend.answered) : 0;
+    backend.queue_time_sum = 0;
+    backend.queue_time_max = 0;
+    backend.response_time_sum = 0;
+    backend.sent = 0;
+    backend.answered = 0;
+  }
+}
+
+void MasterRpcProxy::write_stats_to(stats_t *stats) const noexcept {
+  if (!enabled_) {
+    return;
+  }
+  int64_t queries = 0;
+  int64_t errors = 0;
+  int64_t in_flight = 0;
+  int64_t queued = 0;
+  for (const auto &it : backends_) {
+    const Backend &backend = it.second;
+    queries += backend.queries;
+    errors += backend.errors;
+    in_flight += backend.in_flight;
+    queued += static_cast<int64_t>(backend.queue.size());
+
+    const std::string &prefix = backend.stats_prefix;
+    add_histogram_stat_long(stats, (prefix + "queries").c_str(), backend.queries);
+    add_histogram_stat_long(stats, (prefix + "errors").c_str(), backend.errors);
+    add_histogram_stat_long(stats, (prefix + "in_flight").c_str(), backend.in_flight);
+    add_histogram_stat_long(stats, (prefix + "queued").c_str(), static_cast<int64_t>(backend.queue.size()));
+    add_histogram_stat_long(stats, (prefix + "connections").c_str(), backend.target->ready_outbound_connections);
+    add_histogram_stat_double(stats, (prefix + "queue_time.avg").c_str(), backend.last_queue_time_avg);
+    add_histogram_stat_double(stats, (prefix + "queue_time.max").c_str(), backend.last_queue_time_max);
+    add_histogram_stat_double(stats, (prefix + "response_time.avg").c_str(), backend.last_response_time_avg);
+  }
+  add_histogram_stat_long(stats, "rpc_proxy.backends", static_cast<int64_t>(backends_.size()));
+  add_histogram_stat_long(stats, "rpc_proxy.queries", queries);
+  add_histogram_stat_long(stats, "rpc_proxy.errors", errors);
+  add_histogram_stat_long(stats, "rpc_proxy.in_flight", in_flight);
+  add_histogram_stat_long(stats, "rpc_proxy.queued", queued);
+}
+
+MasterRpcProxy::Backend *MasterRpcProxy::get_backend(uint32_t ip, uint16_t port) noexcept {
+  const uint64_t key = backend_key(ip, port);
+  auto it = backends_.find(key);
+  if (it != backends_.end()) {
+    return &it->second;
+  }
+
+  Backend &backend = backends_[key];
+  conn_target_t target = rpc_proxy_backend_ct;
+  target.endpoint = make_inet_sockaddr_storage(ip, port);
+  backend.target = create_target(&target, nullptr);
+
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "rpc_proxy.backend.%u_%u_%u_%u_%u.", ip >> 24, (ip >> 16) & 0xff, (ip >> 8) & 0xff, ip & 0xff, port);
+  backend.stats_prefix = prefix;
+  vkprintf(1, "rpc proxy: new backend %s\n", sockaddr_storage_to_string(&backend.target->endpoint));
+
+  create_new_connections(backend.target);
+  return &backend;
+}
+
+void MasterRpcProxy::send_queued(Backend &backend) noexcept {
+  while (!backend.queue.empty()) {
+    connection *c = get_target_connection(backend.target, 0);
+    if (c == nullptr) {
+      create_new_connections(backend.target);
+      return;
+    }
+
+    const int64_t qid = backend.queue.front();
+    backend.queue.pop_front();
+    auto it = queries_.find(qid);
+    if (it == queries_.end()) {
+      continue;
+    }
+
+    ProxiedQuery &query = it->second;
+    int header[3] = {static_cast<int>(TL_RPC_INVOKE_REQ)};
+    memcpy(header + 1, &qid, sizeof(qid));
+    rwm_push_data_front(&query.raw, header, sizeof(header));
+    // the connection output takes the query buffers
+    tcp_rpc_conn_send(c, &query.raw, 0);
+    TCP_RPCC_FUNC(c)->flush_packet(c);
+    c->last_query_sent_time = precise_now;
+
+    const double queue_time = precise_now - query.received_time;
+    ++backend.sent;
+    backend.queue_time_sum += queue_time;
+    backend.queue_time_max = std::max(backend.queue_time_max, queue_time);
+
+    if (query.ignore_answer) {
+      // nobody waits for the answer, so it's not waited in the proxy either: a late answer is just dropped
+      queries_.erase(it);
+      continue;
+    }
+    query.backend_fd = c->fd;
+    query.backend_generation = c->generation;
+    query.sent_time = precise_now;
+    ++backend.in_flight;
+  }
+}
+
+void MasterRpcProxy::answer_with_error(ProxiedQuery &query, int error_code, const char *error) noexcept {
+  ++query.backend->errors;
+  connection *worker_conn = &Connections[query.worker_fd];
+  if (worker_conn->generation == query.worker_generation) {
+    server_rpc_error(worker_conn, query.worker_qid, error_code, error);
+  }
+}
@@ -0,0 +1,98 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "common/smart_ptrs/singleton.h"
+#include "common/stats/provider.h"
+#include "net/net-connections.h"
+#include "net/net-msg.h"
+
+// With --rpc-proxy-via-master the workers don't connect to the rpc backends themselves,
+// they send all rpc queries to the master port, and the master multiplexes them onto a small pool of long-lived connections
+// per backend: the queries of all workers are pipelined through the same connections.
+//
+// The proxied query is [RPC_PROXY_INVOKE_REQ] [backend ipv4] [backend port | flags] [query_id:long] [query...],
+// the master answers with the usual rpcReqResult or rpcReqError with the same query_id.
+constexpr int RPC_PROXY_INVOKE_REQ = 0x5d19e3a7;
+// the worker doesn't wait for the answer, the master completes the query as soon as it is sent to the backend
+constexpr int RPC_PROXY_FLAG_IGNORE_ANSWER = 1 << 16;
+
+class MasterRpcProxy : public vk::singleton<MasterRpcProxy> {
+public:
+  void set_enabled(bool enabled) noexcept {
+    enabled_ = enabled;
+  }
+
+  bool is_enabled() const noexcept {
+    return enabled_;
+  }
+
+  // these functions take the ownership of raw and return 1, or return 0 if raw should be freed by the caller
+  int forward_query(connection *worker_conn, raw_message_t *raw) noexcept;
+  int forward_answer(connection *backend_conn, raw_message_t *raw) noexcept;
+
+  void on_backend_ready(connection *backend_conn) noexcept;
+  void on_backend_closed(connection *backend_conn) noexcept;
+
+  // should be called by the master every second
+  void cron() noexcept;
+
+  void write_stats_to(stats_t *stats) const noexcept;
+
+private:
+  MasterRpcProxy() = default;
+
+  friend vk::singleton<MasterRpcProxy>;
+
+  struct Backend {
+    conn_target_t *target{nullptr};
+    std::string stats_prefix;
+    // the queries waiting for a ready connection
+    std::deque<int64_t> queue;
+    int64_t in_flight{0};
+
+    int64_t queries{0};
+    int64_t errors{0};
+
+    // the queueing and the response times of the current and of the last second
+    double queue_time_sum{0};
+    double queue_time_max{0};
+    double response_time_sum{0};
+    int64_t sent{0};
+    int64_t answered{0};
+    double last_queue_time_avg{0};
+    double last_queue_time_max{0};
+    double last_response_time_avg{0};
+  };
+
+  struct ProxiedQuery {
+    Backend *backend{nullptr};
+    // the worker connection is identified by fd and generation, it may be closed and reused before the answer
+    int worker_fd{-1};
+    int worker_generation{0};
+    int64_t worker_qid{0};
+    bool ignore_answer{false};
+    int backend_fd{-1};
+    int backend_generation{0};
+    double received_time{0};
+    double sent_time{0};
+    // the query itself, until it is sent to the backend
+    raw_message_t raw;
+  };
+
+  Backend *get_backend(uint32_t ip, uint16_t port) noexcept;
+  void send_queued(Backend &backend) noexcept;
+  void answer_with_error(ProxiedQuery &query, int error_code, const char *error) noexcept;
+
+  bool enabled_{false};
+  int64_t last_qid_{0};
+  std::unordered_map<uint64_t, Backend> backends_;
+  std::unordered_map<int64_t, ProxiedQuery> queries_;
+};
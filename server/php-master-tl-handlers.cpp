@@ -16,6 +16,7 @@
 #include "common/server/stats.h"
 
 #include "net/net-msg.h"
+#include "server/php-master-rpc-proxy.h"
 #include "server/php-master-tl-handlers.h"
 
 static bool fetch_function() {
@@ -232,6 +233,10 @@ static void tl_rpc_invoke_req_handler(connection *connection) {
 }
 
 int master_rpc_tl_execute(connection *c, int op, raw_message_t *raw) {
+  if (op == RPC_PROXY_INVOKE_REQ) {
+    return MasterRpcProxy::get().forward_query(c, raw);
+  }
+
   raw_message_t r;
   rwm_clone(&r, raw);
   tl_fetch_init_raw_message(&r);
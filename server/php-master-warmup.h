@@ -5,6 +5,7 @@
 #pragma once
 
 #include <chrono>
+#include <string>
 
 #include "common/smart_ptrs/singleton.h"
 #include "common/timer.h"
@@ -64,6 +65,40 @@ public:
   void set_warm_up_max_time(const std::chrono::duration<double> &warm_up_max_time) {
     this->warm_up_max_time_ = warm_up_max_time;
   }
+
+  void set_instance_cache_dump_file(const char *instance_cache_dump_file) {
+    this->instance_cache_dump_file_ = instance_cache_dump_file;
+  }
+
+  void set_instance_cache_dump_max_time(const std::chrono::duration<double> &instance_cache_dump_max_time) {
+    this->instance_cache_dump_max_time_ = instance_cache_dump_max_time;
+  }
+
+  const std::string &get_instance_cache_dump_file() const {
+    return instance_cache_dump_file_;
+  }
+
+  // the new master waits for the instance cache dump of the old master before running workers
+  bool need_instance_cache_dump() const {
+    return !instance_cache_dump_file_.empty() && !instance_cache_dump_received_;
+  }
+
+  void on_instance_cache_dump_asked() {
+    instance_cache_dump_timer_.start();
+  }
+
+  bool instance_cache_dump_asked() const {
+    return instance_cache_dump_timer_.is_started();
+  }
+
+  // the old server version may not support the dump, or the dump of a big instance cache may take too long
+  bool instance_cache_dump_timeout_expired() const {
+    return instance_cache_dump_timer_.time() > instance_cache_dump_max_time_;
+  }
+
+  void on_instance_cache_dump_received() {
+    instance_cache_dump_received_ = true;
+  }
 private:
   double workers_part_for_warm_up_{1};
   double target_instance_cache_elements_part_{0};
@@ -75,6 +110,11 @@ private:
   uint32_t final_old_instance_cache_size_{0};
   bool final_instance_cache_sizes_saved_{false};
 
+  std::string instance_cache_dump_file_;
+  std::chrono::duration<double> instance_cache_dump_max_time_{5.0};
+  vk::SteadyTimer<std::chrono::milliseconds> instance_cache_dump_timer_{};
+  bool instance_cache_dump_received_{false};
+
   WarmUpContext() = default;
 
   friend vk::singleton<WarmUpContext>;
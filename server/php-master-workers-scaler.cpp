@@ -0,0 +1,160 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/php-master-workers-scaler.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "common/kprintf.h"
+
+namespace {
+
+// workers are added, if at least this part of them is busy
+constexpr double BUSY_WORKERS_SCALE_UP_RATIO = 0.9;
+// or if their idle percent is lower
+constexpr double IDLE_PERCENT_SCALE_UP = 10;
+// workers are removed, if no more than this part of them is busy and their idle percent is higher
+constexpr double BUSY_WORKERS_SCALE_DOWN_RATIO = 0.5;
+constexpr double IDLE_PERCENT_SCALE_DOWN = 50;
+// the minimal interval between the scalings up, it lets the new workers start
+constexpr double SCALE_UP_COOLDOWN_SEC = 5;
+// workers must be underloaded for this time to be removed, it protects from the oscillations
+constexpr double SCALE_DOWN_DELAY_SEC = 30;
+
+const char *decision_name(WorkersScaler::Decision decision) {
+  switch (decision) {
+    case WorkersScaler::Decision::keep:
+      return "keep";
+    case WorkersScaler::Decision::scale_up:
+      return "scale up";
+    case WorkersScaler::Decision::scale_down:
+      return "scale down";
+    case WorkersScaler::Decision::scale_down_due_memory:
+      return "scale down due memory";
+  }
+  return "unknown";
+}
+
+} // namespace
+
+void WorkersScaler::set_max_workers_n(int max_workers_n) noexcept {
+  max_workers_n_ = max_workers_n;
+  // all workers are run at start, the extra ones are removed when the load is known
+  target_workers_n_ = max_workers_n;
+  last_scaling_time_ = 0;
+  underloaded_since_ = -1;
+}
+
+WorkersScaler::Decision WorkersScaler::update(const WorkersScalerInputs &inputs, double now) noexcept {
+  last_inputs_ = inputs;
+  last_decision_ = Decision::keep;
+  if (!is_enabled()) {
+    return last_decision_;
+  }
+
+  const double workers = std::max(inputs.running_workers, 1);
+  const bool is_memory_known = inputs.mem_available >= 0 && worker_memory_ > 0;
+  const bool is_short_of_memory = is_memory_known && inputs.mem_available < worker_memory_;
+  const bool is_overloaded = inputs.accept_queue > 0 ||
+                             inputs.busy_workers >= BUSY_WORKERS_SCALE_UP_RATIO * workers ||
+                             inputs.idle_percent < IDLE_PERCENT_SCALE_UP;
+  const bool is_underloaded = inputs.accept_queue <= 0 &&
+                              inputs.busy_workers <= BUSY_WORKERS_SCALE_DOWN_RATIO * workers &&
+                              inputs.idle_percent > IDLE_PERCENT_SCALE_DOWN;
+  underloaded_since_ = is_underloaded ? (underloaded_since_ < 0 ? now : underloaded_since_) : -1;
+
+  if (is_short_of_memory) {
+    // a worker is removed, even if it is needed, the host mustn't run out of memory
+    if (target_workers_n_ > min_workers_n_) {
+      --target_workers_n_;
+      ++scale_downs_due_memory_;
+      last_decision_ = Decision::scale_down_due_memory;
+    }
+  } else if (is_overloaded && target_workers_n_ < max_workers_n_ && now - last_scaling_time_ >= SCALE_UP_COOLDOWN_SEC) {
+    // a quarter of the current workers are added at once, so the peak is reached in a few steps
+    int step = std::max(target_workers_n_ / 4, 1);
+    if (is_memory_known) {
+      step = static_cast<int>(std::min<int64_t>(step, inputs.mem_available / worker_memory_ - 1));
+    }
+    if (step > 0) {
+      target_workers_n_ = std::min(target_workers_n_ + step, max_workers_n_);
+      ++scale_ups_;
+      last_decision_ = Decision::scale_up;
+    } else {
+      ++scale_ups_blocked_by_memory_;
+    }
+  } else if (underloaded_since_ >= 0 && now - underloaded_since_ >= SCALE_DOWN_DELAY_SEC && target_workers_n_ > min_workers_n_) {
+    // workers are removed one by one
+    --target_workers_n_;
+    ++scale_downs_;
+    underloaded_since_ = now;
+    last_decision_ = Decision::scale_down;
+  }
+
+  if (last_decision_ != Decision::keep) {
+    last_scaling_time_ = now;
+    vkprintf(1, "workers scaler: %s to %d workers [running = %d] [busy = %d] [idle_percent = %.1f] [accept_queue = %" PRIi64 "] [mem_available = %" PRIi64 "]\n",
+             decision_name(last_decision_), target_workers_n_, inputs.running_workers, inputs.busy_workers, inputs.idle_percent,
+             inputs.accept_queue, inputs.mem_available);
+  }
+  return last_decision_;
+}
+
+void WorkersScaler::write_stats_to(stats_t *stats) const noexcept {
+  if (!is_enabled()) {
+    return;
+  }
+  add_histogram_stat_long(stats, "workers.scaler.target", target_workers_n_);
+  add_histogram_stat_long(stats, "workers.scaler.min", min_workers_n_);
+  add_histogram_stat_long(stats, "workers.scaler.max", max_workers_n_);
+  add_histogram_stat_long(stats, "workers.scaler.last_decision", static_cast<long long>(last_decision_));
+  add_histogram_stat_long(stats, "workers.scaler.scale_ups", scale_ups_);
+  add_histogram_stat_long(stats, "workers.scaler.scale_downs", scale_downs_);
+  add_histogram_stat_long(stats, "workers.scaler.scale_downs_due_memory", scale_downs_due_memory_);
+  add_histogram_stat_long(stats, "workers.scaler.scale_ups_blocked_by_memory", scale_ups_blocked_by_memory_);
+  add_histogram_stat_long(stats, "workers.scaler.inputs.busy_workers", last_inputs_.busy_workers);
+  add_histogram_stat_double(stats, "workers.scaler.inputs.idle_percent", last_inputs_.idle_percent);
+  add_histogram_stat_long(stats, "workers.scaler.inputs.accept_queue", last_inputs_.accept_queue);
+  add_histogram_stat_long(stats, "workers.scaler.inputs.mem_available", last_inputs_.mem_available);
+}
+
+int64_t get_listen_socket_accept_queue(int fd) noexcept {
+#if defined(__linux__)
+  // for the listening sockets the kernel reports the accept queue length in tcpi_unacked
+  tcp_info info;
+  memset(&info, 0, sizeof(info));
+  socklen_t info_len = sizeof(info);
+  if (fd < 0 || getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &info_len) != 0 || info.tcpi_state != TCP_LISTEN) {
+    return -1;
+  }
+  return info.tcpi_unacked;
+#else
+  static_cast<void>(fd);
+  return -1;
+#endif
+}
+
+int64_t get_host_mem_available() noexcept {
+  FILE *meminfo = fopen("/proc/meminfo", "r");
+  if (!meminfo) {
+    return -1;
+  }
+  int64_t mem_available = -1;
+  char line[256];
+  while (fgets(line, sizeof(line), meminfo)) {
+    long long value_kb = 0;
+    if (sscanf(line, "MemAvailable: %lld kB", &value_kb) == 1) {
+      mem_available = value_kb << 10;
+      break;
+    }
+  }
+  fclose(meminfo);
+  return mem_available;
+}
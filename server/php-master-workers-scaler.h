@@ -0,0 +1,84 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2021 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/smart_ptrs/singleton.h"
+#include "common/stats/provider.h"
+
+// The master scales the number of the running http workers between --min-workers-num and --workers-num:
+// workers are added while the requests wait in the listen backlog or almost all workers are busy,
+// and removed when workers are idle for a while or the host is short of memory.
+struct WorkersScalerInputs {
+  int running_workers{0};
+  // workers, which are executing requests right now
+  int busy_workers{0};
+  // the average recent idle percent of the workers
+  double idle_percent{100};
+  // the listen backlog length of the http socket, -1 if unknown
+  int64_t accept_queue{-1};
+  // MemAvailable of the host, -1 if unknown
+  int64_t mem_available{-1};
+};
+
+class WorkersScaler : public vk::singleton<WorkersScaler> {
+public:
+  enum class Decision {
+    keep,
+    scale_up,
+    scale_down,
+    scale_down_due_memory
+  };
+
+  void set_min_workers_n(int min_workers_n) noexcept {
+    min_workers_n_ = min_workers_n;
+  }
+
+  // the memory, that should be available on the host for each new worker
+  void set_worker_memory(int64_t worker_memory) noexcept {
+    worker_memory_ = worker_memory;
+  }
+
+  void set_max_workers_n(int max_workers_n) noexcept;
+
+  bool is_enabled() const noexcept {
+    return min_workers_n_ > 0 && min_workers_n_ < max_workers_n_;
+  }
+
+  int get_target_workers_n() const noexcept {
+    return target_workers_n_;
+  }
+
+  // should be called periodically by the master, now is in seconds
+  Decision update(const WorkersScalerInputs &inputs, double now) noexcept;
+
+  void write_stats_to(stats_t *stats) const noexcept;
+
+private:
+  WorkersScaler() = default;
+
+  friend vk::singleton<WorkersScaler>;
+
+  int min_workers_n_{0};
+  int max_workers_n_{0};
+  int target_workers_n_{0};
+  int64_t worker_memory_{0};
+
+  double last_scaling_time_{0};
+  // the time since the workers are continuously underloaded
+  double underloaded_since_{-1};
+
+  WorkersScalerInputs last_inputs_;
+  Decision last_decision_{Decision::keep};
+  int64_t scale_ups_{0};
+  int64_t scale_downs_{0};
+  int64_t scale_downs_due_memory_{0};
+  int64_t scale_ups_blocked_by_memory_{0};
+};
+
+// these functions return -1 on errors
+int64_t get_listen_socket_accept_queue(int fd) noexcept;
+int64_t get_host_mem_available() noexcept;
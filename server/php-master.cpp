@@ -47,6 +47,7 @@
 #include "net/net-tcp-rpc-client.h"
 #include "net/net-tcp-rpc-server.h"
 
+#include "runtime/allocator.h"
 #include "runtime/confdata-global-manager.h"
 #include "runtime/instance-cache.h"
 #include "runtime/job-workers/shared-memory-manager.h"
@@ -57,7 +58,9 @@
 #include "server/php-master-tl-handlers.h"
 
 #include "server/php-master-restart.h"
+#include "server/php-master-rpc-proxy.h"
 #include "server/php-master-warmup.h"
+#include "server/php-master-workers-scaler.h"
 
 #include "server/job-workers/job-worker-client.h"
 #include "server/job-workers/job-workers-context.h"
@@ -87,6 +90,7 @@ void mem_info_add(mem_info_t *dst, const mem_info_t &other) {
   dst->vm += other.vm;
   dst->rss_peak += other.rss_peak;
   dst->rss += other.rss;
+  dst->rss_private += other.rss_private;
   // do not accumulate rss_file and rss_shmem,
   // because they are about shared memory and accumulated value will show strange stat
 }
@@ -309,6 +313,8 @@ struct Stats {
     res += buffer;
     sprintf(buffer, "RSS_max%s\t%lluKb\n", pid_s.c_str(), mem_info.rss_peak);
     res += buffer;
+    sprintf(buffer, "RSS_private%s\t%lluKb\n", pid_s.c_str(), mem_info.rss_private);
+    res += buffer;
 
     if (is_main) {
       std::string running_workers_max_vals;
@@ -496,6 +502,9 @@ void start_master(int *new_http_fd, int (*new_try_get_http_fd)(), int new_http_f
   http_fd_port = new_http_fd_port;
   try_get_http_fd = new_try_get_http_fd;
 
+  WorkersScaler::get().set_max_workers_n(workers_n);
+  WorkersScaler::get().set_worker_memory(max_memory);
+
   vkprintf(1, "start master: begin\n");
 
   sigemptyset(&empty_mask);
@@ -1218,7 +1227,7 @@ int return_one_key_val(connection *c, const char *val, int vlen) {
   return 0;
 }
 
-int update_mem_stats();
+int update_mem_stats(bool force_private_mem_update);
 
 std::string php_master_prepare_stats(bool full_flag, int worker_pid) {
   std::string res, header;
@@ -1327,7 +1336,7 @@ int php_master_wakeup(connection *c) {
   int worker_pid = D->worker_pid;
 
   update_workers();
-  update_mem_stats();
+  update_mem_stats(true);
 
   std::string res = php_master_prepare_stats(full_flag, worker_pid);
   return_one_key_val(c, (char *)res.c_str(), (int)res.size());
@@ -1374,6 +1383,8 @@ int php_master_get(connection *c, const char *old_key, int old_key_len) {
   //stats
   //full_stats
   //workers_pids
+  //sampling_profiler_toggle<pid>
+  //allocation_profiler_toggle<pid>
   if (key_len == 12 && strncmp(key, "workers_pids", 12) == 0) {
     std::string res;
     for (int i = 0; i < workers_n; i++) {
@@ -1389,6 +1400,22 @@ int php_master_get(connection *c, const char *old_key, int old_key_len) {
     return_one_key(c, old_key, (char *)res.c_str(), (int)res.size());
     return 0;
   }
+  const bool is_sampling_profiler_toggle = key_len >= 24 && strncmp(key, "sampling_profiler_toggle", 24) == 0;
+  const bool is_allocation_profiler_toggle = key_len >= 26 && strncmp(key, "allocation_profiler_toggle", 26) == 0;
+  if (is_sampling_profiler_toggle || is_allocation_profiler_toggle) {
+    int worker_pid = -1;
+    sscanf(key + (is_sampling_profiler_toggle ? 24 : 26), "%d", &worker_pid);
+    const char *res = "worker not found";
+    for (int i = 0; i < me_all_workers_n; i++) {
+      if (!workers[i]->is_dying && workers[i]->pid == worker_pid) {
+        kill(worker_pid, is_sampling_profiler_toggle ? SIGSAMPLINGPROFILER : SIGALLOCATIONPROFILER);
+        res = "ok";
+        break;
+      }
+    }
+    return_one_key(c, old_key, const_cast<char *>(res), static_cast<int>(strlen(res)));
+    return 0;
+  }
   if (key_len >= 5 && strncmp(key, "stats", 5) == 0) {
     key += 5;
     pmm_data *D = PMM_DATA (c);
@@ -1553,6 +1580,8 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
   add_histogram_stat_long(stats, "workers.total.hung", workers_hung);
   add_histogram_stat_long(stats, "workers.total.terminated", workers_terminated);
   add_histogram_stat_long(stats, "workers.total.failed", workers_failed);
+  WorkersScaler::get().write_stats_to(stats);
+  MasterRpcProxy::get().write_stats_to(stats);
 
   const auto workers_stats = server_stats.misc[1].get_stat();
   add_histogram_stat_double(stats, "workers.running.avg_1m", workers_stats.running_workers_avg);
@@ -1593,6 +1622,10 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
                           instance_cache_element_stats.elements_logically_expired_and_ignored.load(std::memory_order_relaxed));
   add_histogram_stat_long(stats, "instance_cache.elements.logically_expired_but_fetched",
                           instance_cache_element_stats.elements_logically_expired_but_fetched.load(std::memory_order_relaxed));
+  add_histogram_stat_long(stats, "instance_cache.elements.loaded_on_restart",
+                          instance_cache_element_stats.elements_loaded_on_restart.load(std::memory_order_relaxed));
+  add_histogram_stat_long(stats, "instance_cache.elements.restored_on_restart",
+                          instance_cache_element_stats.elements_restored_on_restart.load(std::memory_order_relaxed));
 
   write_confdata_stats_to(stats);
   server_stats.worker_stats.recalc_master_percentiles();
@@ -1617,6 +1650,8 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
   add_histogram_stat_long(stats, "job_workers.errors_pipe_server_read", job_workers_stats.errors_pipe_server_read.load(std::memory_order_relaxed));
   add_histogram_stat_long(stats, "job_workers.errors_pipe_client_write", job_workers_stats.errors_pipe_client_write.load(std::memory_order_relaxed));
   add_histogram_stat_long(stats, "job_workers.errors_pipe_client_read", job_workers_stats.errors_pipe_client_read.load(std::memory_order_relaxed));
+  add_histogram_stat_long(stats, "job_workers.errors_queue_server_push", job_workers_stats.errors_queue_server_push.load(std::memory_order_relaxed));
+  add_histogram_stat_long(stats, "job_workers.errors_queue_client_push", job_workers_stats.errors_queue_client_push.load(std::memory_order_relaxed));
 
   add_histogram_stat_long(stats, "job_workers.job_worker_skip_job_due_another_is_running",
                           job_workers_stats.job_worker_skip_job_due_another_is_running.load(std::memory_order_relaxed));
@@ -1625,10 +1660,20 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
   add_histogram_stat_long(stats, "job_workers.job_worker_skip_job_due_steal",
                           job_workers_stats.job_worker_skip_job_due_steal.load(std::memory_order_relaxed));
 
-  update_mem_stats();
+  const auto job_wait_time = job_workers_stats.job_wait_time.calc_50_95_99_percentiles();
+  add_histogram_stat_double(stats, "job_workers.job_wait_time.percentile_50", job_wait_time[0]);
+  add_histogram_stat_double(stats, "job_workers.job_wait_time.percentile_95", job_wait_time[1]);
+  add_histogram_stat_double(stats, "job_workers.job_wait_time.percentile_99", job_wait_time[2]);
+  const auto job_result_wait_time = job_workers_stats.job_result_wait_time.calc_50_95_99_percentiles();
+  add_histogram_stat_double(stats, "job_workers.job_result_wait_time.percentile_50", job_result_wait_time[0]);
+  add_histogram_stat_double(stats, "job_workers.job_result_wait_time.percentile_95", job_result_wait_time[1]);
+  add_histogram_stat_double(stats, "job_workers.job_result_wait_time.percentile_99", job_result_wait_time[2]);
+
+  update_mem_stats(false);
   unsigned long long max_vms = 0;
   unsigned long long max_rss = 0;
   unsigned long long max_shared = 0;
+  unsigned long long max_private = 0;
   for (int i = 0; i < me_all_workers_n; i++) {
     worker_info_t *w = workers[i];
     if (!w->is_dying) {
@@ -1636,12 +1681,16 @@ STATS_PROVIDER_TAGGED(kphp_stats, 100, STATS_TAG_KPHP_SERVER) {
       max_vms = std::max(max_vms, mem_stats.vm_peak);
       max_rss = std::max(max_rss, mem_stats.rss_peak);
       max_shared = std::max(max_shared, mem_stats.rss_shmem + mem_stats.rss_file);
+      max_private = std::max(max_private, mem_stats.rss_private);
     }
   }
 
   add_histogram_stat_long(stats, "memory.vms_max", max_vms * 1024);
   add_histogram_stat_long(stats, "memory.rss_max", max_rss * 1024);
   add_histogram_stat_long(stats, "memory.shared_max", max_shared * 1024);
+  add_histogram_stat_long(stats, "memory.rss_private_max", max_private * 1024);
+  // the memory allocated before the workers are forked, it is shared between them
+  dl::get_global_init_memory_stats().write_stats_to(stats, "global_init");
 }
 
 int php_master_http_execute(struct connection *c, int op) {
@@ -1705,6 +1754,16 @@ void run_master_off_in_graceful_restart() {
     changed = 1;
   }
 
+  if (other->is_alive && other->ask_instance_cache_dump_generation > me->generation) {
+    const auto &dump_file = WarmUpContext::get().get_instance_cache_dump_file();
+    if (!dump_file.empty()) {
+      vkprintf(1, "dump instance cache to '%s'\n", dump_file.c_str());
+      instance_cache_dump_to_file(dump_file.c_str());
+    }
+    me->sent_instance_cache_dump_generation = static_cast<int>(generation);
+    changed = 1;
+  }
+
   if (other->to_kill_generation > me->generation) {
     // old master kills as many workers as new master told
     to_kill = other->to_kill;
@@ -1717,6 +1776,34 @@ void run_master_off_in_graceful_restart() {
   }
 }
 
+// returns true while new master waits for the instance cache dump of old master
+static bool wait_for_instance_cache_dump() {
+  auto &warm_up_ctx = WarmUpContext::get();
+  const char *dump_file = warm_up_ctx.get_instance_cache_dump_file().c_str();
+  if (!warm_up_ctx.instance_cache_dump_asked()) {
+    vkprintf(1, "ask for instance cache dump\n");
+    // the dump left from the previous restart mustn't be loaded
+    unlink(dump_file);
+    me->ask_instance_cache_dump_generation = static_cast<int>(generation);
+    warm_up_ctx.on_instance_cache_dump_asked();
+    changed = 1;
+    return true;
+  }
+  if (other->sent_instance_cache_dump_generation >= me->ask_instance_cache_dump_generation) {
+    vkprintf(1, "load instance cache dump from '%s'\n", dump_file);
+    instance_cache_load_from_file(dump_file);
+    unlink(dump_file);
+    warm_up_ctx.on_instance_cache_dump_received();
+    return false;
+  }
+  if (warm_up_ctx.instance_cache_dump_timeout_expired()) {
+    vkprintf(1, "instance cache dump isn't received, probably old master doesn't support it\n");
+    warm_up_ctx.on_instance_cache_dump_received();
+    return false;
+  }
+  return true;
+}
+
 void run_master_on() {
   vkprintf(2, "state: master_state::on\n");
 
@@ -1792,9 +1879,23 @@ void run_master_on() {
     }
   }
 
-  if (!need_http_fd) {
+  bool need_instance_cache_dump = false;
+  if (!need_http_fd && WarmUpContext::get().need_instance_cache_dump()) {
+    if (other->is_alive) {
+      need_instance_cache_dump = wait_for_instance_cache_dump();
+    } else {
+      WarmUpContext::get().on_instance_cache_dump_received();
+    }
+  }
+
+  if (!need_http_fd && !need_instance_cache_dump) {
+    const int target_workers_n = WorkersScaler::get().get_target_workers_n();
     int total_workers = me_running_http_workers_n + me_dying_http_workers_n + (other->is_alive ? other->running_http_workers_n + other->dying_http_workers_n : 0);
-    to_run = std::max(0, workers_n - total_workers);
+    to_run = std::max(0, target_workers_n - total_workers);
+    if (!other->is_alive) {
+      // the extra workers are removed after the scaling down
+      to_kill = std::max(0, me_running_http_workers_n - target_workers_n);
+    }
 
     if (other->is_alive) {
       auto &warm_up_ctx = WarmUpContext::get();
@@ -1845,14 +1946,34 @@ int signal_epoll_handler(int fd __attribute__((unused)), void *data __attribute_
   return 0;
 }
 
-int update_mem_stats() {
+// reading /proc/<pid>/smaps_rollup walks all the mappings of the process, which is expensive with many workers,
+// so the private memory is updated once in a while, and on the stats requests
+static constexpr double PRIVATE_MEM_STATS_UPDATE_PERIOD_SEC = 60;
+
+int update_mem_stats(bool force_private_mem_update) {
+  static double last_private_mem_update = 0;
+  static unsigned long long master_rss_private = 0;
+  const bool update_private_mem = force_private_mem_update || last_private_mem_update + PRIVATE_MEM_STATS_UPDATE_PERIOD_SEC <= my_now;
+  if (update_private_mem) {
+    last_private_mem_update = my_now;
+  }
+
   get_mem_stats(me->pid, &server_stats.mem_info);
+  if (update_private_mem) {
+    get_private_mem_stats(me->pid, &server_stats.mem_info);
+    master_rss_private = server_stats.mem_info.rss_private;
+  } else {
+    server_stats.mem_info.rss_private = master_rss_private;
+  }
   for (int i = 0; i < me_all_workers_n; i++) {
     worker_info_t *w = workers[i];
 
     if (get_mem_stats(w->pid, &w->stats->mem_info) != 1) {
       continue;
     }
+    if (update_private_mem) {
+      get_private_mem_stats(w->pid, &w->stats->mem_info);
+    }
     mem_info_add(&server_stats.mem_info, w->stats->mem_info);
   }
   return 0;
@@ -1873,12 +1994,32 @@ void check_and_instance_cache_try_swap_memory() {
   }
 }
 
+static void update_workers_scaler() {
+  WorkersScalerInputs inputs;
+  double idle_percent_sum = 0;
+  for (int i = 0; i < me_all_workers_n; i++) {
+    const worker_info_t *w = workers[i];
+    if (w->type == WorkerType::http_worker && !w->is_dying) {
+      inputs.running_workers++;
+      inputs.busy_workers += w->stats->istats.is_running;
+      idle_percent_sum += w->stats->worker_stats.recent_idle_percent();
+    }
+  }
+  if (inputs.running_workers > 0) {
+    inputs.idle_percent = idle_percent_sum / inputs.running_workers;
+  }
+  inputs.accept_queue = http_fd ? get_listen_socket_accept_queue(*http_fd) : -1;
+  inputs.mem_available = get_host_mem_available();
+  WorkersScaler::get().update(inputs, my_now);
+}
+
 static void cron() {
   if (!other->is_alive || in_old_master_on_restart()) {
     // write stats at the beginning to avoid spikes in graphs
     send_data_to_statsd_with_prefix("kphp_server", STATS_TAG_KPHP_SERVER);
   }
   create_all_outbound_connections();
+  MasterRpcProxy::get().cron();
 
   unsigned long long cpu_total = 0;
   unsigned long long utime = 0;
@@ -1908,6 +2049,10 @@ static void cron() {
   MiscStatTimestamp misc_timestamp{my_now, running_workers};
   server_stats.update(misc_timestamp);
 
+  if (WorkersScaler::get().is_enabled() && state == master_state::on && !other->is_alive) {
+    update_workers_scaler();
+  }
+
   utime += dead_utime;
   stime += dead_stime;
   CpuStatTimestamp cpu_timestamp{my_now, utime, stime, cpu_total};
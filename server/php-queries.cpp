@@ -891,7 +891,7 @@ void free_net_query(net_query_t *query) {
 }
 
 /*** main functions ***/
-void mc_run_query(int host_num, const char *request, int request_len, int timeout_ms, int query_type, void (*callback)(const char *result, int result_len)) {
+bool mc_run_query(int host_num, const char *request, int request_len, int timeout_ms, int query_type, void (*callback)(const char *result, int result_len)) {
   PhpQueriesStats::get_mc_queries_stat().register_query(request_len);
   php_net_query_packet_answer_t *res = php_net_query_packet(host_num, request, request_len, timeout_ms * 0.001, p_memcached, query_type | (PNETF_IMMEDIATE * (callback == nullptr)));
   if (res->state == nq_error) {
@@ -899,13 +899,14 @@ void mc_run_query(int host_num, const char *request, int request_len, int timeou
       fprintf(stderr, "mc_run_query error: %s [%s]\n", res->desc ? res->desc : "", res->res);
     }
     save_last_net_error(res->res);
-  } else {
-    assert (res->res != nullptr);
-    PhpQueriesStats::get_mc_queries_stat().register_answer(res->res_len);
-    if (callback != nullptr) {
-      callback(res->res, res->res_len);
-    }
+    return false;
+  }
+  assert (res->res != nullptr);
+  PhpQueriesStats::get_mc_queries_stat().register_answer(res->res_len);
+  if (callback != nullptr) {
+    callback(res->res, res->res_len);
   }
+  return true;
 }
 
 void db_run_query(int host_num, const char *request, int request_len, int timeout_ms, void (*callback)(const char *result, int result_len)) {
@@ -926,7 +927,7 @@ void db_run_query(int host_num, const char *request, int request_len, int timeou
   }
 }
 
-slot_id_t rpc_send_query(int host_num, char *request, int request_size, int timeout_ms) {
+slot_id_t rpc_send_query(int host_num, char *request, int request_size, int timeout_ms, bool ignore_answer) {
   net_query_t *query = create_net_query(nq_rpc_send);
   if (query == nullptr) {
     return -1; // memory limit
@@ -942,6 +943,7 @@ slot_id_t rpc_send_query(int host_num, char *request, int request_size, int time
   query->request = request;
   query->request_size = request_size;
   query->timeout_ms = timeout_ms;
+  query->ignore_answer = ignore_answer;
   return query->slot_id;
 }
 
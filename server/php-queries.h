@@ -56,6 +56,7 @@ struct net_query_t {
       char *request;
       int request_size;
       int timeout_ms;
+      bool ignore_answer;
     };
   };
 };
@@ -355,7 +356,7 @@ slot_id_t create_slot();
 void init_drivers();
 
 int mc_connect_to(const char *host_name, int port);
-void mc_run_query(int host_num, const char *request, int request_len, int timeout_ms, int query_type, void (*callback)(const char *result, int result_len));
+bool mc_run_query(int host_num, const char *request, int request_len, int timeout_ms, int query_type, void (*callback)(const char *result, int result_len));
 int db_proxy_connect();
 void db_run_query(int host_num, const char *request, int request_len, int timeout_ms, void (*callback)(const char *result, int result_len));
 void set_server_status(const char *status, int status_len);
@@ -374,7 +375,7 @@ void job_set_result(int exit_code);
 void script_error();
 void finish_script(int exit_code);
 int rpc_connect_to(const char *host_name, int port);
-slot_id_t rpc_send_query(int host_num, char *request, int request_len, int timeout_ms);
+slot_id_t rpc_send_query(int host_num, char *request, int request_len, int timeout_ms, bool ignore_answer);
 void wait_net_events(int timeout_ms);
 net_event_t *pop_net_event();
 int query_x2(int x);
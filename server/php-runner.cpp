@@ -25,12 +25,15 @@
 
 #include "runtime/allocator.h"
 #include "runtime/critical_section.h"
+#include "runtime/cycle-attribution.h"
 #include "runtime/exception.h"
 #include "runtime/interface.h"
 #include "runtime/profiler.h"
+#include "server/allocation-profiler.h"
 #include "server/json-logger.h"
 #include "server/php-engine-vars.h"
 #include "server/php-worker-stats.h"
+#include "server/sampling-profiler.h"
 
 query_stats_t query_stats;
 long long query_stats_id = 1;
@@ -245,6 +248,21 @@ run_state_t PHPScriptBase::iterate() {
   return state;
 }
 
+static void write_slow_request_json_log(double script_time, double net_time, const CycleSubsystemsCounters &cycles, size_t allocations) {
+  char message[128];
+  snprintf(message, sizeof(message), "Slow request: worked = %.3lf, net = %.3lf, script = %.3lf", script_time + net_time, net_time, script_time);
+
+  char details[1024];
+  int details_len = snprintf(details, sizeof(details), R"json("cycles":{)json");
+  // the other cycles include the script code and the waiting for the network
+  for (size_t i = 1; i < cycles.size(); ++i) {
+    details_len += snprintf(details + details_len, sizeof(details) - details_len, R"json(%s"%s":%)json" PRIu64,
+                            i == 1 ? "" : ",", cycle_subsystem_name(static_cast<CycleSubsystem>(i)), cycles[i]);
+  }
+  snprintf(details + details_len, sizeof(details) - details_len, R"json(},"script_allocations":%zu)json", allocations);
+  vk::singleton<JsonLogger>::get().write_log_with_details(message, E_NOTICE, time(nullptr), details);
+}
+
 void PHPScriptBase::finish() {
   assert (state == run_state_t::finished || state == run_state_t::error);
   auto save_state = state;
@@ -254,7 +272,17 @@ void PHPScriptBase::finish() {
   error_type = script_error_t::no_error;
   update_net_time();
   PhpWorkerStats::get_local().add_stats(script_time, net_time, queries_cnt,
-                                        script_mem_stats.max_memory_used, script_mem_stats.max_real_memory_used, save_error_type);
+                                        script_mem_stats.max_memory_used, script_mem_stats.max_real_memory_used,
+                                        script_mem_stats.sampled_allocations, save_error_type);
+  auto &cycle_attribution = vk::singleton<CycleAttribution>::get();
+  if (cycle_attribution.is_enabled()) {
+    cycle_attribution.finish_request();
+    PhpWorkerStats::get_local().add_cycles(cycle_attribution.get_request_cycles(), script_mem_stats.total_allocations);
+    if (slow_request_json_log_time > 0 && script_time + net_time >= slow_request_json_log_time) {
+      write_slow_request_json_log(script_time, net_time, cycle_attribution.get_request_cycles(), script_mem_stats.total_allocations);
+    }
+  }
+  vk::singleton<AllocationProfiler>::get().on_script_finished(save_error_type == script_error_t::memory_limit);
   if (save_state == run_state_t::error) {
     assert (error_message != nullptr);
     kprintf("Critical error during script execution: %s\n", error_message);
@@ -297,6 +325,7 @@ void PHPScriptBase::clear() {
   assert(state == run_state_t::uncleared);
   run_main->clear();
   free_runtime_environment();
+  vk::singleton<SamplingProfiler>::get().process_samples();
   state = run_state_t::empty;
   if (use_madvise_dontneed) {
     if (dl::get_script_memory_stats().real_memory_used > memory_used_to_recreate_script) {
@@ -361,6 +390,7 @@ void PHPScriptBase::run() {
   assert (run_main->run != nullptr);
 
   init_runtime_environment(data, run_mem, mem_size);
+  vk::singleton<CycleAttribution>::get().start_request();
   CurException = Optional<bool>{};
   run_main->run();
   if (CurException.is_null()) {
@@ -460,6 +490,23 @@ static void stack_overflow_handler(int signum) {
     perform_error_if_running("stack overflow error\n", script_error_t::stack_overflow);
   }
 }
+
+static void sampling_profiler_toggle_handler(int) {
+  vk::singleton<SamplingProfiler>::get().request_toggle();
+}
+
+static void allocation_profiler_toggle_handler(int) {
+  vk::singleton<AllocationProfiler>::get().request_toggle();
+}
+
+static void sigprof_handler(int, siginfo_t *, void *ucontext) {
+#if defined(__x86_64__) && !defined(__APPLE__)
+  const auto &registers = static_cast<ucontext_t *>(ucontext)->uc_mcontext.gregs;
+  vk::singleton<SamplingProfiler>::get().take_sample(reinterpret_cast<void *>(registers[REG_RIP]), reinterpret_cast<void *>(registers[REG_RBP]));
+#else
+  static_cast<void>(ucontext);
+#endif
+}
 }
 
 void print_http_data() {
@@ -592,6 +639,14 @@ void init_handlers() {
   ksignal(SIGUSR2, kphp_runtime_signal_handlers::sigusr2_handler);
   ksignal(SIGPHPASSERT, kphp_runtime_signal_handlers::php_assert_handler);
   ksignal(SIGSTACKOVERFLOW, kphp_runtime_signal_handlers::stack_overflow_handler);
+  if (vk::singleton<SamplingProfiler>::get().is_available()) {
+    ksignal(SIGSAMPLINGPROFILER, kphp_runtime_signal_handlers::sampling_profiler_toggle_handler);
+    // the sampling is performed on the script stack, so SA_ONSTACK isn't used
+    dl_sigaction(SIGPROF, nullptr, dl_get_empty_sigset(), SA_SIGINFO | SA_RESTART, kphp_runtime_signal_handlers::sigprof_handler);
+  }
+  if (vk::singleton<AllocationProfiler>::get().is_available()) {
+    ksignal(SIGALLOCATIONPROFILER, kphp_runtime_signal_handlers::allocation_profiler_toggle_handler);
+  }
 
   dl_sigaction(SIGSEGV, nullptr, dl_get_empty_sigset(), SA_SIGINFO | SA_ONSTACK | SA_RESTART, sigsegv_handler);
   dl_sigaction(SIGBUS, nullptr, dl_get_empty_sigset(), SA_SIGINFO | SA_ONSTACK | SA_RESTART, sigsegv_handler);
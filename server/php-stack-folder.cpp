@@ -0,0 +1,87 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/php-stack-folder.h"
+
+#include "runtime/kphp-backtrace.h"
+
+namespace {
+
+// the generated entry point, which calls the main file function: 'f$src_index1a2b3c$run'
+bool is_main_file_runner(vk::string_view name) {
+  const vk::string_view runner_suffix{"$run"};
+  return name.starts_with("f$src_") && name.ends_with(runner_suffix)
+         && name.substr(2, name.size() - 2 - runner_suffix.size()).find('$') == vk::string_view::npos;
+}
+
+} // namespace
+
+std::string to_php_function_name(vk::string_view name) noexcept {
+  const auto params_pos = name.find('(');
+  if (params_pos != vk::string_view::npos) {
+    name = name.substr(0, params_pos);
+  }
+  if (name.starts_with("c$") && name.ends_with("::run")) {
+    name.remove_suffix(5);
+  } else if (!name.starts_with("f$") || is_main_file_runner(name)) {
+    return {};
+  }
+  name.remove_prefix(2);
+
+  std::string php_name;
+  php_name.reserve(name.size());
+  for (auto it = name.begin(); it != name.end();) {
+    auto next = std::next(it);
+    if (*it == '$') {
+      if (next != name.end() && *next == '$') {
+        php_name.append("::");
+        ++next;
+      } else {
+        php_name.push_back('\\');
+      }
+    } else {
+      php_name.push_back(*it);
+    }
+    it = next;
+  }
+  return php_name;
+}
+
+const std::string &PhpStackFolder::resolve_php_function(void *ip) noexcept {
+  auto it = php_functions_cache_.find(ip);
+  if (it != php_functions_cache_.end()) {
+    return it->second;
+  }
+  KphpBacktrace demangler{&ip, 1};
+  std::string php_name;
+  for (const char *name : demangler.make_demangled_backtrace_range()) {
+    if (name) {
+      php_name = to_php_function_name(name);
+    }
+  }
+  return php_functions_cache_.emplace(ip, std::move(php_name)).first->second;
+}
+
+const std::string &PhpStackFolder::fold(void *const *frames, int depth) noexcept {
+  php_stack_.clear();
+  for (int frame_id = 0; frame_id < depth; ++frame_id) {
+    const std::string &php_name = resolve_php_function(frames[frame_id]);
+    // the resumable frames may be duplicated by their starting functions
+    if (!php_name.empty() && (php_stack_.empty() || *php_stack_.back() != php_name)) {
+      php_stack_.emplace_back(&php_name);
+    }
+  }
+
+  folded_stack_.clear();
+  for (auto php_name = php_stack_.rbegin(); php_name != php_stack_.rend(); ++php_name) {
+    if (!folded_stack_.empty()) {
+      folded_stack_.push_back(';');
+    }
+    folded_stack_.append(**php_name);
+  }
+  if (folded_stack_.empty()) {
+    folded_stack_.assign("[native]");
+  }
+  return folded_stack_;
+}
@@ -0,0 +1,35 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+#include "common/wrappers/string_view.h"
+
+// 'f$VK$Foo$$bar(long)' -> 'VK\Foo::bar', 'c$VK$Foo$$bar::run()' -> 'VK\Foo::bar' (resumable and fork frames),
+// returns an empty string for the non php functions and for the generated entry point of the main file
+std::string to_php_function_name(vk::string_view name) noexcept;
+
+// Converts the raw native stacks into the folded php function stacks like 'main;Foo::bar;baz',
+// the native frames are skipped, the symbolized addresses are cached
+class PhpStackFolder : vk::not_copyable {
+public:
+  // frames are expected to be ordered from the innermost one, returns "[native]" if there are no php frames
+  const std::string &fold(void *const *frames, int depth) noexcept;
+
+  void clear_cache() noexcept {
+    php_functions_cache_.clear();
+  }
+
+private:
+  const std::string &resolve_php_function(void *ip) noexcept;
+
+  std::unordered_map<void *, std::string> php_functions_cache_;
+  std::vector<const std::string *> php_stack_;
+  std::string folded_stack_;
+};
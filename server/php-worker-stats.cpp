@@ -59,13 +59,14 @@ void append_samples(const std::array<T, M> &from, std::array<T, N> &to, size_t o
 } // namespace
 
 void PhpWorkerStats::add_stats(double script_time, double net_time, long script_queries,
-                               long max_memory_used, long max_real_memory_used, script_error_t error) noexcept {
+                               long max_memory_used, long max_real_memory_used, size_t sampled_allocations, script_error_t error) noexcept {
   internal_.tot_queries_++;
   internal_.net_time_ += net_time;
   internal_.script_time_ += script_time;
   internal_.tot_script_queries_ += script_queries;
   internal_.script_max_memory_used_ = std::max(internal_.script_max_memory_used_, int64_t{max_memory_used});
   internal_.script_max_real_memory_used_ = std::max(internal_.script_max_real_memory_used_, int64_t{max_real_memory_used});
+  internal_.script_sampled_allocations_ += sampled_allocations;
   ++internal_.errors_[static_cast<size_t>(error)];
 
   const size_t sample = circular_percentiles_counter_++;
@@ -84,6 +85,20 @@ void PhpWorkerStats::update_idle_time(double tot_idle_time, int uptime, double a
   internal_.a_idle_percent_ = average_idle_quotient > 0 ? average_idle_time / average_idle_quotient * 100 : 0;
 }
 
+void PhpWorkerStats::add_cycles(const CycleSubsystemsCounters &request_cycles, size_t request_allocations) noexcept {
+  for (size_t i = 0; i < request_cycles.size(); ++i) {
+    internal_.subsystem_cycles_[i] += request_cycles[i];
+  }
+  internal_.script_allocations_ += request_allocations;
+}
+
+void PhpWorkerStats::update_udp_stats(int64_t messages_sent, int64_t messages_batched, int64_t messages_dropped, int64_t batches_sent) noexcept {
+  internal_.udp_messages_sent_ = messages_sent;
+  internal_.udp_messages_batched_ = messages_batched;
+  internal_.udp_messages_dropped_ = messages_dropped;
+  internal_.udp_batches_sent_ = batches_sent;
+}
+
 void PhpWorkerStats::recalc_worker_percentiles() noexcept {
   const auto now_tp = std::chrono::steady_clock::now();
   internal_.working_time_percentiles_ = calc_timed_50_95_99_percentiles(working_time_samples_, samples_tp_, now_tp);
@@ -117,6 +132,15 @@ void PhpWorkerStats::add_from(const PhpWorkerStats &from) noexcept {
   internal_.a_idle_percent_ += from.internal_.a_idle_percent_;
   internal_.script_max_memory_used_ = std::max(internal_.script_max_memory_used_, from.internal_.script_max_memory_used_);
   internal_.script_max_real_memory_used_ = std::max(internal_.script_max_real_memory_used_, from.internal_.script_max_real_memory_used_);
+  internal_.script_sampled_allocations_ += from.internal_.script_sampled_allocations_;
+  for (size_t i = 0; i < internal_.subsystem_cycles_.size(); ++i) {
+    internal_.subsystem_cycles_[i] += from.internal_.subsystem_cycles_[i];
+  }
+  internal_.script_allocations_ += from.internal_.script_allocations_;
+  internal_.udp_messages_sent_ += from.internal_.udp_messages_sent_;
+  internal_.udp_messages_batched_ += from.internal_.udp_messages_batched_;
+  internal_.udp_messages_dropped_ += from.internal_.udp_messages_dropped_;
+  internal_.udp_batches_sent_ += from.internal_.udp_batches_sent_;
 
   internal_.accumulated_stats_++;
   for (size_t i = 0; i < internal_.errors_.size(); ++i) {
@@ -188,6 +212,23 @@ void PhpWorkerStats::to_stats(stats_t *stats) const noexcept {
   write_percentile(stats, "memory.script_usage", internal_.script_memory_used_percentiles_);
   add_histogram_stat_long(stats, "memory.script_real_usage.max", internal_.script_max_real_memory_used_);
   write_percentile(stats, "memory.script_real_usage", internal_.script_real_memory_used_percentiles_);
+  add_histogram_stat_long(stats, "memory.script_sampled_allocations", static_cast<int64_t>(internal_.script_sampled_allocations_));
+
+  if (vk::singleton<CycleAttribution>::get().is_enabled()) {
+    std::array<char, 256> buffer{};
+    // the other cycles aren't reported, they are mostly the script code and the waiting for the network
+    for (size_t i = 1; i < internal_.subsystem_cycles_.size(); ++i) {
+      const char *subsystem = cycle_subsystem_name(static_cast<CycleSubsystem>(i));
+      add_histogram_stat_long(stats, concat_stat(buffer, "requests.cycles.", subsystem), static_cast<int64_t>(internal_.subsystem_cycles_[i]));
+    }
+    // the allocations aren't timed, they are too frequent for that
+    add_histogram_stat_long(stats, "requests.script_allocations", static_cast<int64_t>(internal_.script_allocations_));
+  }
+
+  add_histogram_stat_long(stats, "udp.messages_sent", internal_.udp_messages_sent_);
+  add_histogram_stat_long(stats, "udp.messages_batched", internal_.udp_messages_batched_);
+  add_histogram_stat_long(stats, "udp.messages_dropped", internal_.udp_messages_dropped_);
+  add_histogram_stat_long(stats, "udp.batches_sent", internal_.udp_batches_sent_);
 }
 
 int PhpWorkerStats::write_into(char *buffer, int buffer_len) const noexcept {
@@ -10,14 +10,18 @@
 
 #include "common/stats/provider.h"
 
+#include "runtime/cycle-attribution.h"
+
 #include "server/php-runner.h"
 
 class PhpWorkerStats {
 public:
   void add_stats(double script_time, double net_time, long script_queries,
-                 long max_memory_used, long max_real_memory_used, script_error_t error) noexcept;
+                 long max_memory_used, long max_real_memory_used, size_t sampled_allocations, script_error_t error) noexcept;
 
   void update_idle_time(double tot_idle_time, int uptime, double average_idle_time, double average_idle_quotient) noexcept;
+  void add_cycles(const CycleSubsystemsCounters &request_cycles, size_t request_allocations) noexcept;
+  void update_udp_stats(int64_t messages_sent, int64_t messages_batched, int64_t messages_dropped, int64_t batches_sent) noexcept;
   void recalc_worker_percentiles() noexcept;
   void recalc_master_percentiles() noexcept;
 
@@ -37,6 +41,7 @@ public:
 
   long total_queries() const noexcept { return internal_.tot_queries_; }
   long total_script_queries() const noexcept { return internal_.tot_script_queries_; }
+  double recent_idle_percent() const noexcept { return internal_.a_idle_percent_; }
 
   void reset_memory_and_percentiles_stats() noexcept;
 
@@ -72,6 +77,15 @@ private:
 
     int64_t script_max_memory_used_{0};
     int64_t script_max_real_memory_used_{0};
+    uint64_t script_sampled_allocations_{0};
+
+    std::array<uint64_t, CYCLE_SUBSYSTEMS_COUNT> subsystem_cycles_{};
+    uint64_t script_allocations_{0};
+
+    int64_t udp_messages_sent_{0};
+    int64_t udp_messages_batched_{0};
+    int64_t udp_messages_dropped_{0};
+    int64_t udp_batches_sent_{0};
 
     uint32_t accumulated_stats_{0};
     std::array<uint32_t, static_cast<size_t>(script_error_t::errors_count)> errors_{{0}};
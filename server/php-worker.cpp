@@ -12,6 +12,7 @@
 #include "server/job-workers/job-stats.h"
 #include "server/php-engine.h"
 #include "server/php-lease.h"
+#include "server/php-master-rpc-proxy.h"
 #include "server/php-mc-connections.h"
 #include "server/php-sql-connections.h"
 #include "server/php-worker.h"
@@ -203,10 +204,19 @@ void php_worker_run_rpc_send_query(net_query_t *query) {
     return;
   }
   conn_target_t *target = &Targets[connection_id];
+  const bool via_master = is_rpc_proxied_target(target);
+  if (via_master) {
+    prepare_rpc_proxy_query(target, (int *)query->request, query->ignore_answer);
+    target = get_rpc_proxy_master_target();
+  }
   connection *conn = get_target_connection(target, 0);
 
   if (conn != nullptr) {
-    send_rpc_query(conn, TL_RPC_INVOKE_REQ, slot_id, (int *)query->request, query->request_size);
+    if (via_master) {
+      send_rpc_proxy_query(conn, slot_id, (int *)query->request, query->request_size);
+    } else {
+      send_rpc_query(conn, TL_RPC_INVOKE_REQ, slot_id, (int *)query->request, query->request_size);
+    }
     conn->last_query_sent_time = precise_now;
   } else {
     int new_conn_cnt = create_new_connections(target);
@@ -215,7 +225,8 @@ void php_worker_run_rpc_send_query(net_query_t *query) {
       return;
     }
 
-    command_t *command = create_command_net_writer(query->request, query->request_size, &command_net_write_rpc_base, slot_id);
+    command_t *command = create_command_net_writer(query->request, query->request_size,
+                                                   via_master ? &command_net_write_rpc_proxy_base : &command_net_write_rpc_base, slot_id);
     double timeout = fix_timeout(query->timeout_ms * 0.001) + precise_now;
     create_delayed_send_query(target, command, timeout);
   }
@@ -499,7 +510,7 @@ void php_worker_run_query_connect(php_worker *worker __attribute__((unused)), ph
       res.connection_id = sql_target_id;
       break;
     case p_rpc:
-      res.connection_id = get_target(query->host, query->port, &rpc_ct);
+      res.connection_id = get_target(query->host, query->port, MasterRpcProxy::get().is_enabled() ? &rpc_proxied_ct : &rpc_ct);
       break;
     default:
       assert ("unknown protocol" && 0);
@@ -0,0 +1,129 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/sampling-profiler.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <cstring>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "common/fast-backtrace.h"
+#include "common/kprintf.h"
+
+#include "server/php-runner.h"
+
+namespace {
+
+void set_profiling_timer(int frequency_hz) noexcept {
+  itimerval timer{};
+  if (frequency_hz) {
+    timer.it_interval.tv_usec = 1000000 / frequency_hz;
+    timer.it_value = timer.it_interval;
+  }
+  setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+} // namespace
+
+bool SamplingProfiler::set_log_prefix(const char *log_prefix) noexcept {
+  const size_t log_prefix_len = strlen(log_prefix);
+  // reserve 128 bytes for pid + timestamp
+  if (!log_prefix_len || log_prefix_len + 128 > PATH_MAX) {
+    return false;
+  }
+  log_prefix_.assign(log_prefix, log_prefix_len);
+  return true;
+}
+
+bool SamplingProfiler::set_frequency(int frequency_hz) noexcept {
+  if (frequency_hz <= 0 || frequency_hz > 1000) {
+    return false;
+  }
+  frequency_hz_ = frequency_hz;
+  return true;
+}
+
+void SamplingProfiler::request_toggle() noexcept {
+  toggle_requested_ = 1;
+}
+
+void SamplingProfiler::take_sample(void *interrupted_ip, void *interrupted_bp) noexcept {
+  // only the script stacks are sampled, the net and the engine code is out of interest
+  PHPScriptBase *script = PHPScriptBase::current_script;
+  if (!enabled_ || !PHPScriptBase::is_running || !script) {
+    return;
+  }
+  const int sample_id = samples_count_;
+  if (sample_id >= max_samples) {
+    ++samples_dropped_;
+    return;
+  }
+  Sample &sample = samples_[sample_id];
+  sample.frames[0] = interrupted_ip;
+  sample.depth = 1 + fast_backtrace_in_stack(interrupted_bp, sample.frames.data() + 1, max_stack_depth - 1,
+                                             script->run_stack, script->run_stack_end);
+  samples_count_ = sample_id + 1;
+}
+
+void SamplingProfiler::start() noexcept {
+  samples_count_ = 0;
+  samples_dropped_ = 0;
+  folded_stacks_.clear();
+  enabled_ = true;
+  set_profiling_timer(frequency_hz_);
+  kprintf("Sampling profiler is started with %d Hz frequency\n", frequency_hz_);
+}
+
+void SamplingProfiler::stop() noexcept {
+  set_profiling_timer(0);
+  enabled_ = false;
+  fold_samples();
+  dump_folded_stacks();
+  folded_stacks_.clear();
+  stack_folder_.clear_cache();
+}
+
+void SamplingProfiler::fold_samples() noexcept {
+  const int samples_count = samples_count_;
+  for (int sample_id = 0; sample_id < samples_count; ++sample_id) {
+    const Sample &sample = samples_[sample_id];
+    ++folded_stacks_[stack_folder_.fold(sample.frames.data(), sample.depth)];
+  }
+  samples_count_ = 0;
+}
+
+void SamplingProfiler::dump_folded_stacks() noexcept {
+  char log_path[PATH_MAX];
+  snprintf(log_path, sizeof(log_path), "%s.%d.%" PRIu64 ".folded", log_prefix_.c_str(), getpid(),
+           static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch() / std::chrono::seconds{1}));
+  FILE *log = fopen(log_path, "w");
+  if (!log) {
+    kprintf("Can't open sampling profiler log '%s': %s\n", log_path, strerror(errno));
+    return;
+  }
+  for (const auto &folded_stack : folded_stacks_) {
+    fprintf(log, "%s %" PRIu64 "\n", folded_stack.first.c_str(), folded_stack.second);
+  }
+  fclose(log);
+  kprintf("Sampling profiler is stopped, %zu stacks are dumped to '%s', %" PRIu64 " samples are dropped\n",
+          folded_stacks_.size(), log_path, samples_dropped_);
+}
+
+void SamplingProfiler::process_samples() noexcept {
+  if (toggle_requested_) {
+    toggle_requested_ = 0;
+    if (enabled_) {
+      stop();
+    } else if (is_available()) {
+      start();
+    }
+    return;
+  }
+  if (enabled_) {
+    fold_samples();
+  }
+}
@@ -0,0 +1,67 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <csignal>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+#include "server/php-stack-folder.h"
+
+// The sampling profiler, that can be enabled in the running worker without the script recompilation.
+// It is toggled by SIGSAMPLINGPROFILER (the master sends it on 'sampling_profiler_toggle<pid>' memcache get).
+// While enabled, the SIGPROF handler saves the raw script stacks, they are symbolized and folded into php function stacks
+// after each script, and the folded stacks are dumped to '<log prefix>.<pid>.<timestamp>.folded' when the profiler is disabled.
+class SamplingProfiler : vk::not_copyable {
+public:
+  friend class vk::singleton<SamplingProfiler>;
+
+  bool set_log_prefix(const char *log_prefix) noexcept;
+  bool set_frequency(int frequency_hz) noexcept;
+
+  bool is_available() const noexcept {
+    return !log_prefix_.empty();
+  }
+
+  // ATTENTION: these functions are used in signal handlers, therefore they are expected to be safe for them
+  void request_toggle() noexcept;
+  void take_sample(void *interrupted_ip, void *interrupted_bp) noexcept;
+
+  // should be called between the scripts
+  void process_samples() noexcept;
+
+private:
+  SamplingProfiler() = default;
+
+  void start() noexcept;
+  void stop() noexcept;
+  void fold_samples() noexcept;
+  void dump_folded_stacks() noexcept;
+
+  static constexpr int max_stack_depth = 64;
+  static constexpr int max_samples = 1024;
+
+  struct Sample {
+    int depth{0};
+    std::array<void *, max_stack_depth> frames;
+  };
+
+  std::string log_prefix_;
+  int frequency_hz_{99};
+  bool enabled_{false};
+
+  volatile sig_atomic_t toggle_requested_{0};
+  volatile sig_atomic_t samples_count_{0};
+  uint64_t samples_dropped_{0};
+  std::array<Sample, max_samples> samples_;
+
+  PhpStackFolder stack_folder_;
+  std::unordered_map<std::string, uint64_t> folded_stacks_;
+};
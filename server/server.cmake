@@ -1,4 +1,5 @@
 prepend(KPHP_SERVER_SOURCES ${BASE_DIR}/server/
+        allocation-profiler.cpp
         confdata-binlog-replay.cpp
         confdata-stats.cpp
         json-logger.cpp
@@ -9,15 +10,19 @@ prepend(KPHP_SERVER_SOURCES ${BASE_DIR}/server/
         php-lease.cpp
         php-master.cpp
         php-master-restart.cpp
+        php-master-rpc-proxy.cpp
         php-master-tl-handlers.cpp
+        php-master-workers-scaler.cpp
         php-mc-connections.cpp
         php-queries.cpp
         php-query-data.cpp
         php-runner.cpp
         php-script.cpp
+        php-stack-folder.cpp
         php-sql-connections.cpp
         php-worker.cpp
         php-worker-stats.cpp
+        sampling-profiler.cpp
         slot-ids-factory.cpp)
 
 prepend(KPHP_JOB_WORKERS_SOURCES ${BASE_DIR}/server/job-workers/
@@ -25,7 +30,8 @@ prepend(KPHP_JOB_WORKERS_SOURCES ${BASE_DIR}/server/job-workers/
         job-worker-server.cpp
         job-worker-client.cpp
         job-workers-context.cpp
-        pipe-io.cpp)
+        pipe-io.cpp
+        shared-job-queue.cpp)
 
 set(KPHP_SERVER_ALL_SOURCES
     ${KPHP_SERVER_SOURCES}
@@ -2,6 +2,7 @@ prepend(COMPILER_TESTS_SOURCES ${BASE_DIR}/tests/cpp/compiler/
         _compiler-tests-env.cpp
         data/performance-inspections-test.cpp
         phpdoc-test.cpp
+        profile-guided-hints-test.cpp
         typedata-test.cpp
         lexer-test.cpp)
 
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "compiler/profile-guided-hints.h"
+
+namespace {
+
+// the self costs line of a function in the callgrind format of the profiler: the line number and 15 events, cpu_ns is the 15th
+std::string costs_line(uint64_t cpu_ns) {
+  std::string line = "12";
+  for (size_t i = 0; i < 14; ++i) {
+    line += " 1";
+  }
+  return line + " " + std::to_string(cpu_ns) + " 0\n";
+}
+
+std::string function_block(const std::string &function_name, uint64_t self_cpu_ns) {
+  return "\nfl=/tmp/src.php\nfn=" + function_name + "\n" + costs_line(self_cpu_ns);
+}
+
+std::string callee_block(const std::string &callee_name, uint64_t calls, uint64_t inclusive_cpu_ns) {
+  return "cfl=/tmp/src.php\ncfn=" + callee_name + "\ncalls=" + std::to_string(calls) + "\n" + costs_line(inclusive_cpu_ns);
+}
+
+class ProfilerDump {
+public:
+  explicit ProfilerDump(const std::string &content) {
+    char path[] = "/tmp/profile-guided-hints-test.XXXXXX";
+    const int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(write(fd, content.data(), content.size()), static_cast<ssize_t>(content.size()));
+    close(fd);
+    path_ = path;
+  }
+
+  ~ProfilerDump() {
+    unlink(path_.c_str());
+  }
+
+  const std::string &path() const {
+    return path_;
+  }
+
+private:
+  std::string path_;
+};
+
+} // namespace
+
+using Hotness = ProfileGuidedHints::Hotness;
+
+TEST(profile_guided_hints_test, test_ranking) {
+  // self cpu time summed over the dumps: a 600, b 300, c 90, d 9, e 1 of 1000
+  ProfilerDump dump1{
+    "events: total_allocations total_memory_allocated memory_allocated real_memory_allocated query_ctx_swaps "
+    "rpc_outgoing_queries rpc_outgoing_traffic rpc_incoming_traffic sql_outgoing_queries sql_outgoing_traffic sql_incoming_traffic "
+    "mc_outgoing_queries mc_outgoing_traffic mc_incoming_traffic cpu_ns net_ns\n" +
+    function_block("a", 400) +
+    // the inclusive costs of the calls are not the self time of the callee
+    callee_block("b", 3, 100000) +
+    function_block("b", 300)};
+  ProfilerDump dump2{
+    function_block("a (with label)", 200) +
+    function_block("c", 90) +
+    callee_block("e", 7, 100000) +
+    function_block("d", 9) +
+    function_block("e", 1)};
+
+  ProfileGuidedHints hints;
+  ASSERT_TRUE(hints.empty());
+  hints.load_from({dump1.path(), dump2.path()});
+  ASSERT_FALSE(hints.empty());
+
+  // the share of the time before a function: a 0, b 0.6 — hot; c 0.9, d 0.99 — as is; e 0.999 — cold
+  ASSERT_EQ(hints.get_hotness("a"), Hotness::hot);
+  ASSERT_EQ(hints.get_hotness("b"), Hotness::hot);
+  ASSERT_EQ(hints.get_hotness("c"), Hotness::unknown);
+  ASSERT_EQ(hints.get_hotness("d"), Hotness::unknown);
+  ASSERT_EQ(hints.get_hotness("e"), Hotness::cold);
+  ASSERT_EQ(hints.get_hotness("a (with label)"), Hotness::unknown);
+  ASSERT_EQ(hints.get_hotness("f"), Hotness::unknown);
+}
+
+TEST(profile_guided_hints_test, test_equal_time_ranked_by_calls) {
+  // a and b take the same time, b is called more, so it's ranked before a, and only a falls into the cold tail
+  ProfilerDump dump{
+    function_block("x", 998) +
+    callee_block("a", 1, 1) +
+    callee_block("b", 2, 1) +
+    function_block("a", 1) +
+    function_block("b", 1)};
+
+  ProfileGuidedHints hints;
+  hints.load_from({dump.path()});
+  ASSERT_EQ(hints.get_hotness("x"), Hotness::hot);
+  ASSERT_EQ(hints.get_hotness("b"), Hotness::unknown);
+  ASSERT_EQ(hints.get_hotness("a"), Hotness::cold);
+}
+
+TEST(profile_guided_hints_test, test_no_cpu_time) {
+  ProfilerDump dump{function_block("a", 0)};
+
+  ProfileGuidedHints hints;
+  hints.load_from({dump.path()});
+  ASSERT_TRUE(hints.empty());
+  ASSERT_EQ(hints.get_hotness("a"), Hotness::unknown);
+}
@@ -47,3 +47,43 @@ TEST(typedata_test, typedata_human_readable) {
   td_shape->set_lca_at(MultiKey({Key::string_key("y")}), TypeData::get_type(tp_array, tp_False));
   ASSERT_EQ(td_shape->as_human_readable(false), "shape(x:int, y:false[])");
 }
+
+TEST(typedata_test, typedata_intern) {
+  auto *td_int = TypeData::get_type(tp_int)->clone();
+  ASSERT_EQ(TypeData::intern(td_int), TypeData::get_type(tp_int));
+
+  auto *td_arr_float = TypeData::get_type(tp_array)->clone();
+  td_arr_float->set_lca_at(MultiKey::any_key(1), TypeData::get_type(tp_float));
+  ASSERT_EQ(TypeData::intern(td_arr_float), TypeData::get_type(tp_array, tp_float));
+
+  auto *td_int_or_null = TypeData::get_type(tp_int)->clone();
+  td_int_or_null->set_lca(tp_Null);
+  const TypeData *td_interned_int_or_null = TypeData::intern(td_int_or_null);
+  ASSERT_NE(td_interned_int_or_null, TypeData::get_type(tp_int));
+  ASSERT_EQ(td_interned_int_or_null->as_human_readable(false), "?int");
+  ASSERT_EQ(TypeData::create_array_of(td_interned_int_or_null), TypeData::create_array_of(td_interned_int_or_null));
+
+  auto make_shape = [](const char *key, PrimitiveType ptype) {
+    auto *td_shape = TypeData::get_type(tp_shape)->clone();
+    td_shape->set_lca_at(MultiKey({Key::string_key(key)}), TypeData::get_type(ptype));
+    return TypeData::intern(td_shape);
+  };
+  ASSERT_EQ(make_shape("x", tp_int), make_shape("x", tp_int));
+  ASSERT_NE(make_shape("x", tp_int), make_shape("y", tp_int));
+  ASSERT_NE(make_shape("x", tp_int), make_shape("x", tp_string));
+
+  const TypeData *td_arr_int_or_null = TypeData::create_array_of(td_interned_int_or_null);
+  ASSERT_EQ(td_arr_int_or_null->lookup_at_any_key(), td_interned_int_or_null);
+
+  auto make_shape_of_arrays = [](const char *key1, const char *key2) {
+    auto *td_shape = TypeData::get_type(tp_shape)->clone();
+    for (const char *key : {key1, key2}) {
+      td_shape->set_lca_at(MultiKey({Key::string_key(key)}), TypeData::create_array_of(TypeData::get_type(tp_int)));
+    }
+    return TypeData::intern(td_shape);
+  };
+  const TypeData *td_shape_xy = make_shape_of_arrays("x", "y");
+  ASSERT_EQ(td_shape_xy, make_shape_of_arrays("y", "x"));
+  ASSERT_EQ(td_shape_xy->lookup_at(Key::string_key("x")), TypeData::get_type(tp_array, tp_int));
+  ASSERT_EQ(td_shape_xy->lookup_at(Key::string_key("y")), TypeData::get_type(tp_array, tp_int));
+}
@@ -132,3 +132,46 @@ TEST(array_test, test_mutate_shared_map) {
   ASSERT_EQ(arr_copy.get_reference_counter(), 1);
   ASSERT_FALSE(arr_copy.is_equal_inner_pointer(arr));
 }
+
+TEST(array_test, test_map_growth_keeps_order) {
+  auto set_test_value = [](array<int64_t> &arr, int64_t i) {
+    if (i % 3 == 0) {
+      arr.set_value(string{"key_"}.append(i), i);
+    } else {
+      arr.set_value(-i, i);
+    }
+  };
+
+  array<int64_t> arr;
+  for (int64_t i = 0; i < 5000; ++i) {
+    set_test_value(arr, i);
+  }
+  for (int64_t i = 0; i < 5000; i += 7) {
+    if (i % 3 == 0) {
+      arr.unset(string{"key_"}.append(i));
+    } else {
+      arr.unset(-i);
+    }
+  }
+  // the growth after the removals
+  for (int64_t i = 5000; i < 10000; ++i) {
+    set_test_value(arr, i);
+  }
+  ASSERT_FALSE(arr.is_vector());
+  ASSERT_EQ(arr.get_reference_counter(), 1);
+
+  int64_t expected = 0;
+  for (const auto &it : arr) {
+    if (expected < 5000 && expected % 7 == 0) {
+      ++expected;
+    }
+    ASSERT_EQ(it.get_value(), expected);
+    ASSERT_EQ(it.is_string_key(), expected % 3 == 0);
+    ++expected;
+  }
+  ASSERT_EQ(expected, 10000);
+  ASSERT_EQ(arr.count(), 10000 - 715);
+  ASSERT_EQ(arr.get_value(string{"key_9999"}), 9999);
+  ASSERT_EQ(arr.get_value(-9998), 9998);
+  ASSERT_EQ(arr.find_no_mutate(string{"key_21"}), arr.end());
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "runtime/cycle-attribution.h"
+
+namespace {
+
+void spin(uint64_t cycles) {
+  const uint64_t start = cycleclock_now();
+  while (cycleclock_now() - start < cycles) {
+  }
+}
+
+} // namespace
+
+TEST(cycle_attribution_test, test_disabled) {
+  auto &attribution = vk::singleton<CycleAttribution>::get();
+  attribution.set_enabled(false);
+  attribution.start_request();
+  {
+    CycleAttributionScope scope{CycleSubsystem::json};
+    spin(1000);
+  }
+  attribution.finish_request();
+  ASSERT_EQ(attribution.get_request_cycles()[static_cast<size_t>(CycleSubsystem::json)], 0);
+}
+
+TEST(cycle_attribution_test, test_nested_scopes) {
+  auto &attribution = vk::singleton<CycleAttribution>::get();
+  attribution.set_enabled(true);
+  attribution.start_request();
+  spin(1000);
+  {
+    CycleAttributionScope json_scope{CycleSubsystem::json};
+    spin(100000);
+    {
+      CycleAttributionScope serialization_scope{CycleSubsystem::serialization};
+      spin(10000);
+    }
+    spin(100000);
+  }
+  attribution.finish_request();
+  attribution.set_enabled(false);
+
+  const auto &cycles = attribution.get_request_cycles();
+  ASSERT_GE(cycles[static_cast<size_t>(CycleSubsystem::other)], 1000);
+  ASSERT_GE(cycles[static_cast<size_t>(CycleSubsystem::json)], 200000);
+  ASSERT_GE(cycles[static_cast<size_t>(CycleSubsystem::serialization)], 10000);
+  ASSERT_EQ(cycles[static_cast<size_t>(CycleSubsystem::regexp)], 0);
+}
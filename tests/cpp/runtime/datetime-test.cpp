@@ -0,0 +1,57 @@
+#include <ctime>
+#include <gtest/gtest.h>
+
+#include "runtime/datetime.h"
+
+namespace {
+
+constexpr int64_t local_timezone_offset = 3 * 3600;
+
+const int64_t timestamps[] = {-62135596800, -2208988800, -86401, -1, 0, 1, 68201999, 951782400, 1234567890, 1609459199, 2147483647, 4102444800};
+
+} // namespace
+
+TEST(datetime_test, test_localtime) {
+  for (int64_t timestamp : timestamps) {
+    for (int64_t shift = -86400 * 400; shift <= 86400 * 400; shift += 86400 * 7 + 3599) {
+      tm expected;
+      const time_t local_timestamp = timestamp + shift + local_timezone_offset;
+      ASSERT_TRUE(gmtime_r(&local_timestamp, &expected));
+      const auto t = f$localtime(timestamp + shift);
+      ASSERT_EQ(t.get_value(0).to_int(), expected.tm_sec);
+      ASSERT_EQ(t.get_value(1).to_int(), expected.tm_min);
+      ASSERT_EQ(t.get_value(2).to_int(), expected.tm_hour);
+      ASSERT_EQ(t.get_value(3).to_int(), expected.tm_mday);
+      ASSERT_EQ(t.get_value(4).to_int(), expected.tm_mon);
+      ASSERT_EQ(t.get_value(5).to_int(), expected.tm_year);
+      ASSERT_EQ(t.get_value(6).to_int(), expected.tm_wday);
+      ASSERT_EQ(t.get_value(7).to_int(), expected.tm_yday);
+      ASSERT_EQ(t.get_value(8).to_int(), 0);
+    }
+  }
+}
+
+TEST(datetime_test, test_mktime) {
+  for (int64_t timestamp : timestamps) {
+    tm t;
+    const time_t local_timestamp = timestamp + local_timezone_offset;
+    ASSERT_TRUE(gmtime_r(&local_timestamp, &t));
+    if (t.tm_year + 1900 <= 100) {
+      continue; // two-digit years are fixed
+    }
+    ASSERT_EQ(f$mktime(t.tm_hour, t.tm_min, t.tm_sec, t.tm_mon + 1, t.tm_mday, t.tm_year + 1900), timestamp);
+    ASSERT_EQ(f$gmmktime(t.tm_hour, t.tm_min, t.tm_sec, t.tm_mon + 1, t.tm_mday, t.tm_year + 1900), local_timestamp);
+  }
+  // the fields out of their ranges are normalized
+  ASSERT_EQ(f$mktime(0, 0, 0, 13, 1, 2020), f$mktime(0, 0, 0, 1, 1, 2021));
+  ASSERT_EQ(f$mktime(0, 0, 0, 0, 1, 2020), f$mktime(0, 0, 0, 12, 1, 2019));
+  ASSERT_EQ(f$mktime(0, 0, 0, -13, 1, 2020), f$mktime(0, 0, 0, 11, 1, 2018));
+  ASSERT_EQ(f$mktime(0, 0, 0, 3, 0, 2020), f$mktime(0, 0, 0, 2, 29, 2020));
+  ASSERT_EQ(f$mktime(25, 61, -1, 2, 28, 2021), f$mktime(2, 0, 59, 3, 1, 2021));
+}
+
+TEST(datetime_test, test_date) {
+  ASSERT_STREQ(f$date(string{"Y-m-d H:i:s D N z t L W O"}, 0).c_str(), "1970-01-01 03:00:00 Thu 4 0 31 0 01 +0300");
+  ASSERT_STREQ(f$date(string{"Y-m-d H:i:s D N z t L W"}, 951825599).c_str(), "2000-02-29 14:59:59 Tue 2 59 29 1 09");
+  ASSERT_STREQ(f$gmdate(string{"Y-m-d H:i:s D z"}, -1).c_str(), "1969-12-31 23:59:59 Wed 364");
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <random>
+
+#include "runtime/mbstring.h"
+
+namespace {
+
+const string utf8{"UTF-8"};
+
+int64_t naive_strlen(const char *s) {
+  int64_t res = 0;
+  for (int64_t i = 0; s[i]; i++) {
+    res += (static_cast<unsigned char>(s[i]) & 0xc0) != 0x80;
+  }
+  return res;
+}
+
+int64_t naive_advance(const char *s, int64_t cnt) {
+  int64_t i = 0;
+  for (; s[i] && cnt >= 0; i++) {
+    cnt -= (static_cast<unsigned char>(s[i]) & 0xc0) != 0x80;
+  }
+  return cnt < 0 ? i - 1 : i;
+}
+
+string naive_substr(const string &str, int64_t start, int64_t length) {
+  const int64_t len = naive_strlen(str.c_str());
+  start = std::min(start < 0 ? start + len : start, len);
+  length = length < 0 ? len - start + length : length;
+  if (length <= 0 || start < 0) {
+    return {};
+  }
+  length = std::min(length, len - start);
+  const int64_t begin = naive_advance(str.c_str(), start);
+  return string(str.c_str() + begin, static_cast<string::size_type>(naive_advance(str.c_str() + begin, length)));
+}
+
+string random_utf8_string(std::mt19937 &gen, int chars) {
+  static const char *alphabet[] = {"a", "Z", " ", "\xd0\xaf", "\xc3\xa9", "\xe2\x82\xac", "\xe4\xb8\xad", "\xf0\x9f\x98\x80"};
+  string res;
+  for (int i = 0; i < chars; ++i) {
+    res.append(alphabet[gen() % (sizeof(alphabet) / sizeof(alphabet[0]))]);
+  }
+  return res;
+}
+
+} // namespace
+
+TEST(mbstring_test, test_check_encoding) {
+  ASSERT_TRUE(f$mb_check_encoding(string{"plain ascii text, long enough for a word check"}, utf8));
+  ASSERT_TRUE(f$mb_check_encoding(string{"\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, world"}, utf8));
+  ASSERT_FALSE(f$mb_check_encoding(string{"ascii prefix of 16 bytes \xd0"}, utf8));
+  ASSERT_FALSE(f$mb_check_encoding(string{"ascii prefix \x80 continuation"}, utf8));
+  ASSERT_FALSE(f$mb_check_encoding(string{"surrogate \xed\xa0\x80 in the middle"}, utf8));
+  // everything after '\0' is ignored
+  ASSERT_TRUE(f$mb_check_encoding(string{"ascii\0\xff\xff\xff\xff\xff\xff\xff\xff", 14}, utf8));
+  ASSERT_TRUE(f$mb_check_encoding(string{"ascii123\0\xff\xff\xff\xff\xff\xff\xff\xff", 17}, utf8));
+}
+
+TEST(mbstring_test, test_strlen_and_substr) {
+  std::mt19937 gen{42};
+  // the long strings are indexed, so the sequential and random accesses are both checked
+  for (int chars : {0, 1, 7, 8, 9, 63, 64, 65, 300, 1000, 5000}) {
+    const string str = random_utf8_string(gen, chars);
+    ASSERT_EQ(f$mb_strlen(str, utf8), chars);
+    for (int64_t start = -chars - 2; start <= chars + 2; start += chars > 100 ? 7 : 1) {
+      for (int64_t length : {-3, -1, 0, 1, 2, 65, 130, 100000}) {
+        ASSERT_EQ(f$mb_substr(str, start, length, utf8), naive_substr(str, start, length)) << chars << " " << start << " " << length;
+      }
+    }
+    for (int i = 0; i < 100; ++i) {
+      const int64_t start = gen() % (chars + 1);
+      ASSERT_EQ(f$mb_substr(str, start, 3, utf8), naive_substr(str, start, 3));
+    }
+  }
+}
+
+TEST(mbstring_test, test_embedded_zero_and_broken_utf8) {
+  std::mt19937 gen{7};
+  string str = random_utf8_string(gen, 700);
+  str.append("\x80\x80", 2);
+  str.append(string{"\0tail", 5});
+  str.append(random_utf8_string(gen, 700));
+  const int64_t expected_len = naive_strlen(str.c_str());
+  ASSERT_EQ(f$mb_strlen(str, utf8), expected_len);
+  for (int64_t start = 0; start <= expected_len + 1; start += 13) {
+    ASSERT_EQ(f$mb_substr(str, start, 20, utf8), naive_substr(str, start, 20));
+  }
+  const string prefixed = string{"\x80\xbf"}.append(random_utf8_string(gen, 1000));
+  ASSERT_EQ(f$mb_substr(prefixed, 0, 5, utf8), naive_substr(prefixed, 0, 5));
+  ASSERT_EQ(f$mb_substr(prefixed, 100, 5, utf8), naive_substr(prefixed, 100, 5));
+}
+
+TEST(mbstring_test, test_strpos) {
+  std::mt19937 gen{123};
+  const string str = random_utf8_string(gen, 3000);
+  const string needle{"\xe2\x82\xac\xe4\xb8\xad"};
+  for (int64_t offset = 0; offset <= 3001; offset += 11) {
+    const Optional<int64_t> pos = f$mb_strpos(str, needle, offset, utf8);
+    const int64_t begin = naive_advance(str.c_str(), offset);
+    const char *found = static_cast<const char *>(memmem(str.c_str() + begin, str.size() - begin, needle.c_str(), needle.size()));
+    if (found) {
+      ASSERT_EQ(pos.val(), naive_strlen(string(str.c_str(), static_cast<string::size_type>(found - str.c_str())).c_str()));
+    } else {
+      ASSERT_FALSE(pos.has_value());
+    }
+  }
+}
+
+TEST(mbstring_test, test_index_of_modified_string) {
+  std::mt19937 gen{5};
+  string str = string{"\xf0\x9f\x98\x80"}.append(random_utf8_string(gen, 999));
+  ASSERT_EQ(f$mb_strlen(str, utf8), 1000);
+
+  // the index doesn't reference the string, so the appends don't copy it
+  str.reserve_at_least(str.size() + 16);
+  ASSERT_EQ(f$mb_strlen(str, utf8), 1000);
+  const char *data = str.c_str();
+  str.append("\xd0\xaf");
+  ASSERT_EQ(str.c_str(), data);
+  ASSERT_EQ(f$mb_strlen(str, utf8), 1001);
+  ASSERT_EQ(f$mb_substr(str, 1000, 1, utf8), string{"\xd0\xaf"});
+
+  // a char is replaced in place by the 4 ascii chars of the same size
+  str.make_not_shared();
+  memcpy(str.buffer(), "abcd", 4);
+  ASSERT_EQ(str.c_str(), data);
+  ASSERT_EQ(f$mb_strlen(str, utf8), 1004);
+  ASSERT_EQ(f$mb_substr(str, 0, 5, utf8), naive_substr(str, 0, 5));
+  ASSERT_EQ(f$mb_substr(str, 500, 5, utf8), naive_substr(str, 500, 5));
+
+  // the memory of the freed string may be reused by the next one of the same size
+  const string::size_type size = str.size();
+  str = string{};
+  string other{size, ' '};
+  ASSERT_EQ(f$mb_strlen(other, utf8), size);
+  ASSERT_EQ(f$mb_strpos(other, string{"  "}, 1000, utf8).val(), 1000);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "runtime/kphp_core.h"
+#include "runtime/memcache.h"
+
+namespace {
+
+array<C$McMemcache::host> make_hosts(const std::vector<int32_t> &weights) {
+  array<C$McMemcache::host> hosts;
+  for (int32_t i = 0; i < static_cast<int32_t>(weights.size()); ++i) {
+    hosts.push_back({i, 11211, weights[i], 100, 15, mc_host_hash(string{"host"}.append(i), 11211)});
+  }
+  return hosts;
+}
+
+bool always_available(const C$McMemcache::host &) {
+  return true;
+}
+
+} // namespace
+
+TEST(memcache_test, test_choose_host_by_weight) {
+  const auto hosts = make_hosts({1, 1, 2});
+  std::vector<int64_t> keys_per_host(hosts.count());
+  const int64_t keys_count = 40000;
+  for (int64_t i = 0; i < keys_count; ++i) {
+    const int64_t host_id = mc_choose_host(hosts, string{"key_"}.append(i).hash(), always_available);
+    ASSERT_GE(host_id, 0);
+    ASSERT_LT(host_id, hosts.count());
+    keys_per_host[host_id]++;
+  }
+  ASSERT_NEAR(keys_per_host[0], keys_count / 4, keys_count / 40);
+  ASSERT_NEAR(keys_per_host[1], keys_count / 4, keys_count / 40);
+  ASSERT_NEAR(keys_per_host[2], keys_count / 2, keys_count / 40);
+}
+
+TEST(memcache_test, test_choose_host_is_consistent) {
+  const auto hosts = make_hosts({1, 1, 1, 1});
+  auto without_last_host = hosts;
+  without_last_host.pop();
+
+  for (int64_t i = 0; i < 10000; ++i) {
+    const int64_t key_hash = string{"key_"}.append(i).hash();
+    const int64_t host_id = mc_choose_host(hosts, key_hash, always_available);
+    ASSERT_EQ(host_id, mc_choose_host(hosts, key_hash, always_available));
+    // only the keys of the removed host are moved
+    if (host_id != 3) {
+      ASSERT_EQ(host_id, mc_choose_host(without_last_host, key_hash, always_available));
+    }
+  }
+}
+
+TEST(memcache_test, test_choose_host_skips_unavailable) {
+  const auto hosts = make_hosts({1, 1, 1});
+  const auto host_1_is_ejected = [](const C$McMemcache::host &h) { return h.host_num != 1; };
+  const auto all_are_ejected = [](const C$McMemcache::host &) { return false; };
+
+  for (int64_t i = 0; i < 1000; ++i) {
+    const int64_t key_hash = string{"key_"}.append(i).hash();
+    const int64_t host_id = mc_choose_host(hosts, key_hash, host_1_is_ejected);
+    ASSERT_NE(host_id, 1);
+    if (mc_choose_host(hosts, key_hash, always_available) != 1) {
+      ASSERT_EQ(host_id, mc_choose_host(hosts, key_hash, always_available));
+    }
+    ASSERT_EQ(mc_choose_host(hosts, key_hash, all_are_ejected), mc_choose_host(hosts, key_hash, always_available));
+  }
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "runtime/memory_resource/global_init_resource.h"
+
+TEST(global_init_resource_test, allocations_before_freeze) {
+  memory_resource::heap_resource heap;
+  memory_resource::global_init_resource resource{heap};
+
+  auto *small = static_cast<char *>(resource.allocate(24));
+  auto *zeroed = static_cast<char *>(resource.allocate0(100));
+  auto *huge = static_cast<char *>(resource.allocate(100 * 1024));
+  ASSERT_TRUE(small && zeroed && huge);
+  ASSERT_EQ(heap.memory_used(), 0);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(zeroed[i], 0);
+  }
+
+  memset(small, 'x', 24);
+  small = static_cast<char *>(resource.reallocate(small, 1000, 24));
+  ASSERT_EQ(small[23], 'x');
+
+  resource.deallocate(zeroed, 100);
+  resource.deallocate(huge, 100 * 1024);
+  ASSERT_EQ(resource.get_memory_stats().memory_used, 1000);
+  ASSERT_GE(resource.get_memory_stats().max_real_memory_used, 100 * 1024);
+  ASSERT_EQ(heap.memory_used(), 0);
+}
+
+TEST(global_init_resource_test, heap_after_freeze) {
+  memory_resource::heap_resource heap;
+  memory_resource::global_init_resource resource{heap};
+
+  auto *before = static_cast<char *>(resource.allocate(64));
+  memset(before, 'y', 64);
+  resource.freeze();
+  // the touched pages are still mapped
+  ASSERT_EQ(before[63], 'y');
+
+  void *after = resource.allocate(64);
+  ASSERT_EQ(heap.memory_used(), 64);
+  after = resource.reallocate(after, 128, 64);
+  ASSERT_EQ(heap.memory_used(), 128);
+  resource.deallocate(after, 128);
+  ASSERT_EQ(heap.memory_used(), 0);
+  ASSERT_EQ(resource.get_memory_stats().memory_used, 64);
+}
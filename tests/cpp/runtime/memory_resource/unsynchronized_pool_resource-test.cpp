@@ -1,4 +1,5 @@
 #include <array>
+#include <csignal>
 #include <gtest/gtest.h>
 
 #include "runtime/memory_resource/unsynchronized_pool_resource.h"
@@ -292,4 +293,88 @@ TEST(unsynchronized_pool_resource_test, test_auto_defragmentation_small_piece) {
   ASSERT_EQ(mem_stats.small_memory_pieces, 0);
 
   resource.deallocate(mem64, 64);
-}
\ No newline at end of file
+}
+
+TEST(unsynchronized_pool_resource_test, test_huge_pieces_coalescing) {
+  std::array<char, 1024*96> some_memory{};
+  memory_resource::unsynchronized_pool_resource resource;
+
+  resource.init(some_memory.data(), some_memory.size());
+
+  void *mem1 = resource.allocate(1024*32);
+  void *mem2 = resource.allocate(1024*32);
+  void *mem3 = resource.allocate(1024*32);
+  ASSERT_TRUE(mem1);
+  ASSERT_TRUE(mem2);
+  ASSERT_TRUE(mem3);
+
+  resource.deallocate(mem1, 1024*32);
+  resource.deallocate(mem2, 1024*32);
+
+  auto mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.huge_memory_pieces, 2);
+  ASSERT_EQ(mem_stats.huge_pieces_coalescing_calls, 0);
+
+  // adjacent huge pieces are coalesced without the full defragmentation
+  void *mem4 = resource.allocate(1024*64);
+  ASSERT_EQ(mem4, mem1);
+
+  mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.memory_used, some_memory.size());
+  ASSERT_EQ(mem_stats.huge_memory_pieces, 0);
+  ASSERT_EQ(mem_stats.small_memory_pieces, 0);
+  ASSERT_EQ(mem_stats.huge_pieces_coalescing_calls, 1);
+  ASSERT_EQ(mem_stats.defragmentation_calls, 0);
+
+  resource.deallocate(mem4, 1024*64);
+  resource.deallocate(mem3, 1024*32);
+}
+
+namespace {
+size_t sampled_bytes_total = 0;
+size_t sampler_calls = 0;
+
+void test_allocation_sampler(size_t sampled_bytes) {
+  sampled_bytes_total += sampled_bytes;
+  ++sampler_calls;
+}
+} // namespace
+
+TEST(unsynchronized_pool_resource_test, test_allocation_sampler) {
+  std::array<char, 1024*64> some_memory{};
+  memory_resource::unsynchronized_pool_resource resource;
+
+  resource.init(some_memory.data(), some_memory.size());
+  sampled_bytes_total = 0;
+  sampler_calls = 0;
+  resource.set_allocation_sampler(test_allocation_sampler, 1024);
+
+  // 32 * 32 bytes hit exactly one sampling point
+  for (int i = 0; i < 32; ++i) {
+    resource.allocate(32);
+  }
+  ASSERT_EQ(sampler_calls, 1);
+  ASSERT_EQ(sampled_bytes_total, 1024);
+
+  // the huge piece covers several sampling points
+  resource.allocate(1024 * 20 + 512);
+  ASSERT_EQ(sampler_calls, 2);
+  ASSERT_EQ(sampled_bytes_total, 1024 + 1024 * 20);
+  ASSERT_EQ(resource.get_memory_stats().sampled_allocations, 21);
+
+  // the rest of the huge piece is taken into account
+  resource.allocate(512);
+  ASSERT_EQ(sampler_calls, 3);
+
+  // the failed allocation isn't sampled, the out of memory signal is ignored here
+  const size_t sampled_allocations = resource.get_memory_stats().sampled_allocations;
+  auto prev_handler = signal(SIGUSR2, SIG_IGN);
+  ASSERT_EQ(resource.allocate(1024 * 128), nullptr);
+  signal(SIGUSR2, prev_handler);
+  ASSERT_EQ(sampler_calls, 3);
+  ASSERT_EQ(resource.get_memory_stats().sampled_allocations, sampled_allocations);
+
+  resource.set_allocation_sampler(nullptr, 0);
+  resource.allocate(1024 * 4);
+  ASSERT_EQ(sampler_calls, 3);
+}
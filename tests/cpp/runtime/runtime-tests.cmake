@@ -6,13 +6,19 @@ prepend(RUNTIME_TESTS_SOURCES ${BASE_DIR}/tests/cpp/runtime/
         confdata-functions-test.cpp
         confdata-key-maker-test.cpp
         confdata-predefined-wildcards-test.cpp
+        cycle-attribution-test.cpp
+        datetime-test.cpp
         inter-process-mutex-test.cpp
         inter-process-resource-test.cpp
+        mbstring-test.cpp
+        memcache-test.cpp
         memory_resource/details/memory_chunk_list-test.cpp
         memory_resource/details/memory_chunk_tree-test.cpp
         memory_resource/details/memory_ordered_chunk_list-test.cpp
+        memory_resource/global_init_resource-test.cpp
         memory_resource/unsynchronized_pool_resource-test.cpp
-        string-test.cpp)
+        string-test.cpp
+        tl-builtins-test.cpp)
 
 allow_deprecated_declarations_for_apple(${BASE_DIR}/tests/cpp/runtime/inter-process-mutex-test.cpp)
 vk_add_unittest(runtime "${RUNTIME_LIBS};${RUNTIME_LINK_TEST_LIBS}" ${RUNTIME_TESTS_SOURCES})
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "runtime/tl/rpc_request.h"
+#include "runtime/tl/tl_builtins.h"
+
+namespace {
+
+template<class T>
+string make_rpc_data(const std::vector<T> &values, bool with_size = true) {
+  string data;
+  if (with_size) {
+    const auto size = static_cast<int32_t>(values.size());
+    data.append(reinterpret_cast<const char *>(&size), sizeof(size));
+  }
+  data.append(reinterpret_cast<const char *>(values.data()), static_cast<string::size_type>(sizeof(T) * values.size()));
+  return data;
+}
+
+} // namespace
+
+TEST(tl_builtins_test, test_fetch_vector_int) {
+  const std::vector<int32_t> values{1, -2, 3, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min()};
+  ASSERT_TRUE(f$rpc_parse(make_rpc_data(values)));
+
+  array<int64_t> out;
+  t_Vector<t_Int, 0>{t_Int{}}.typed_fetch_to(out);
+  ASSERT_TRUE(out.is_vector());
+  ASSERT_EQ(out.count(), static_cast<int64_t>(values.size()));
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(out.get_value(static_cast<int64_t>(i)), values[i]);
+  }
+  ASSERT_TRUE(f$fetch_eof());
+}
+
+TEST(tl_builtins_test, test_fetch_vector_long) {
+  const std::vector<int64_t> values{1, -2, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()};
+  ASSERT_TRUE(f$rpc_parse(make_rpc_data(values)));
+
+  array<int64_t> out;
+  t_Vector<t_Long, 0>{t_Long{}}.typed_fetch_to(out);
+  ASSERT_TRUE(out.is_vector());
+  ASSERT_EQ(out.count(), static_cast<int64_t>(values.size()));
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(out.get_value(static_cast<int64_t>(i)), values[i]);
+  }
+  ASSERT_TRUE(f$fetch_eof());
+}
+
+TEST(tl_builtins_test, test_fetch_tuple_int) {
+  const std::vector<int32_t> values{5, 4, 3, 2, 1};
+  ASSERT_TRUE(f$rpc_parse(make_rpc_data(values, false)));
+
+  array<int64_t> out;
+  t_Tuple<t_Int, 0>{t_Int{}, 5}.typed_fetch_to(out);
+  ASSERT_EQ(out.count(), static_cast<int64_t>(values.size()));
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(out.get_value(static_cast<int64_t>(i)), values[i]);
+  }
+  ASSERT_TRUE(f$fetch_eof());
+}
+
+TEST(tl_builtins_test, test_fetch_large_vector_int) {
+  std::vector<int32_t> values(100000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<int32_t>(i * 7919);
+  }
+  ASSERT_TRUE(f$rpc_parse(make_rpc_data(values)));
+
+  array<int64_t> out;
+  t_Vector<t_Int, 0>{t_Int{}}.typed_fetch_to(out);
+  ASSERT_EQ(out.count(), static_cast<int64_t>(values.size()));
+  ASSERT_EQ(out.get_value(int64_t{99999}), values[99999]);
+  ASSERT_TRUE(f$fetch_eof());
+}
+
+TEST(tl_builtins_test, test_store_vector_int_round_trip) {
+  array<int64_t> values;
+  for (int64_t v : {int64_t{1}, int64_t{-2}, int64_t{std::numeric_limits<int32_t>::max()}, int64_t{std::numeric_limits<int32_t>::min()}}) {
+    values.push_back(v);
+  }
+  for (int64_t i = 0; i < 3000; ++i) {
+    values.push_back(i * 7919);
+  }
+  f$rpc_clean();
+  t_Vector<t_Int, 0>{t_Int{}}.typed_store(values);
+  const string data = rpc_get_stored_data();
+  ASSERT_EQ(data.size(), sizeof(int32_t) * (values.count() + 1));
+
+  ASSERT_TRUE(f$rpc_parse(data));
+  array<int64_t> out;
+  t_Vector<t_Int, 0>{t_Int{}}.typed_fetch_to(out);
+  ASSERT_TRUE(f$fetch_eof());
+  ASSERT_TRUE(out.is_vector());
+  ASSERT_EQ(out.count(), values.count());
+  for (int64_t i = 0; i < values.count(); ++i) {
+    ASSERT_EQ(out.get_value(i), values.get_value(i));
+  }
+}
+
+TEST(tl_builtins_test, test_store_vector_long_round_trip) {
+  array<int64_t> values;
+  for (int64_t v : {int64_t{1}, int64_t{-2}, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()}) {
+    values.push_back(v);
+  }
+  f$rpc_clean();
+  t_Vector<t_Long, 0>{t_Long{}}.typed_store(values);
+  const string data = rpc_get_stored_data();
+  ASSERT_EQ(data.size(), sizeof(int32_t) + sizeof(int64_t) * values.count());
+
+  ASSERT_TRUE(f$rpc_parse(data));
+  array<int64_t> out;
+  t_Vector<t_Long, 0>{t_Long{}}.typed_fetch_to(out);
+  ASSERT_TRUE(f$fetch_eof());
+  ASSERT_EQ(out.count(), values.count());
+  for (int64_t i = 0; i < values.count(); ++i) {
+    ASSERT_EQ(out.get_value(i), values.get_value(i));
+  }
+}
+
+TEST(tl_builtins_test, test_store_tuple_int_round_trip) {
+  array<int64_t> values;
+  for (int64_t i = 0; i < 5; ++i) {
+    values.push_back(-i);
+  }
+  f$rpc_clean();
+  t_Tuple<t_Int, 0>{t_Int{}, 5}.typed_store(values);
+  const string data = rpc_get_stored_data();
+  ASSERT_EQ(data.size(), sizeof(int32_t) * 5);
+
+  ASSERT_TRUE(f$rpc_parse(data));
+  array<int64_t> out;
+  t_Tuple<t_Int, 0>{t_Int{}, 5}.typed_fetch_to(out);
+  ASSERT_TRUE(f$fetch_eof());
+  for (int64_t i = 0; i < values.count(); ++i) {
+    ASSERT_EQ(out.get_value(i), values.get_value(i));
+  }
+}
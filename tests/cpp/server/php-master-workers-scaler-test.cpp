@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "server/php-master-workers-scaler.h"
+
+namespace {
+
+constexpr int64_t WORKER_MEMORY = 512 << 20;
+
+WorkersScaler &make_scaler(int min_workers_n, int max_workers_n) {
+  auto &scaler = WorkersScaler::get();
+  scaler.set_min_workers_n(min_workers_n);
+  scaler.set_max_workers_n(max_workers_n);
+  scaler.set_worker_memory(WORKER_MEMORY);
+  return scaler;
+}
+
+WorkersScalerInputs make_inputs(int running_workers, int busy_workers, double idle_percent, int64_t accept_queue) {
+  WorkersScalerInputs inputs;
+  inputs.running_workers = running_workers;
+  inputs.busy_workers = busy_workers;
+  inputs.idle_percent = idle_percent;
+  inputs.accept_queue = accept_queue;
+  inputs.mem_available = 100 * WORKER_MEMORY;
+  return inputs;
+}
+
+} // namespace
+
+TEST(php_master_workers_scaler_test, test_disabled) {
+  auto &scaler = make_scaler(0, 16);
+  ASSERT_FALSE(scaler.is_enabled());
+  ASSERT_EQ(scaler.update(make_inputs(16, 0, 100, 0), 100), WorkersScaler::Decision::keep);
+  ASSERT_EQ(scaler.get_target_workers_n(), 16);
+}
+
+TEST(php_master_workers_scaler_test, test_scale_down_and_up) {
+  auto &scaler = make_scaler(4, 16);
+  ASSERT_TRUE(scaler.is_enabled());
+  ASSERT_EQ(scaler.get_target_workers_n(), 16);
+
+  // the workers must be underloaded for a while
+  double now = 100;
+  ASSERT_EQ(scaler.update(make_inputs(16, 1, 90, 0), now), WorkersScaler::Decision::keep);
+  ASSERT_EQ(scaler.update(make_inputs(16, 1, 90, 0), now + 10), WorkersScaler::Decision::keep);
+  for (int i = 0; i < 100; ++i) {
+    now += 30;
+    scaler.update(make_inputs(scaler.get_target_workers_n(), 1, 90, 0), now);
+  }
+  ASSERT_EQ(scaler.get_target_workers_n(), 4);
+
+  // the load spike breaks the underloaded period
+  ASSERT_EQ(scaler.update(make_inputs(4, 4, 0, 10), now + 1), WorkersScaler::Decision::scale_up);
+  ASSERT_EQ(scaler.get_target_workers_n(), 5);
+  // the cooldown lets the new workers start
+  ASSERT_EQ(scaler.update(make_inputs(5, 5, 0, 10), now + 2), WorkersScaler::Decision::keep);
+  for (int i = 0; i < 100; ++i) {
+    now += 5;
+    scaler.update(make_inputs(scaler.get_target_workers_n(), scaler.get_target_workers_n(), 0, 10), now);
+  }
+  ASSERT_EQ(scaler.get_target_workers_n(), 16);
+}
+
+TEST(php_master_workers_scaler_test, test_memory_pressure) {
+  auto &scaler = make_scaler(4, 16);
+  auto inputs = make_inputs(16, 16, 0, 10);
+
+  // no workers are added without the memory
+  inputs.mem_available = WORKER_MEMORY;
+  ASSERT_EQ(scaler.update(inputs, 100), WorkersScaler::Decision::keep);
+
+  // workers are removed even under the load
+  inputs.mem_available = WORKER_MEMORY / 2;
+  ASSERT_EQ(scaler.update(inputs, 101), WorkersScaler::Decision::scale_down_due_memory);
+  ASSERT_EQ(scaler.get_target_workers_n(), 15);
+  for (int i = 0; i < 100; ++i) {
+    scaler.update(inputs, 102 + i);
+  }
+  ASSERT_EQ(scaler.get_target_workers_n(), 4);
+
+  // the new workers are limited by the available memory
+  inputs.mem_available = 3 * WORKER_MEMORY;
+  ASSERT_EQ(scaler.update(inputs, 1000), WorkersScaler::Decision::scale_up);
+  ASSERT_EQ(scaler.get_target_workers_n(), 5);
+}
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+
+#include "server/php-stack-folder.h"
+
+TEST(php_stack_folder_test, test_functions) {
+  ASSERT_EQ(to_php_function_name("f$foo()"), "foo");
+  ASSERT_EQ(to_php_function_name("f$foo(long, string const&)"), "foo");
+  ASSERT_EQ(to_php_function_name("f$VK$RPC$foo(long)"), "VK\\RPC\\foo");
+  ASSERT_EQ(to_php_function_name("f$ABC$DC$run()"), "ABC\\DC\\run");
+}
+
+TEST(php_stack_folder_test, test_methods) {
+  ASSERT_EQ(to_php_function_name("f$VK$Foo$$bar(class_instance<C$VK$Foo> const&)"), "VK\\Foo::bar");
+  ASSERT_EQ(to_php_function_name("f$VK$RPC$$call()"), "VK\\RPC::call");
+  ASSERT_EQ(to_php_function_name("f$Foo$$run()"), "Foo::run");
+}
+
+TEST(php_stack_folder_test, test_resumables) {
+  ASSERT_EQ(to_php_function_name("c$VK$Foo$$bar::run()"), "VK\\Foo::bar");
+  ASSERT_EQ(to_php_function_name("c$VK$RPC$foo::run()"), "VK\\RPC\\foo");
+  ASSERT_EQ(to_php_function_name("c$Foo$$run::run()"), "Foo::run");
+}
+
+TEST(php_stack_folder_test, test_not_php_functions) {
+  ASSERT_EQ(to_php_function_name("f$src_index1a2b3c$run()"), "");
+  ASSERT_EQ(to_php_function_name("f$src_index1a2b3c()"), "src_index1a2b3c");
+  ASSERT_EQ(to_php_function_name("php_worker_run_query(PhpWorker*)"), "");
+  ASSERT_EQ(to_php_function_name("c$VK$Foo$$bar::get_value()"), "");
+  ASSERT_EQ(to_php_function_name("C$VK$Foo::accept()"), "");
+}
@@ -1,6 +1,9 @@
 prepend(SERVER_TESTS_SOURCES ${BASE_DIR}/tests/cpp/server/
         confdata-binlog-events-test.cpp
-        php-engine-test.cpp)
+        php-engine-test.cpp
+        php-master-workers-scaler-test.cpp
+        php-stack-folder-test.cpp
+        shared-job-queue-test.cpp)
 
 if(COMPILER_GCC)
     set_source_files_properties(${BASE_DIR}/tests/cpp/server/confdata-binlog-events-test.cpp PROPERTIES COMPILE_FLAGS -Wno-stringop-overflow)
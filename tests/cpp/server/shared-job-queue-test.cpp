@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "server/job-workers/shared-job-queue.h"
+
+using job_workers::JobSharedMessage;
+using job_workers::SharedJobQueue;
+
+namespace {
+
+JobSharedMessage *fake_job(size_t i) {
+  return reinterpret_cast<JobSharedMessage *>((i + 1) * 8);
+}
+
+size_t fake_job_index(JobSharedMessage *job) {
+  return reinterpret_cast<size_t>(job) / 8 - 1;
+}
+
+} // namespace
+
+TEST(shared_job_queue_test, test_fifo_and_bounds) {
+  SharedJobQueue *queue = SharedJobQueue::make(5);
+  ASSERT_EQ(queue->capacity(), 8);
+  ASSERT_TRUE(queue->empty());
+  ASSERT_EQ(queue->pop(), nullptr);
+
+  for (size_t round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < queue->capacity(); ++i) {
+      ASSERT_TRUE(queue->push(fake_job(i)));
+    }
+    ASSERT_FALSE(queue->push(fake_job(100)));
+    for (size_t i = 0; i < queue->capacity(); ++i) {
+      ASSERT_EQ(queue->pop(), fake_job(i));
+    }
+    ASSERT_TRUE(queue->empty());
+    ASSERT_EQ(queue->pop(), nullptr);
+  }
+}
+
+TEST(shared_job_queue_test, test_wakeups) {
+  SharedJobQueue *queue = SharedJobQueue::make(4);
+  ASSERT_TRUE(queue->request_wakeup());
+  ASSERT_FALSE(queue->request_wakeup());
+  queue->on_wakeup();
+  ASSERT_TRUE(queue->request_wakeup());
+}
+
+TEST(shared_job_queue_test, test_concurrent_producers_and_consumers) {
+  constexpr size_t threads = 4;
+  constexpr size_t jobs_per_producer = 100000;
+  SharedJobQueue *queue = SharedJobQueue::make(64);
+
+  std::vector<std::atomic<int>> popped(threads * jobs_per_producer);
+  std::atomic<size_t> popped_total{0};
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([queue, t] {
+      for (size_t i = 0; i < jobs_per_producer; ++i) {
+        while (!queue->push(fake_job(t * jobs_per_producer + i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    workers.emplace_back([queue, &popped, &popped_total] {
+      while (popped_total.load() < threads * jobs_per_producer) {
+        if (JobSharedMessage *job = queue->pop()) {
+          popped[fake_job_index(job)]++;
+          popped_total++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  ASSERT_TRUE(queue->empty());
+  for (const auto &count : popped) {
+    ASSERT_EQ(count.load(), 1);
+  }
+}
@@ -0,0 +1,42 @@
+@ok
+<?php
+
+function test_json_decode_vectors() {
+  var_dump(json_decode('[]'));
+  var_dump(json_decode('[1, 2.5, -3, 4e2]'));
+  var_dump(json_decode('[[1, 2], [], [[3], [4, [5, 6]]], 7]'));
+  var_dump(json_decode('[{"a": [1, 2]}, [{"b": {}}], "c"]', true));
+  var_dump(json_decode('[ 1 , 2.5 ,-3 ]'));
+  var_dump(json_decode('[1, "2,]", "[3", 4]'));
+
+  $big = [];
+  for ($i = 0; $i < 1000; ++$i) {
+    $big[] = $i % 3 ? $i + 0.5 : $i;
+  }
+  $decoded = json_decode(json_encode($big));
+  var_dump(count($decoded));
+  var_dump($decoded === $big);
+  $decoded[] = "not a number";
+  var_dump(count($decoded));
+}
+
+function test_json_decode_objects() {
+  var_dump(json_decode('{}', true));
+  var_dump(json_decode('{"a": 1, "b": [1, 2], "c": {"d": null}}', true));
+  var_dump(json_decode('{"0": "zero", "1": "one", "x": "x"}', true));
+  var_dump(json_decode('{"a": 1, "b": 2, "a": 3}', true));
+  var_dump(json_decode('{"a": [1, {"b": [2, 3]}], "c": [[], {}]}', true));
+}
+
+function test_json_decode_malformed() {
+  var_dump(json_decode('[1, 2'));
+  var_dump(json_decode('[1, , 2]'));
+  var_dump(json_decode('[1, 2,]'));
+  var_dump(json_decode('[1, [2, 3], {"a": }]'));
+  var_dump(json_decode('{"a": [1, 2], "b"}', true));
+  var_dump(json_decode('[1, 2] 3'));
+}
+
+test_json_decode_vectors();
+test_json_decode_objects();
+test_json_decode_malformed();
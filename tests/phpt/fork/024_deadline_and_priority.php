@@ -0,0 +1,38 @@
+@ok
+<?php
+#ifndef KPHP
+?>
+int(2)
+NULL
+int(1)
+bool(true)
+bool(true)
+<?php
+exit;
+#endif
+
+/**
+ * @param float $x
+ * @param int $y
+ * @return int
+ */
+function f($x, $y) {
+  sched_yield_sleep($x);
+  return $y;
+}
+
+// the margins are wide: the slow fork sleeps far beyond its deadline
+$slow = fork(f(10.0, 1));
+$fast = fork(f(0.01, 2));
+set_fork_deadline($slow, 0.1);
+set_fork_priority($fast, 1);
+$fast_stat = get_fork_stat($fast);
+
+var_dump(wait($fast));
+var_dump(wait($slow));
+
+var_dump($fast_stat["priority"]);
+$stat = get_fork_stat($slow);
+var_dump($stat["deadline"] > 0);
+// wait() for the slow fork returns at its deadline, not earlier
+var_dump($stat["wall_time"] >= 0.09);
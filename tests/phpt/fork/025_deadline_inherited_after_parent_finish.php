@@ -0,0 +1,44 @@
+@ok
+<?php
+#ifndef KPHP
+?>
+int(1)
+NULL
+bool(true)
+bool(true)
+<?php
+exit;
+#endif
+
+/**
+ * @param float $sleep
+ * @return int
+ */
+function child($sleep) {
+  sched_yield_sleep($sleep);
+  return 2;
+}
+
+/**
+ * @return int
+ */
+function parent_with_deadline() {
+  global $child;
+  set_fork_deadline(get_running_fork_id(), 0.2);
+  // the child inherits the deadline and outlives the parent
+  $child = fork(child(10.0));
+  return 1;
+}
+
+$child = fork(child(0.01));
+wait($child);
+
+$start = microtime(true);
+var_dump(wait(fork(parent_with_deadline())));
+var_dump(wait($child));
+// let the scheduler run a bit after the deadline
+wait(fork(child(0.3)));
+
+$stat = get_fork_stat($child);
+var_dump($stat["abandoned"]);
+var_dump(microtime(true) - $start < 5.0);
@@ -0,0 +1,37 @@
+@ok
+<?php
+#ifndef KPHP
+?>
+NULL
+bool(true)
+bool(true)
+bool(true)
+<?php
+exit;
+#endif
+
+$iterations = 0;
+
+/**
+ * @return int
+ */
+function loop() {
+  global $iterations;
+  for ($i = 0; $i < 1000; $i++) {
+    sched_yield_sleep(0.01);
+    $iterations++;
+  }
+  return $i;
+}
+
+$f = fork(loop());
+set_fork_deadline($f, 0.1);
+var_dump(wait($f));
+// let the deadline timer fire, then the code of the abandoned fork must not run anymore
+sched_yield_sleep(0.05);
+$stat = get_fork_stat($f);
+var_dump($stat["abandoned"]);
+$stopped_at = $iterations;
+sched_yield_sleep(0.2);
+var_dump($iterations == $stopped_at);
+var_dump($iterations < 1000);
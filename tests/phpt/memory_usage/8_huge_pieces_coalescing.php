@@ -0,0 +1,35 @@
+@ok
+<?php
+
+function get_defragmentation_stats() {
+  $stats = memory_get_detailed_stats();
+  return [$stats["defragmentation_calls"], $stats["huge_pieces_coalescing_calls"]];
+}
+
+function test_huge_pieces_coalescing() {
+  // 448MB of the adjacent huge pieces
+  $strings = [];
+  for ($i = 0; $i < 56; ++$i) {
+    $strings[] = str_repeat("x", 8 * 1024 * 1024);
+  }
+  $strings = [];
+
+#ifndef KPHP
+  var_dump([0, 0]);
+  if (false)
+#endif
+  var_dump(get_defragmentation_stats());
+
+  // neither the free huge pieces nor the rest of the 512MB script memory fit it,
+  // the huge pieces are coalesced and the small pieces aren't touched
+  $huge = str_repeat("y", 128 * 1024 * 1024);
+  var_dump(strlen($huge));
+
+#ifndef KPHP
+  var_dump([0, 1]);
+  if (false)
+#endif
+  var_dump(get_defragmentation_stats());
+}
+
+test_huge_pieces_coalescing();
@@ -0,0 +1,53 @@
+@ok
+<?php
+
+require_once 'kphp_tester_include.php';
+
+#ifndef KPHP
+function msgpack_deserialize_path(string $v, array $path) {
+  $value = msgpack_deserialize($v);
+  foreach ($path as $key) {
+    if (!is_array($value) || !array_key_exists($key, $value)) {
+      return null;
+    }
+    $value = $value[$key];
+  }
+  return $value;
+}
+#endif
+
+function test_deserialize_path() {
+  $items = [];
+  for ($i = 0; $i < 100; ++$i) {
+    $items[] = ['id' => $i, 'name' => str_repeat('x', $i), 'tags' => [$i, -$i, $i * 1000000000]];
+  }
+  $data = ['items' => $items, 5 => 'five', 'nested' => ['a' => ['b' => [true, null, 1.5]]]];
+  $packed = msgpack_serialize($data);
+
+  var_dump(msgpack_deserialize_path($packed, []) === $data);
+  var_dump(msgpack_deserialize_path($packed, ['items', 0]));
+  var_dump(msgpack_deserialize_path($packed, ['items', 99, 'tags']));
+  var_dump(msgpack_deserialize_path($packed, ['items', 57, 'name']));
+  var_dump(msgpack_deserialize_path($packed, [5]));
+  var_dump(msgpack_deserialize_path($packed, ['5']));
+  var_dump(msgpack_deserialize_path($packed, ['nested', 'a', 'b']));
+  var_dump(msgpack_deserialize_path($packed, ['nested', 'a', 'b', 2]));
+
+  var_dump(msgpack_deserialize_path($packed, ['items', 100]));
+  var_dump(msgpack_deserialize_path($packed, ['items', -1]));
+  var_dump(msgpack_deserialize_path($packed, ['items', 'id']));
+  var_dump(msgpack_deserialize_path($packed, ['unknown']));
+  var_dump(msgpack_deserialize_path($packed, ['items', 3, 'id', 0]));
+}
+
+function test_serialize_sizes() {
+  foreach ([0, 1, 31, 32, 255, 256, 65535, 65536, 100000] as $len) {
+    $value = [str_repeat('a', $len), $len, -$len, [$len => $len]];
+    $packed = msgpack_serialize($value);
+    var_dump(strlen($packed));
+    var_dump(msgpack_deserialize($packed) === $value);
+  }
+}
+
+test_deserialize_path();
+test_serialize_sizes();
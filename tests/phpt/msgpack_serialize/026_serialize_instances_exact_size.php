@@ -0,0 +1,93 @@
+@ok
+<?php
+
+require_once 'kphp_tester_include.php';
+
+/** @kphp-serializable */
+class Item {
+    /**
+     * @kphp-serialized-field 1
+     * @var int
+     */
+    public $id = 0;
+
+    /**
+     * @kphp-serialized-field 2
+     * @var string
+     */
+    public $name = "";
+
+    /**
+     * @kphp-serialized-field 3
+     * @kphp-serialized-float32
+     * @var float
+     */
+    public $weight = 0.5;
+
+    /**
+     * @kphp-serialized-field 4
+     * @var ?Item
+     */
+    public $next = null;
+
+    public function __construct(int $id, string $name) {
+        $this->id = $id;
+        $this->name = $name;
+    }
+}
+
+/** @kphp-serializable */
+class Collection {
+    /**
+     * @kphp-serialized-field 1
+     * @var Item[]
+     */
+    public $items = [];
+
+    /**
+     * @kphp-serialized-field 2
+     * @var float[]
+     */
+    public $values = [];
+
+    /**
+     * @kphp-serialized-field 3
+     * @var mixed
+     */
+    public $extra = null;
+}
+
+function test_string_size_boundaries() {
+    // the packed size of a string header changes at these lengths
+    foreach ([0, 31, 32, 255, 256, 65535, 65536] as $len) {
+        $item = new Item($len, str_repeat('a', $len));
+        $serialized = instance_serialize($item);
+        var_dump(strlen($serialized));
+        /** @var Item $restored */
+        $restored = instance_deserialize($serialized, Item::class);
+        var_dump($restored->id, strlen($restored->name), $restored->name === $item->name);
+    }
+}
+
+function test_nested_instances() {
+    $collection = new Collection();
+    for ($i = 0; $i < 50; ++$i) {
+        $item = new Item($i * 1000003, "item #$i");
+        $item->next = new Item(-$i, str_repeat('b', $i * 7));
+        $collection->items[] = $item;
+        $collection->values[] = $i / 3;
+    }
+    $collection->extra = ['key' => [1, 2.5, "three", null, true], 7 => str_repeat('c', 300)];
+
+    $serialized = instance_serialize($collection);
+    var_dump(strlen($serialized));
+
+    /** @var Collection $restored */
+    $restored = instance_deserialize($serialized, Collection::class);
+    var_dump(count($restored->items), $restored->items[49]->id, $restored->items[49]->next->name);
+    var_dump($restored->values === $collection->values, $restored->extra === $collection->extra);
+    var_dump(instance_serialize($restored) === $serialized);
+}
+
+test_string_size_boundaries();
+test_nested_instances();
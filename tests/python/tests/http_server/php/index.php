@@ -19,6 +19,17 @@ if ($_SERVER["PHP_SELF"] === "/ini_get") {
   echo "after sleep";
 } else if ($_SERVER["PHP_SELF"] === "/store-in-instance-cache") {
   echo instance_cache_store("test_key" . rand(), new A);
+} else if ($_SERVER["PHP_SELF"] === "/store-in-instance-cache-by-key") {
+  echo instance_cache_store((string)$_GET["key"], new A);
+} else if ($_SERVER["PHP_SELF"] === "/fetch-from-instance-cache") {
+  $a = instance_cache_fetch(A::class, (string)$_GET["key"]);
+  echo $a ? "$a->a $a->b" : "null";
+} else if ($_SERVER["PHP_SELF"] === "/send-udp") {
+  $stream = stream_socket_client("udp://127.0.0.1:" . (int)$_GET["port"]);
+  for ($i = 0; $i < (int)$_GET["count"]; ++$i) {
+    fwrite($stream, "message $i");
+  }
+  echo "sent";
 } else {
   echo "Hello world!";
 }
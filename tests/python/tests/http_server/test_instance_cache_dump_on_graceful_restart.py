@@ -0,0 +1,38 @@
+import os
+import time
+
+from python.lib.testcase import KphpServerAutoTestCase
+
+
+class TestInstanceCacheDumpOnGracefulRestart(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.kphp_server.update_options({
+            "--workers-num": 2,
+            "--instance-cache-restart-dump-file": os.path.join(cls.kphp_server_working_dir, "instance_cache.dump"),
+            "-v": True,
+        })
+
+    def fetch_from_instance_cache(self, key):
+        resp = self.kphp_server.http_get(uri='/fetch-from-instance-cache?key={}'.format(key))
+        self.assertEqual(resp.status_code, 200)
+        return resp.text
+
+    def test_instance_cache_is_passed_to_new_server(self):
+        resp = self.kphp_server.http_get(uri='/store-in-instance-cache-by-key?key=dumped_key')
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.text, "1")
+        self.assertEqual(self.fetch_from_instance_cache("dumped_key"), "42 hello")
+
+        self.kphp_server.start()
+        time.sleep(3)
+
+        self.kphp_server.assert_log(["Instance cache is loaded from"], "Instance cache dump was not loaded on restart")
+        self.assertEqual(self.fetch_from_instance_cache("dumped_key"), "42 hello")
+        self.assertEqual(self.fetch_from_instance_cache("missed_key"), "null")
+        self.kphp_server.assert_stats(
+            prefix="kphp_server.instance_cache_elements_",
+            expected_added_stats={
+                "loaded_on_restart": 1,
+                "restored_on_restart": 1,
+            })
@@ -0,0 +1,35 @@
+import socket
+
+from python.lib.testcase import KphpServerAutoTestCase
+
+
+class TestUdpBatching(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.kphp_server.update_options({
+            "--workers-num": 1,
+            "--udp-batch-messages": 8,
+            "--udp-batch-bytes": "1k",
+        })
+
+    def test_all_datagrams_are_sent(self):
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.bind(("127.0.0.1", 0))
+        sock.settimeout(5)
+        port = sock.getsockname()[1]
+
+        resp = self.kphp_server.http_get(uri='/send-udp?port={}&count=20'.format(port))
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.text, "sent")
+
+        received = [sock.recv(1024).decode() for _ in range(20)]
+        sock.close()
+        self.assertEqual(received, ["message {}".format(i) for i in range(20)])
+        self.kphp_server.assert_stats(
+            prefix="kphp_server.udp_",
+            expected_added_stats={
+                "messages_sent": 20,
+                "messages_batched": 20,
+                "messages_dropped": 0,
+                "batches_sent": 3,
+            })
@@ -0,0 +1,39 @@
+from python.lib.testcase import KphpServerAutoTestCase
+
+
+class TestRpcProxyViaMaster(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.kphp_server.update_options({
+            "--job-workers-num": 2,
+            "--rpc-proxy-via-master": True
+        })
+
+    def test_rpc_queries_via_master(self):
+        resp = self.kphp_server.http_post(
+            uri="/test_cpu_job_and_rpc_usage_between",
+            json={
+                "tag": "x2_with_rpc_request",
+                "data": [[1, 2, 3, 4], [7, 9, 12]],
+                "master-port": self.kphp_server.master_port
+            })
+
+        self.assertEqual(resp.status_code, 200)
+        result = resp.json()
+
+        job_result = result["jobs-result"]
+        self.assertEqual(job_result[0]["data"], [1 * 1, 2 * 2, 3 * 3, 4 * 4])
+        self.assertGreater(len(job_result[0]["stats"]["result"]), 5)
+        self.assertEqual(job_result[1]["data"], [7 * 7, 9 * 9, 12 * 12])
+        self.assertGreater(len(job_result[1]["stats"]["result"]), 5)
+        self.assertGreater(len(result["stats"]["result"]), 5)
+
+        self.kphp_server.assert_stats(
+            prefix="kphp_server.rpc_proxy_",
+            expected_added_stats={
+                "backends": 1,
+                "queries": 3,
+                "errors": 0,
+                "in_flight": 0,
+                "queued": 0,
+            })